@@ -2,12 +2,15 @@
 
 App::App()
 {
+	jobSystem = new JobSystem();
+
 	window = new Window();
 	window->initWindow(2000, 1200, "asd");
 
 	context = new VulkanContext(window->getWindow());
 
 	renderer = new Renderer(*context);
+	renderer->jobSystem = jobSystem;
 	renderer->init();
 
 	camera = new Camera();
@@ -16,11 +19,16 @@ App::App()
 
 	
 	ecs = new ECS();
-	//ecs->addEntity(entity1)->addComponent<Transform>(entity1, transformComponent1)->addComponent<Mesh>(entity1, meshComponent1)->addComponent<Material>(entity1, materialComponent1);
-	ecs->addEntity(entity2)->addComponent<Transform>(entity2, transformComponent2)->addComponent<Mesh>(entity2, meshComponent2)->addComponent<Material>(entity2, materialComponent2);
-	//ecs->addEntity(light1)->addComponent<Light>(light1, lightComponent1);
+	scheduler = new Scheduler(*jobSystem);
+	scheduler->addSystem<TransformSystem>();
+	//entity1 = ecs->createEntity();
+	//ecs->addComponent(entity1, transformComponent1)->addComponent(entity1, meshComponent1)->addComponent(entity1, materialComponent1);
+	entity2 = ecs->createEntity();
+	ecs->addComponent(entity2, transformComponent2)->addComponent(entity2, meshComponent2)->addComponent(entity2, materialComponent2);
+	//light1 = ecs->createEntity();
+	//ecs->addComponent(light1, lightComponent1);
 
-	resourceManager = new ResourceManager();
+	resourceManager = new ResourceManager(jobSystem);
 
 	
 
@@ -47,48 +55,52 @@ void App::run()
 
 	//std::cout << skybox->cpuState;
 	
-	for (size_t i = 0; i < damagedHelmet.size(); ++i) {
-		std::shared_ptr<Entity> entity = std::make_shared<Entity>();
-		std::shared_ptr<Transform> transform = std::make_shared<Transform>();
-		std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>();
-		std::shared_ptr<Material> material = std::make_shared<Material>();
+	//Every primitive shares the transform, only mesh and material change between spawns
+	Prefab helmetPrefab;
+	Transform helmetTransform;
+	helmetTransform.position = { 0.0f, 0.0f, 0.0f };
+	//helmetTransform.scale = { 0.1f, 0.1f, 0.1f };
+	helmetTransform.setRotation({ glm::pi<float>() / 2, glm::pi<float>(), 0.0f });
+	helmetPrefab.set(helmetTransform);
 
-		ecs->addEntity(entity)->addComponent<Transform>(entity, transform)->addComponent<Mesh>(entity, mesh)->addComponent(entity, material);
+	for (size_t i = 0; i < damagedHelmet.size(); ++i) {
+		Mesh mesh;
+		Material material;
 
-		transform->position = { 0.0f, 0.0f, 0.0f };
-		//transform->scale = { 0.1f, 0.1f, 0.1f };
-		transform->rotation.x = glm::pi<float>() / 2;
-		transform->rotation.y = glm::pi<float>();
+		mesh.vertices = damagedHelmet[i]->vertices;
+		mesh.indices = damagedHelmet[i]->indices;
+		mesh.meshlets = damagedHelmet[i]->meshlets;
 
-		mesh->vertices = damagedHelmet[i]->vertices;
-		mesh->indices = damagedHelmet[i]->indices;
+		material.albedoIndex = damagedHelmet[i]->albedoIndex;
+		material.roughnessIndex = damagedHelmet[i]->roughnessIndex;
+		material.normalIndex = damagedHelmet[i]->normalIndex;
+		material.occlusionIndex = damagedHelmet[i]->occlusionIndex;
+		material.emissiveIndex = damagedHelmet[i]->emissiveIndex;
 
-		material->albedoIndex = damagedHelmet[i]->albedoIndex;
-		material->roughnessIndex = damagedHelmet[i]->roughnessIndex;
-		material->normalIndex = damagedHelmet[i]->normalIndex;
-		material->occlusionIndex = damagedHelmet[i]->occlusionIndex;
-		material->emissiveIndex = damagedHelmet[i]->emissiveIndex;
+		helmetPrefab.set(mesh).set(material);
+		ecs->spawn(helmetPrefab, 1);
 
-		std::cout << material->roughnessIndex;
-		std::cout << material->occlusionIndex;
+		std::cout << material.roughnessIndex;
+		std::cout << material.occlusionIndex;
 	}
 
-	materialComponent1->albedoIndex = t1->getID();
-	meshComponent1->vertices = vikingRoom->vertices;
-	meshComponent1->indices = vikingRoom->indices;
+	materialComponent1.albedoIndex = t1->getID();
+	meshComponent1.vertices = vikingRoom->vertices;
+	meshComponent1.indices = vikingRoom->indices;
+	meshComponent1.meshlets = vikingRoom->meshlets;
 
 
-	//meshComponent2->vertices = plane->vertices;
-	//meshComponent2->indices = plane->indices;
+	//meshComponent2.vertices = plane->vertices;
+	//meshComponent2.indices = plane->indices;
 
-	transformComponent1->position = { 5.0f, 0.0f, 0.0f };
+	transformComponent1.position = { 5.0f, 0.0f, 0.0f };
 	
 
-	lightComponent1->type = Light::POINT;
-	lightComponent1->direction = glm::normalize(glm::vec4(0, 1, 0, 0));//glm::normalize(glm::vec4(-1.0f, -1.0f, -1.0f, 0.0f));
-	//lightComponent1->position = glm::vec4(4.0f, 3.0f, -4.0f, 0.0f);
-	lightComponent1->position = glm::vec4(-100.0f, 30.0f, 0.0f, 1.0f);
-	lightComponent1->color = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+	lightComponent1.type = Light::POINT;
+	lightComponent1.direction = glm::normalize(glm::vec4(0, 1, 0, 0));//glm::normalize(glm::vec4(-1.0f, -1.0f, -1.0f, 0.0f));
+	//lightComponent1.position = glm::vec4(4.0f, 3.0f, -4.0f, 0.0f);
+	lightComponent1.position = glm::vec4(-100.0f, 30.0f, 0.0f, 1.0f);
+	lightComponent1.color = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
 
 
 
@@ -150,20 +162,20 @@ void App::run()
 	//std::reverse(lightColors.begin(), lightColors.end());
 
 	for (int i = 0; i < 20; ++i) {
-		std::shared_ptr<Entity> lightEntity = std::make_shared<Entity>();
-		std::shared_ptr<Light> lightComp = std::make_shared<Light>();
-		//ecs->addEntity(lightEntity)->addComponent<Light>(lightEntity, lightComp);
+		Light lightComp;
+
+		lightComp.type = Light::POINT;
+		lightComp.color = glm::vec4(lightColors[i], 5.0);
+		lightComp.position = glm::vec4(lightPositions[i] * glm::vec3(-1.0, 1.0, -1.0), 1.0f);
 
-		lightComp->type = Light::POINT;
-		lightComp->color = glm::vec4(lightColors[i], 5.0);
-		lightComp->position = glm::vec4(lightPositions[i] * glm::vec3(-1.0, 1.0, -1.0), 1.0f);
+		//ecs->addComponent(ecs->createEntity(), lightComp);
 	}
 
 
-	transformComponent2->position = lightComponent1->position;
+	ecs->getComponent<Transform>(entity2)->position = lightComponent1.position;
 	
 
-	//camera->setViewTarget(glm::vec3(0.0f, 0.0f, 0.0f), transformComponent2->position);
+	//camera->setViewTarget(glm::vec3(0.0f, 0.0f, 0.0f), transformComponent2.position);
 
 
 	glfwSetInputMode(window->getWindow(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
@@ -176,13 +188,14 @@ void App::run()
 	}
 	//so when its done, loop stops and we go to main loop
 
-	std::shared_ptr<Entity> cameraLightEntity = std::make_shared<Entity>();
-	std::shared_ptr<Light> cameraLightComp = std::make_shared<Light>();
-	//ecs->addEntity(cameraLightEntity)->addComponent<Light>(cameraLightEntity, cameraLightComp);
+	Light cameraLightComp;
 
-	cameraLightComp->type = Light::POINT;
-	cameraLightComp->color = glm::vec4(1.0, 1.0, 1.0, 5.0);
-	cameraLightComp->position = glm::vec4(camera->position, 1.0);
+	cameraLightComp.type = Light::POINT;
+	cameraLightComp.color = glm::vec4(1.0, 1.0, 1.0, 5.0);
+	cameraLightComp.position = glm::vec4(camera->position, 1.0);
+
+	//Entity cameraLightEntity = ecs->createEntity();
+	//ecs->addComponent(cameraLightEntity, cameraLightComp);
 
 	while (!glfwWindowShouldClose(window->getWindow())) {
 
@@ -190,8 +203,8 @@ void App::run()
 
 		auto dt = updateTiming();
 		//std::cout << camera->position.x << " " << camera->position.y << " " << camera->position.z << '\n';
-		//lightComponent1->position.x += 10.0f * dt;
-		//transformComponent2->position = lightComponent1->position;
+		//lightComponent1.position.x += 10.0f * dt;
+		//ecs->getComponent<Transform>(entity2)->position = lightComponent1.position;
 
 		//Set Camera
 		float aspect = renderer->getAspectRatio();
@@ -202,27 +215,28 @@ void App::run()
 		controller->handleKeyboardInputs(dt);
 		controller->handleMouseInputs();
 
+		//Systems
+		scheduler->run(*ecs);
+
 		
 		//Rotation Testing
-		transformComponent1->rotation.x = glm::pi<float>()/2;
-		//transformComponent2->rotation.x = glm::pi<float>();
-		//transformComponent1->rotation.y += dt * glm::pi<float>();
-		/*transformComponent1->rotation.x += 0.0002f * glm::pi<float>();
-
-		transformComponent2->rotation.y -= 0.00002f * glm::pi<float>();
-		transformComponent2->rotation.x -= 0.00002f * glm::pi<float>();*/
+		transformComponent1.setRotation({ glm::pi<float>() / 2, 0.0f, 0.0f });
+		//transformComponent2.setRotation({ glm::pi<float>(), 0.0f, 0.0f });
+		//transformComponent1.rotation = glm::angleAxis(dt * glm::pi<float>(), glm::vec3{ 0.0f, 1.0f, 0.0f }) * transformComponent1.rotation;
 		
 		/*static float t = 0;
 		t = t + 1 % 1000;
-		lightComponent1->color.x = glm::cos(t / 1000) / 2 + 0.5;
-		lightComponent1->color.y = glm::sin(t / 1000) / 2 + 0.5;
-		lightComponent1->color.z = glm::cos(t / 1000) / 2 + 0.5;*/
+		lightComponent1.color.x = glm::cos(t / 1000) / 2 + 0.5;
+		lightComponent1.color.y = glm::sin(t / 1000) / 2 + 0.5;
+		lightComponent1.color.z = glm::cos(t / 1000) / 2 + 0.5;*/
 
-		cameraLightComp->position = glm::vec4(camera->position, 5.0);
+		cameraLightComp.position = glm::vec4(camera->position, 5.0);
 
 		
 		//vkDeviceWaitIdle(context->vulkanResources.device);
 		//Render Loop
+		//Images loaded since the last frame start streaming in
+		renderer->handleResourcesUpload(*resourceManager);
 		if (!renderer->beginFrame()) continue;
 		renderer->submit(*ecs, *camera);
 		renderer->endFrame();
@@ -245,7 +259,9 @@ App::~App()
 	delete renderer;
 	delete context;
 	delete window;
+	delete scheduler;
 	delete ecs;
 	delete controller;
 	delete resourceManager;
+	delete jobSystem;
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include "../Vulkan/Initialization/Window/Window.h"
 #include "../Vulkan/Renderer/Renderer.h"
 #include "../Engine/ECS/System/System.h"
+#include "../Engine/ECS/Scheduler/Scheduler.h"
+#include "../Engine/ECS/System/TransformSystem/TransformSystem.h"
 #include "../Engine/Input/Controller/Controller.h"
 #include "../Engine/ResourceManager/ResourceManager.h"
 
@@ -34,19 +36,21 @@ private:
 
 
 	ECS* ecs;
+	JobSystem* jobSystem;
+	Scheduler* scheduler;
 
-	std::shared_ptr<Entity> entity1 = std::make_shared<Entity>();
-	std::shared_ptr<Transform> transformComponent1 = std::make_shared<Transform>();
-	std::shared_ptr<Mesh> meshComponent1 = std::make_shared<Mesh>();
-	std::shared_ptr<Material> materialComponent1 = std::make_shared<Material>();
+	Entity entity1;
+	Transform transformComponent1;
+	Mesh meshComponent1;
+	Material materialComponent1;
 
-	std::shared_ptr<Entity> entity2 = std::make_shared<Entity>();
-	std::shared_ptr<Transform> transformComponent2 = std::make_shared<Transform>();
-	std::shared_ptr<Mesh> meshComponent2 = std::make_shared<Mesh>();
-	std::shared_ptr<Material> materialComponent2 = std::make_shared<Material>();
+	Entity entity2;
+	Transform transformComponent2;
+	Mesh meshComponent2 = Mesh::createCube();
+	Material materialComponent2;
 
-	std::shared_ptr<Entity> light1 = std::make_shared<Entity>();
-	std::shared_ptr<Light> lightComponent1 = std::make_shared<Light>();
+	Entity light1;
+	Light lightComponent1;
 
 
 	std::chrono::time_point<std::chrono::high_resolution_clock> currentTime = std::chrono::high_resolution_clock::now();
@@ -0,0 +1,162 @@
+//Standalone JobSystem scaling benchmark, not part of the Engine project (it has its own main)
+//Linux:   g++ -std=c++20 -O2 -pthread Benchmarks/JobSystemBenchmark.cpp Engine/JobSystem/JobSystem.cpp -o JobSystemBenchmark
+//Windows: cl /std:c++20 /O2 /EHsc Benchmarks\JobSystemBenchmark.cpp Engine\JobSystem\JobSystem.cpp
+//Run from the Engine folder. Optional argument: maximum thread count (defaults to hardware_concurrency)
+#include "../Engine/JobSystem/JobSystem.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+
+namespace {
+
+	using Clock = std::chrono::high_resolution_clock;
+
+	//Roughly a transform update worth of arithmetic per element
+	float work(float x) {
+		for (int i = 0; i < 48; ++i) {
+			x = x * 0.999f + std::sqrt(x + 1.0f) * 0.001f;
+		}
+		return x;
+	}
+
+	template <typename F> double bestOf(int runs, F&& function) {
+		double best = 1e30;
+		for (int run = 0; run < runs; ++run) {
+			auto start = Clock::now();
+			function();
+			double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+			best = ms < best ? ms : best;
+		}
+		return best;
+	}
+
+	//Data parallel loop, the common ECS/renderer case
+	double parallelForBenchmark(JobSystem& jobSystem, std::vector<float>& data) {
+		return bestOf(5, [&] {
+			jobSystem.parallelFor(static_cast<uint32_t>(data.size()), 4096, [&](uint32_t i) {
+				data[i] = work(data[i]);
+				});
+			});
+	}
+
+	//Many tiny independent jobs from one producer, measures queue overhead
+	double smallJobsBenchmark(JobSystem& jobSystem, uint32_t jobCount) {
+		std::vector<float> results(jobCount);
+		return bestOf(5, [&] {
+			JobSystem::Counter counter;
+			for (uint32_t i = 0; i < jobCount; ++i) {
+				jobSystem.submit([&results, i] { results[i] = work(static_cast<float>(i)); }, counter);
+			}
+			jobSystem.wait(counter);
+			});
+	}
+
+	//Recursive splitting, every job spawns two children and waits on them. Only stealing keeps all threads busy
+	float recursiveSum(JobSystem& jobSystem, const float* data, uint32_t count) {
+		if (count <= 8192) {
+			float sum = 0.0f;
+			for (uint32_t i = 0; i < count; ++i) {
+				sum += work(data[i]);
+			}
+			return sum;
+		}
+
+		float left = 0.0f;
+		float right = 0.0f;
+		JobSystem::Counter counter;
+		jobSystem.submit([&] { left = recursiveSum(jobSystem, data, count / 2); }, counter);
+		right = recursiveSum(jobSystem, data + count / 2, count - count / 2);
+		jobSystem.wait(counter);
+		return left + right;
+	}
+
+	double recursiveBenchmark(JobSystem& jobSystem, const std::vector<float>& data, float& result) {
+		return bestOf(5, [&] {
+			result = recursiveSum(jobSystem, data.data(), static_cast<uint32_t>(data.size()));
+			});
+	}
+
+	//Chain of dependent batches, each waits on the previous counter without blocking a thread
+	double dependencyBenchmark(JobSystem& jobSystem, std::vector<float>& data) {
+		constexpr uint32_t STAGES = 4;
+		constexpr uint32_t JOBS_PER_STAGE = 64;
+
+		return bestOf(5, [&] {
+			std::vector<JobSystem::Counter> counters(STAGES);
+			uint32_t slice = static_cast<uint32_t>(data.size()) / JOBS_PER_STAGE;
+			for (uint32_t stage = 0; stage < STAGES; ++stage) {
+				for (uint32_t job = 0; job < JOBS_PER_STAGE; ++job) {
+					jobSystem.submit([&data, slice, job] {
+						for (uint32_t i = job * slice; i < (job + 1) * slice; ++i) {
+							data[i] = work(data[i]) * 0.5f;
+						}
+						}, counters[stage], stage > 0 ? &counters[stage - 1] : nullptr);
+				}
+			}
+			jobSystem.wait(counters.back());
+			});
+	}
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t maxThreads = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : std::thread::hardware_concurrency();
+	if (maxThreads == 0) {
+		maxThreads = 1;
+	}
+
+	std::vector<uint32_t> threadCounts;
+	for (uint32_t threads = 1; threads < maxThreads; threads *= 2) {
+		threadCounts.push_back(threads);
+	}
+	threadCounts.push_back(maxThreads);
+
+	std::vector<float> source(1u << 21);
+	for (size_t i = 0; i < source.size(); ++i) {
+		source[i] = static_cast<float>(i % 1000) * 0.01f;
+	}
+
+	float reference = 0.0f;
+	for (float value : source) {
+		reference += work(value);
+	}
+
+	std::printf("%-8s %14s %8s %14s %8s %14s %8s %14s %8s\n", "threads", "parallelFor", "speedup", "64k jobs", "speedup", "recursive", "speedup", "dependencies", "speedup");
+
+	double base[4] = {};
+	for (uint32_t threads : threadCounts) {
+		JobSystem jobSystem(threads);
+
+		std::vector<float> data = source;
+		double parallelFor = parallelForBenchmark(jobSystem, data);
+		double smallJobs = smallJobsBenchmark(jobSystem, 1u << 16);
+		float result = 0.0f;
+		double recursive = recursiveBenchmark(jobSystem, source, result);
+		data = source;
+		double dependencies = dependencyBenchmark(jobSystem, data);
+
+		//Summation order differs from the serial loop, only check it is close
+		if (std::fabs(result - reference) > std::fabs(reference) * 1e-3f) {
+			std::printf("recursive sum mismatch: %f vs %f\n", result, reference);
+			return 1;
+		}
+
+		if (threads == threadCounts.front()) {
+			base[0] = parallelFor;
+			base[1] = smallJobs;
+			base[2] = recursive;
+			base[3] = dependencies;
+		}
+
+		std::printf("%-8u %11.2f ms %7.2fx %11.2f ms %7.2fx %11.2f ms %7.2fx %11.2f ms %7.2fx\n", threads,
+			parallelFor, base[0] / parallelFor,
+			smallJobs, base[1] / smallJobs,
+			recursive, base[2] / recursive,
+			dependencies, base[3] / dependencies);
+	}
+
+	return 0;
+}
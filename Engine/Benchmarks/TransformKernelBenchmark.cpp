@@ -0,0 +1,149 @@
+//Standalone TransformKernel benchmark and validation, not part of the Engine project (it has its own main)
+//Linux:   g++ -std=c++20 -O2 -I../Libraries/glm Benchmarks/TransformKernelBenchmark.cpp Engine/TransformKernel/TransformKernel.cpp -o TransformKernelBenchmark
+//Windows: cl /std:c++20 /O2 /EHsc /I..\Libraries\glm Benchmarks\TransformKernelBenchmark.cpp Engine\TransformKernel\TransformKernel.cpp
+//Run from the Engine folder. Optional argument: transform count (defaults to 100000)
+#include "../Engine/TransformKernel/TransformKernel.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+
+namespace {
+
+	using Clock = std::chrono::high_resolution_clock;
+
+	struct Transforms {
+		std::vector<float> positionX, positionY, positionZ;
+		std::vector<float> rotationX, rotationY, rotationZ, rotationW;
+		std::vector<float> scaleX, scaleY, scaleZ;
+
+		//The old Transform layout, euler angles applied y, x, z
+		std::vector<glm::vec3> position, euler, scale;
+		std::vector<glm::quat> rotation;
+
+		TransformKernel::Input input() const {
+			return {
+				positionX.data(), positionY.data(), positionZ.data(),
+				rotationX.data(), rotationY.data(), rotationZ.data(), rotationW.data(),
+				scaleX.data(), scaleY.data(), scaleZ.data()
+			};
+		}
+	};
+
+	Transforms makeTransforms(uint32_t count) {
+		std::mt19937 random(42);
+		std::uniform_real_distribution<float> positions(-100.0f, 100.0f);
+		std::uniform_real_distribution<float> angles(-3.14f, 3.14f);
+		std::uniform_real_distribution<float> scales(0.1f, 4.0f);
+
+		Transforms t;
+		for (uint32_t i = 0; i < count; ++i) {
+			glm::vec3 position{ positions(random), positions(random), positions(random) };
+			glm::vec3 euler{ angles(random), angles(random), angles(random) };
+			glm::vec3 scale{ scales(random), scales(random), scales(random) };
+			glm::quat rotation = glm::angleAxis(euler.y, glm::vec3{ 0.0f, 1.0f, 0.0f })
+				* glm::angleAxis(euler.x, glm::vec3{ 1.0f, 0.0f, 0.0f })
+				* glm::angleAxis(euler.z, glm::vec3{ 0.0f, 0.0f, 1.0f });
+
+			t.position.push_back(position);
+			t.euler.push_back(euler);
+			t.scale.push_back(scale);
+			t.rotation.push_back(rotation);
+
+			t.positionX.push_back(position.x); t.positionY.push_back(position.y); t.positionZ.push_back(position.z);
+			t.rotationX.push_back(rotation.x); t.rotationY.push_back(rotation.y); t.rotationZ.push_back(rotation.z); t.rotationW.push_back(rotation.w);
+			t.scaleX.push_back(scale.x); t.scaleY.push_back(scale.y); t.scaleZ.push_back(scale.z);
+		}
+		return t;
+	}
+
+	template <typename F> double bestOf(int runs, F&& function) {
+		double best = 1e30;
+		for (int run = 0; run < runs; ++run) {
+			auto start = Clock::now();
+			function();
+			double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+			best = ms < best ? ms : best;
+		}
+		return best;
+	}
+
+	//What Transform::transformationMatrix() did per entity, plus the normal matrix the gbuffer shader computed
+	void eulerPath(const Transforms& t, std::vector<glm::mat4>& models, std::vector<glm::mat3>& normals) {
+		for (size_t i = 0; i < t.position.size(); ++i) {
+			auto transform = glm::translate(glm::mat4{ 1.f }, t.position[i]);
+			transform = glm::rotate(transform, t.euler[i].y, { 0.0f, 1.0f, 0.0f });
+			transform = glm::rotate(transform, t.euler[i].x, { 1.0f, 0.0f, 0.0f });
+			transform = glm::rotate(transform, t.euler[i].z, { 0.0f, 0.0f, 1.0f });
+			transform = glm::scale(transform, t.scale[i]);
+			models[i] = transform;
+			normals[i] = glm::inverseTranspose(glm::mat3(transform));
+		}
+	}
+
+	//Per entity glm with quaternions, the reference results
+	void glmPath(const Transforms& t, std::vector<glm::mat4>& models, std::vector<glm::mat3>& normals) {
+		for (size_t i = 0; i < t.position.size(); ++i) {
+			models[i] = glm::translate(glm::mat4{ 1.f }, t.position[i]) * glm::mat4_cast(t.rotation[i]) * glm::scale(glm::mat4{ 1.f }, t.scale[i]);
+			normals[i] = glm::inverseTranspose(glm::mat3(models[i]));
+		}
+	}
+
+	template <typename M> float maxError(const std::vector<M>& a, const std::vector<M>& b) {
+		float error = 0.0f;
+		for (size_t i = 0; i < a.size(); ++i) {
+			for (int c = 0; c < M::length(); ++c) {
+				for (int r = 0; r < M::col_type::length(); ++r) {
+					float scale = std::max(1.0f, std::fabs(b[i][c][r]));
+					error = std::max(error, std::fabs(a[i][c][r] - b[i][c][r]) / scale);
+				}
+			}
+		}
+		return error;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t count = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 100000;
+	Transforms transforms = makeTransforms(count);
+
+	std::vector<glm::mat4> referenceModels(count), models(count);
+	std::vector<glm::mat3> referenceNormals(count), normals(count);
+
+	double glmMs = bestOf(10, [&] { glmPath(transforms, referenceModels, referenceNormals); });
+	double eulerMs = bestOf(10, [&] { eulerPath(transforms, models, normals); });
+	float eulerError = std::max(maxError(models, referenceModels), maxError(normals, referenceNormals));
+
+	const char* names[] = { "scalar", "sse", "avx2" };
+	std::printf("%u transforms, cpu supports %s\n\n", count, names[TransformKernel::getSupportedPath()]);
+	std::printf("%-22s %10s %9s %12s\n", "path", "time", "speedup", "max error");
+	std::printf("%-22s %7.3f ms %8.2fx %12.2e\n", "glm euler (old)", eulerMs, 1.0, eulerError);
+	std::printf("%-22s %7.3f ms %8.2fx %12s\n", "glm quaternion", glmMs, eulerMs / glmMs, "reference");
+
+	bool failed = false;
+	for (uint32_t path = TransformKernel::SCALAR; path <= TransformKernel::getSupportedPath(); ++path) {
+		TransformKernel::setPath(static_cast<TransformKernel::PATH>(path));
+		TransformKernel::Input input = transforms.input();
+
+		double ms = bestOf(10, [&] { TransformKernel::compute(input, count, models.data(), normals.data()); });
+		float error = std::max(maxError(models, referenceModels), maxError(normals, referenceNormals));
+		failed |= error > 1e-4f;
+
+		char name[32];
+		std::snprintf(name, sizeof(name), "kernel %s", names[path]);
+		std::printf("%-22s %7.3f ms %8.2fx %12.2e\n", name, ms, eulerMs / ms, error);
+	}
+
+	if (failed) {
+		std::printf("\nkernel results differ from glm\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,132 @@
+#include "Archetype.h"
+
+std::array<ComponentInfo, MAX_COMPONENT_TYPES>& ComponentRegistry::getInfos()
+{
+	static std::array<ComponentInfo, MAX_COMPONENT_TYPES> infos{};
+	return infos;
+}
+
+Archetype::Archetype(ComponentMask mask) : mask{ mask }
+{
+	columnIndices.fill(-1);
+
+	size_t rowSize = sizeof(Entity);
+	size_t worstPadding = 0;
+	for (uint32_t id = 0; id < MAX_COMPONENT_TYPES; ++id) {
+		if (!hasComponent(id)) continue;
+
+		const ComponentInfo& info = ComponentRegistry::getInfo(id);
+		columnIndices[id] = static_cast<int32_t>(columns.size());
+		columns.push_back({ .info = &info, .offset = 0, .versionOffset = 0 });
+
+		rowSize += info.size + sizeof(uint32_t);
+		worstPadding += info.alignment + alignof(uint32_t);
+	}
+
+	chunkCapacity = CHUNK_SIZE > worstPadding ? static_cast<uint32_t>((CHUNK_SIZE - worstPadding) / rowSize) : 0;
+	if (chunkCapacity == 0) {
+		chunkCapacity = 1;
+	}
+
+	//Entity handles first, then one array per component followed by its change versions
+	size_t offset = sizeof(Entity) * chunkCapacity;
+	for (auto& column : columns) {
+		offset = (offset + column.info->alignment - 1) & ~(column.info->alignment - 1);
+		column.offset = offset;
+		offset += column.info->size * chunkCapacity;
+
+		offset = (offset + alignof(uint32_t) - 1) & ~(alignof(uint32_t) - 1);
+		column.versionOffset = offset;
+		offset += sizeof(uint32_t) * chunkCapacity;
+	}
+
+	chunkBytes = (offset + CHUNK_ALIGNMENT - 1) & ~(CHUNK_ALIGNMENT - 1);
+}
+
+Archetype::~Archetype()
+{
+	for (uint32_t row = 0; row < entityCount; ++row) {
+		destroyRow(row);
+	}
+
+	for (auto& chunk : chunks) {
+		::operator delete(chunk.data, std::align_val_t{ CHUNK_ALIGNMENT });
+	}
+}
+
+uint32_t Archetype::pushEntity(Entity entity)
+{
+	if (chunks.empty() || chunks.back().count == chunkCapacity) {
+		addChunk();
+	}
+
+	uint32_t row = entityCount++;
+	structuralVersion++;
+	Chunk& chunk = chunks.back();
+	getEntities(chunk)[chunk.count++] = entity;
+
+	return row;
+}
+
+uint32_t Archetype::removeRow(uint32_t row)
+{
+	uint32_t last = entityCount - 1;
+	uint32_t movedEntity = INVALID_ENTITY;
+
+	destroyRow(row);
+
+	//Swap-remove keeps every chunk but the last one full
+	if (row != last) {
+		for (int32_t column = 0; column < static_cast<int32_t>(columns.size()); ++column) {
+			void* lastComponent = getComponent(column, last);
+			columns[column].info->moveConstruct(getComponent(column, row), lastComponent);
+			columns[column].info->destroy(lastComponent);
+			setVersion(column, row, getVersion(column, last));
+		}
+
+		Entity moved = getEntities(chunks[last / chunkCapacity])[last % chunkCapacity];
+		getEntities(chunks[row / chunkCapacity])[row % chunkCapacity] = moved;
+		movedEntity = moved.index;
+	}
+
+	entityCount--;
+	structuralVersion++;
+	if (--chunks.back().count == 0) {
+		::operator delete(chunks.back().data, std::align_val_t{ CHUNK_ALIGNMENT });
+		chunks.pop_back();
+	}
+
+	return movedEntity;
+}
+
+uint32_t Archetype::moveRow(uint32_t row, Archetype& destination, uint32_t& destinationRow)
+{
+	Entity entity = getEntities(chunks[row / chunkCapacity])[row % chunkCapacity];
+	destinationRow = destination.pushEntity(entity);
+
+	for (int32_t column = 0; column < static_cast<int32_t>(columns.size()); ++column) {
+		int32_t destinationColumn = destination.getColumnIndex(columns[column].info->id);
+		if (destinationColumn < 0) continue;
+
+		columns[column].info->moveConstruct(destination.getComponent(destinationColumn, destinationRow), getComponent(column, row));
+		destination.setVersion(destinationColumn, destinationRow, getVersion(column, row));
+	}
+
+	//Moved-from and dropped components are destroyed here
+	return removeRow(row);
+}
+
+void Archetype::addChunk()
+{
+	Chunk chunk{};
+	chunk.data = static_cast<std::byte*>(::operator new(chunkBytes, std::align_val_t{ CHUNK_ALIGNMENT }));
+	chunk.versions.resize(columns.size(), 0);
+	chunks.push_back(chunk);
+}
+
+void Archetype::destroyRow(uint32_t row)
+{
+	for (int32_t column = 0; column < static_cast<int32_t>(columns.size()); ++column) {
+		columns[column].info->destroy(getComponent(column, row));
+	}
+}
@@ -0,0 +1,164 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <array>
+#include <new>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include "../Entity/Entity.h"
+
+using ComponentMask = uint64_t;
+static constexpr uint32_t MAX_COMPONENT_TYPES = 64;
+
+//Type-erased lifetime operations for one component type, used to move components between archetypes
+struct ComponentInfo {
+	uint32_t id;
+	size_t size;
+	size_t alignment;
+	void (*moveConstruct)(void* dst, void* src);
+	void (*copyConstruct)(void* dst, const void* src);
+	void (*destroy)(void* component);
+
+	template <typename T> static ComponentInfo create(uint32_t id) {
+		return {
+			.id = id,
+			.size = sizeof(T),
+			.alignment = alignof(T),
+			.moveConstruct = [](void* dst, void* src) { new (dst) T(std::move(*static_cast<T*>(src))); },
+			.copyConstruct = [](void* dst, const void* src) { new (dst) T(*static_cast<const T*>(src)); },
+			.destroy = [](void* component) { static_cast<T*>(component)->~T(); }
+		};
+	}
+};
+
+class ComponentRegistry
+{
+public:
+
+	//Ids are compile time constants declared on each component (COMPONENT_ID)
+	template <typename T> static constexpr uint32_t getID() {
+		constexpr uint32_t id = std::remove_cv_t<T>::COMPONENT_ID;
+		static_assert(id < MAX_COMPONENT_TYPES, "Component id does not fit in a ComponentMask");
+		return id;
+	}
+
+	template <typename... Ts> static constexpr ComponentMask getMask() {
+		return (ComponentMask{} | ... | (1ull << getID<Ts>()));
+	}
+
+	//Fills the type-erased info for T once, must happen before an archetype with T is created
+	template <typename T> static void registerComponent() {
+		static const bool registered = (getInfos()[getID<T>()] = ComponentInfo::create<std::remove_cv_t<T>>(getID<T>()), true);
+		(void)registered;
+	}
+
+	static const ComponentInfo& getInfo(uint32_t id) {
+		return getInfos()[id];
+	}
+
+private:
+
+	//Fixed storage so archetype columns can keep pointers into it
+	static std::array<ComponentInfo, MAX_COMPONENT_TYPES>& getInfos();
+};
+
+
+//All entities with the same component set. Rows are packed into fixed size chunks,
+//each chunk holding one contiguous array per component (structure of arrays)
+class Archetype
+{
+public:
+
+	static constexpr size_t CHUNK_SIZE = 16 * 1024;
+	static constexpr size_t CHUNK_ALIGNMENT = 64;
+	static constexpr uint32_t INVALID_ENTITY = UINT32_MAX;
+
+	struct Column {
+		const ComponentInfo* info;
+		size_t offset;
+		size_t versionOffset;
+	};
+
+	//versions holds the newest row version of each column, so unchanged chunks can be skipped whole
+	struct Chunk {
+		std::byte* data = nullptr;
+		uint32_t count = 0;
+		std::vector<uint32_t> versions;
+	};
+
+	Archetype(ComponentMask mask);
+	Archetype(const Archetype&) = delete;
+	Archetype& operator=(const Archetype&) = delete;
+	~Archetype();
+
+	uint32_t pushEntity(Entity entity);
+	uint32_t removeRow(uint32_t row);
+	uint32_t moveRow(uint32_t row, Archetype& destination, uint32_t& destinationRow);
+
+	bool hasComponent(uint32_t componentId) const {
+		return (mask >> componentId) & 1ull;
+	}
+
+	int32_t getColumnIndex(uint32_t componentId) const {
+		return columnIndices[componentId];
+	}
+
+	void* getComponent(int32_t column, uint32_t row) {
+		Chunk& chunk = chunks[row / chunkCapacity];
+		return chunk.data + columns[column].offset + columns[column].info->size * (row % chunkCapacity);
+	}
+
+	template <typename T> T* getColumn(int32_t column, Chunk& chunk) {
+		return reinterpret_cast<T*>(chunk.data + columns[column].offset);
+	}
+
+	//Change version of every row in a chunk for one column
+	uint32_t* getVersions(int32_t column, Chunk& chunk) {
+		return reinterpret_cast<uint32_t*>(chunk.data + columns[column].versionOffset);
+	}
+
+	void setVersion(int32_t column, uint32_t row, uint32_t version) {
+		Chunk& chunk = chunks[row / chunkCapacity];
+		getVersions(column, chunk)[row % chunkCapacity] = version;
+		chunk.versions[column] = std::max(chunk.versions[column], version);
+	}
+
+	uint32_t getVersion(int32_t column, uint32_t row) {
+		return getVersions(column, chunks[row / chunkCapacity])[row % chunkCapacity];
+	}
+
+	Entity* getEntities(Chunk& chunk) {
+		return reinterpret_cast<Entity*>(chunk.data);
+	}
+
+	uint32_t getEntityCount() const {
+		return entityCount;
+	}
+
+	//Bumped whenever a row is added or removed, a move between archetypes bumps both
+	uint32_t getStructuralVersion() const {
+		return structuralVersion;
+	}
+
+	ComponentMask mask;
+	std::vector<Column> columns;
+	std::vector<Chunk> chunks;
+
+	//Cached transitions when one component is added or removed
+	std::array<Archetype*, MAX_COMPONENT_TYPES> addEdges{};
+	std::array<Archetype*, MAX_COMPONENT_TYPES> removeEdges{};
+
+private:
+
+	void addChunk();
+	void destroyRow(uint32_t row);
+
+	std::array<int32_t, MAX_COMPONENT_TYPES> columnIndices;
+	uint32_t chunkCapacity = 0;
+	size_t chunkBytes = 0;
+	uint32_t entityCount = 0;
+	uint32_t structuralVersion = 0;
+};
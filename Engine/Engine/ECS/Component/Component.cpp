@@ -1 +1,44 @@
 #include "Component.h"
+
+Mesh Mesh::createCube()
+{
+	static const std::shared_ptr<Vertices> cubeVertices = std::make_shared<Vertices>(std::initializer_list<Vertex>{
+		// 0
+		{ {-0.5f, -0.5f, 0.5f}, { 0.7f, 0.7f, 0.7f }, { -0.577f, -0.577f,  0.577f }, { 1.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f } },
+		// 1
+		{ { 0.5f, -0.5f,  0.5f}, {0.7f, 0.7f, 0.7f}, { 0.577f, -0.577f,  0.577f}, {1.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f} },
+		// 2
+		{ { 0.5f,  0.5f,  0.5f}, {0.7f, 0.7f, 0.7f}, { 0.577f,  0.577f,  0.577f}, {1.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f} },
+		// 3
+		{ {-0.5f,  0.5f,  0.5f}, {0.7f, 0.7f, 0.7f}, {-0.577f,  0.577f,  0.577f}, {1.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f} },
+
+		// 4
+		{ {-0.5f, -0.5f, -0.5f}, {0.7f, 0.7f, 0.7f}, {-0.577f, -0.577f, -0.577f}, {1.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f} },
+		// 5
+		{ { 0.5f, -0.5f, -0.5f}, {0.7f, 0.7f, 0.7f}, { 0.577f, -0.577f, -0.577f}, {1.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f} },
+		// 6
+		{ { 0.5f,  0.5f, -0.5f}, {0.7f, 0.7f, 0.7f}, { 0.577f,  0.577f, -0.577f}, {1.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f} },
+		// 7
+		{ {-0.5f,  0.5f, -0.5f}, {0.7f, 0.7f, 0.7f}, {-0.577f,  0.577f, -0.577f}, {1.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f} },
+	});
+
+	static const std::shared_ptr<Indices> cubeIndices = std::make_shared<Indices>(std::initializer_list<uint32_t>{
+		// Front face
+		0, 1, 2, 2, 3, 0,
+		// Right face
+		1, 5, 6, 6, 2, 1,
+		// Back face
+		5, 4, 7, 7, 6, 5,
+		// Left face
+		4, 0, 3, 3, 7, 4,
+		// Top face
+		3, 2, 6, 6, 7, 3,
+		// Bottom face
+		4, 5, 1, 1, 0, 4
+	});
+
+	Mesh mesh;
+	mesh.vertices = cubeVertices;
+	mesh.indices = cubeIndices;
+	return mesh;
+}
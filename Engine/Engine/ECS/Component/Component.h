@@ -10,7 +10,11 @@
 
 #include "../../../Vulkan/Abstractions/Buffer/VertexBuffer/VertexBuffer.h"
 #include "../../../Vulkan/Abstractions/Buffer/IndexBuffer/IndexBuffer.h"
+#include "../../../Vulkan/MeshRegistry/Meshlet/Meshlet.h"
 #include "../../../Vulkan/Helper/Helper.h"
+#include "../Entity/Entity.h"
+
+#include <glm/gtc/quaternion.hpp>
 
 namespace std {
 	template<>
@@ -27,71 +31,79 @@ class Component
 {
 public:
 
+	//Compile time component ids, used as bit positions in archetype masks
+	enum TYPE : uint32_t {
+		TRANSFORM = 0,
+		MESH = 1,
+		MATERIAL = 2,
+		LIGHT = 3,
+		COUNT
+	};
+
 	virtual ~Component() = default;
 };
 
 
 class Transform : public Component {
 public:
+	static constexpr uint32_t COMPONENT_ID = TRANSFORM;
+
 	glm::vec3 position{};
 	glm::vec3 scale{ 1.f, 1.f, 1.f };
-	glm::vec3 rotation{};
-
-	glm::mat4 transformationMatrix() {
-		auto transform = glm::translate(glm::mat4{ 1.f }, position);
-		transform = glm::rotate(transform, rotation.y, { 0.0f, 1.0f, 0.0f });
-		transform = glm::rotate(transform, rotation.x, { 1.0f, 0.0f, 0.0f });
-		transform = glm::rotate(transform, rotation.z, { 0.0f, 0.0f, 1.0f });
-		transform = glm::scale(transform, scale);
-		return transform;
+	glm::quat rotation{ 1.f, 0.f, 0.f, 0.f };
+
+	//Null for roots. The parent needs a Transform of its own, otherwise this is treated as a root
+	Entity parent{};
+
+	//Cached by the TransformSystem, only recomputed when this transform or one of its ancestors changed.
+	//Normal matrices are the inverse transpose of the upper 3x3
+	glm::mat4 localMatrix{ 1.f };
+	glm::mat4 worldMatrix{ 1.f };
+	glm::mat3 localNormalMatrix{ 1.f };
+	glm::mat3 worldNormalMatrix{ 1.f };
+
+	//Euler angles in radians, applied in the order y, x, z
+	void setRotation(glm::vec3 euler) {
+		rotation = glm::angleAxis(euler.y, glm::vec3{ 0.0f, 1.0f, 0.0f })
+			* glm::angleAxis(euler.x, glm::vec3{ 1.0f, 0.0f, 0.0f })
+			* glm::angleAxis(euler.z, glm::vec3{ 0.0f, 0.0f, 1.0f });
+	}
+
+	//translate * rotate * scale for a single transform, the TransformSystem batches this through TransformKernel
+	glm::mat4 computeLocalMatrix() const {
+		glm::mat4 matrix = glm::mat4_cast(rotation);
+		matrix[0] *= scale.x;
+		matrix[1] *= scale.y;
+		matrix[2] *= scale.z;
+		matrix[3] = glm::vec4(position, 1.0f);
+		return matrix;
 	}
 };
 
 
 class Mesh : public Component {
 public:
-	std::shared_ptr<Vertices> vertices = std::make_shared<Vertices>(
-		std::initializer_list<Vertex>{
-		// 0
-			{ {-0.5f, -0.5f, 0.5f}, { 0.7f, 0.7f, 0.7f }, { -0.577f, -0.577f,  0.577f }, { 1.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f } },
-				// 1
-			{ { 0.5f, -0.5f,  0.5f}, {0.7f, 0.7f, 0.7f}, { 0.577f, -0.577f,  0.577f}, {1.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f} },
-				// 2
-			{ { 0.5f,  0.5f,  0.5f}, {0.7f, 0.7f, 0.7f}, { 0.577f,  0.577f,  0.577f}, {1.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f} },
-				// 3
-			{ {-0.5f,  0.5f,  0.5f}, {0.7f, 0.7f, 0.7f}, {-0.577f,  0.577f,  0.577f}, {1.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f} },
-
-				// 4
-			{ {-0.5f, -0.5f, -0.5f}, {0.7f, 0.7f, 0.7f}, {-0.577f, -0.577f, -0.577f}, {1.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f} },
-				// 5
-			{ { 0.5f, -0.5f, -0.5f}, {0.7f, 0.7f, 0.7f}, { 0.577f, -0.577f, -0.577f}, {1.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f} },
-				// 6
-			{ { 0.5f,  0.5f, -0.5f}, {0.7f, 0.7f, 0.7f}, { 0.577f,  0.577f, -0.577f}, {1.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f} },
-				// 7
-			{ {-0.5f,  0.5f, -0.5f}, {0.7f, 0.7f, 0.7f}, {-0.577f,  0.577f, -0.577f}, {1.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f} },
-	}
-	);
-
-
-	std::shared_ptr<Indices> indices = std::make_shared<Indices>(std::initializer_list<uint32_t>{
-		// Front face
-		0, 1, 2, 2, 3, 0,
-			// Right face
-			1, 5, 6, 6, 2, 1,
-			// Back face
-			5, 4, 7, 7, 6, 5,
-			// Left face
-			4, 0, 3, 3, 7, 4,
-			// Top face
-			3, 2, 6, 6, 7, 3,
-			// Bottom face
-			4, 5, 1, 1, 0, 4
-	});
+	static constexpr uint32_t COMPONENT_ID = MESH;
+
+	static constexpr uint32_t INVALID_MESH = UINT32_MAX;
+
+	//Geometry waiting for upload, shared with the resource it came from. The renderer registers it the
+	//first time it sees the mesh, stores the registry id in meshId and drops these references
+	std::shared_ptr<Vertices> vertices;
+	std::shared_ptr<Indices> indices;
+	//Optional, the registry builds them when the mesh comes without
+	std::shared_ptr<Meshlets> meshlets;
 
+	uint32_t meshId = INVALID_MESH;
+
+	//Unit cube, the geometry is allocated once and shared by every cube mesh
+	static Mesh createCube();
 };
 
 class Material : public Component {
 public:
+	static constexpr uint32_t COMPONENT_ID = MATERIAL;
+
 	uint32_t albedoIndex = 0;
 	uint32_t roughnessIndex = 0;
 	uint32_t normalIndex = 0;
@@ -101,6 +113,8 @@ public:
 
 class Light : public Component {
 public:
+	static constexpr uint32_t COMPONENT_ID = LIGHT;
+
 	enum LIGHT_TYPE : uint32_t {
 		DIRECTIONAL,
 		POINT,
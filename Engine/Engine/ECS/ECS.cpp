@@ -2,38 +2,198 @@
 
 ECS::ECS()
 {
+	getArchetype(0);
 }
 
 ECS::~ECS()
 {
 }
 
-ECS* ECS::addEntity(std::shared_ptr<Entity> entity)
+Entity ECS::createEntity()
 {
-	entities[entity->id] = entity;
+	Entity entity;
 
-	changeFlag = true;
+	if (!freeIndices.empty()) {
+		entity.index = freeIndices.back();
+		freeIndices.pop_back();
+	}
+	else {
+		entity.index = static_cast<uint32_t>(records.size());
+		records.emplace_back();
+	}
 
-	return this;
+	EntityRecord& record = records[entity.index];
+	entity.generation = record.generation;
+
+	record.archetype = getArchetype(0);
+	record.row = record.archetype->pushEntity(entity);
+	entityCount++;
+
+	structuralVersion++;
+
+	return entity;
 }
 
-std::shared_ptr<Entity> ECS::getEntityById(uint32_t id)
+ECS* ECS::destroyEntity(Entity entity)
 {
-	return entities[id];
+	if (!isAlive(entity)) {
+		return this;
+	}
+
+	EntityRecord& record = records[entity.index];
+	uint32_t movedEntity = record.archetype->removeRow(record.row);
+	if (movedEntity != Archetype::INVALID_ENTITY) {
+		records[movedEntity].row = record.row;
+	}
+
+	//Invalidates every outstanding handle to this index
+	record.archetype = nullptr;
+	record.generation++;
+	freeIndices.push_back(entity.index);
+	entityCount--;
+
+	structuralVersion++;
+
+	return this;
 }
 
-ECS* ECS::removeEntity(uint32_t id)
+ECS* ECS::spawn(const Prefab& prefab, uint32_t count, Entity* entities)
 {
-	entities.erase(id);
+	if (count == 0) {
+		return this;
+	}
+
+	Archetype* archetype = getArchetype(prefab.getMask());
+	uint32_t currentVersion = version.load();
 
-	changeFlag = true;
+	size_t reused = std::min<size_t>(freeIndices.size(), count);
+	records.reserve(records.size() + count - reused);
+
+	for (uint32_t i = 0; i < count; ++i) {
+		Entity entity;
+		if (!freeIndices.empty()) {
+			entity.index = freeIndices.back();
+			freeIndices.pop_back();
+		}
+		else {
+			entity.index = static_cast<uint32_t>(records.size());
+			records.emplace_back();
+		}
+
+		EntityRecord& record = records[entity.index];
+		entity.generation = record.generation;
+		record.archetype = archetype;
+		record.row = archetype->pushEntity(entity);
+
+		for (int32_t column = 0; column < static_cast<int32_t>(archetype->columns.size()); ++column) {
+			const ComponentInfo& info = *archetype->columns[column].info;
+			info.copyConstruct(archetype->getComponent(column, record.row), prefab.getComponent(info.id));
+			archetype->setVersion(column, record.row, currentVersion);
+		}
+
+		if (entities) {
+			entities[i] = entity;
+		}
+	}
+
+	entityCount += count;
+	structuralVersion++;
 
 	return this;
 }
 
-void ECS::onEachEntity(std::function<void(std::shared_ptr<Entity>)> callback)
+bool ECS::isAlive(Entity entity) const
+{
+	return entity.index < records.size() && records[entity.index].generation == entity.generation && records[entity.index].archetype != nullptr;
+}
+
+ECS::EntityRecord& ECS::getRecord(Entity entity)
+{
+	if (!isAlive(entity)) {
+		throw std::runtime_error("Stale or invalid entity handle");
+	}
+	return records[entity.index];
+}
+
+Archetype* ECS::getArchetype(ComponentMask mask)
+{
+	auto found = archetypeLookup.find(mask);
+	if (found != archetypeLookup.end()) {
+		return found->second;
+	}
+
+	archetypes.push_back(std::make_unique<Archetype>(mask));
+	archetypeLookup[mask] = archetypes.back().get();
+
+	return archetypes.back().get();
+}
+
+Archetype* ECS::getAddTarget(Archetype* archetype, uint32_t componentId)
+{
+	if (archetype->addEdges[componentId] == nullptr) {
+		Archetype* target = getArchetype(archetype->mask | (1ull << componentId));
+		archetype->addEdges[componentId] = target;
+		target->removeEdges[componentId] = archetype;
+	}
+	return archetype->addEdges[componentId];
+}
+
+Archetype* ECS::getRemoveTarget(Archetype* archetype, uint32_t componentId)
+{
+	if (archetype->removeEdges[componentId] == nullptr) {
+		Archetype* target = getArchetype(archetype->mask & ~(1ull << componentId));
+		archetype->removeEdges[componentId] = target;
+		target->addEdges[componentId] = archetype;
+	}
+	return archetype->removeEdges[componentId];
+}
+
+void ECS::moveEntity(uint32_t index, Archetype* destination)
+{
+	EntityRecord& record = records[index];
+
+	uint32_t destinationRow;
+	uint32_t movedEntity = record.archetype->moveRow(record.row, *destination, destinationRow);
+	if (movedEntity != Archetype::INVALID_ENTITY) {
+		records[movedEntity].row = record.row;
+	}
+
+	record.archetype = destination;
+	record.row = destinationRow;
+}
+
+void* ECS::getComponentPointer(Entity entity, uint32_t componentId, bool write)
 {
-	for (const auto& entityPair : entities) {
-		callback(entityPair.second);
+	if (!isAlive(entity)) {
+		return nullptr;
+	}
+
+	EntityRecord& record = records[entity.index];
+	int32_t column = record.archetype->getColumnIndex(componentId);
+	if (column < 0) {
+		return nullptr;
+	}
+
+	if (write) {
+		record.archetype->setVersion(column, record.row, version.load());
 	}
+
+	return record.archetype->getComponent(column, record.row);
+}
+
+Query& ECS::getQuery(ComponentMask mask)
+{
+	std::lock_guard<std::mutex> lock(queryMutex);
+
+	Query& query = queries[mask];
+	query.mask = mask;
+
+	for (; query.checkedArchetypes < archetypes.size(); ++query.checkedArchetypes) {
+		Archetype* archetype = archetypes[query.checkedArchetypes].get();
+		if ((archetype->mask & mask) == mask) {
+			query.archetypes.push_back(archetype);
+		}
+	}
+
+	return query;
 }
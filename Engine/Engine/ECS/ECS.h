@@ -2,9 +2,15 @@
 #include <memory>
 #include <vector>
 #include <unordered_map>
-#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <mutex>
+#include <atomic>
 #include "Entity/Entity.h"
 #include "Component/Component.h"
+#include "Archetype/Archetype.h"
+#include "View/View.h"
+#include "Prefab/Prefab.h"
 
 
 class ECS
@@ -15,58 +21,119 @@ public:
 	~ECS();
 
 
-	ECS* addEntity(std::shared_ptr<Entity> entity);
-	std::shared_ptr<Entity> getEntityById(uint32_t id);
-	ECS* removeEntity(uint32_t id);
+	//Reuses a freed index when there is one
+	Entity createEntity();
+	ECS* destroyEntity(Entity entity);
+	bool isAlive(Entity entity) const;
 
-	template <typename T> ECS* addComponent(std::shared_ptr<Entity> entity, std::shared_ptr<T> component);
-	template <typename T> std::shared_ptr<T> getComponent(std::shared_ptr<Entity> entity);
-	template <typename T> ECS* removeComponent(uint32_t entityId, std::type_index componentType);
+	//count entities with copies of the prefab's components, placed straight into the prefab's archetype.
+	//Handles are written to entities when it is given (count elements)
+	ECS* spawn(const Prefab& prefab, uint32_t count, Entity* entities = nullptr);
 
-	void onEachEntity(std::function<void(std::shared_ptr<Entity>)> callback);
+	//Components are copied into archetype storage, the returned pointers do not own them
+	//and stay valid until the next structural change (add/remove of entities or components)
+	//getComponent<T> counts as a write and bumps the change version, getComponent<const T> does not
+	template <typename T> ECS* addComponent(Entity entity, const T& component = T{});
+	template <typename T> T* getComponent(Entity entity);
+	template <typename T> ECS* removeComponent(Entity entity);
+
+	//ecs.view<Transform, Mesh>().each([](Transform& t, Mesh& m) {...});
+	//Structural changes while iterating go through an EntityCommandBuffer
+	template <typename... Ts> View<Ts...> view();
 
 	size_t getEntityCount() {
-		return entities.size();
+		return entityCount;
+	}
+
+	//Every component write is stamped with the current version. A consumer keeps the value
+	//returned by advanceVersion() and later asks for rows changed after it (View::eachChanged)
+	//Systems may advance it while other systems create views, so it is atomic
+	uint32_t getVersion() const {
+		return version.load();
 	}
 
-	bool changeFlag = true;
-	void resetChangeFlag() {
-		changeFlag = false;
+	uint32_t advanceVersion() {
+		return version.fetch_add(1);
+	}
+
+	//Bumped whenever entities or components are added or removed, rows and pointers may have moved
+	uint32_t getStructuralVersion() const {
+		return structuralVersion;
 	}
 
 
 private:
 
-	std::unordered_map<uint32_t, std::shared_ptr<Entity>> entities;
-	std::unordered_map<uint32_t, std::unordered_map<std::type_index, std::shared_ptr<Component>>> components;
+	//Applies its recorded commands directly on records and archetypes
+	friend class EntityCommandBuffer;
+
+	//One slot per entity index, generation matches the live handle
+	struct EntityRecord {
+		Archetype* archetype = nullptr;
+		uint32_t row = 0;
+		uint32_t generation = 0;
+	};
+
+	EntityRecord& getRecord(Entity entity);
+	Archetype* getArchetype(ComponentMask mask);
+	Archetype* getAddTarget(Archetype* archetype, uint32_t componentId);
+	Archetype* getRemoveTarget(Archetype* archetype, uint32_t componentId);
+	void moveEntity(uint32_t index, Archetype* destination);
+	void* getComponentPointer(Entity entity, uint32_t componentId, bool write);
+	Query& getQuery(ComponentMask mask);
+
+	std::vector<EntityRecord> records;
+	std::vector<uint32_t> freeIndices;
+	size_t entityCount = 0;
+
+	std::atomic<uint32_t> version{ 1 };
+	uint32_t structuralVersion = 1;
+
+	std::vector<std::unique_ptr<Archetype>> archetypes;
+	std::unordered_map<ComponentMask, Archetype*> archetypeLookup;
+
+	//Systems running in parallel may create views at the same time
+	std::unordered_map<ComponentMask, Query> queries;
+	std::mutex queryMutex;
 };
 
-template<typename T> inline ECS* ECS::addComponent(std::shared_ptr<Entity> entity, std::shared_ptr<T> component)
+template<typename T> inline ECS* ECS::addComponent(Entity entity, const T& component)
 {
-	components[entity->id][std::type_index(typeid(T))] = component;
+	constexpr uint32_t componentId = ComponentRegistry::getID<T>();
+	ComponentRegistry::registerComponent<T>();
+	EntityRecord& record = getRecord(entity);
 
-	changeFlag = true;
+	if (record.archetype->hasComponent(componentId)) {
+		*static_cast<T*>(getComponentPointer(entity, componentId, true)) = component;
+	}
+	else {
+		moveEntity(entity.index, getAddTarget(record.archetype, componentId));
+		new (getComponentPointer(entity, componentId, true)) T(component);
+		structuralVersion++;
+	}
 
 	return this;
 }
 
-template<typename T> inline std::shared_ptr<T> ECS::getComponent(std::shared_ptr<Entity> entity)
+template<typename T> inline T* ECS::getComponent(Entity entity)
 {
-	auto componentID = std::type_index(typeid(T));
-
-	auto& componentsForEntity = components[entity->id];
-	if (componentsForEntity.find(componentID) != componentsForEntity.end()) {
-		return std::static_pointer_cast<T>(componentsForEntity[componentID]);
-	}
-	
-	return nullptr;
+	return static_cast<T*>(getComponentPointer(entity, ComponentRegistry::getID<T>(), !std::is_const_v<T>));
 }
 
-template<typename T> inline ECS* ECS::removeComponent(uint32_t entityId, std::type_index componentType)
+template<typename T> inline ECS* ECS::removeComponent(Entity entity)
 {
-	components[entityId].erase(componentType);
+	constexpr uint32_t componentId = ComponentRegistry::getID<T>();
+	EntityRecord& record = getRecord(entity);
 
-	changeFlag = true;
+	if (record.archetype->hasComponent(componentId)) {
+		moveEntity(entity.index, getRemoveTarget(record.archetype, componentId));
+		structuralVersion++;
+	}
 
 	return this;
 }
+
+template<typename... Ts> inline View<Ts...> ECS::view()
+{
+	return View<Ts...>(getQuery(ComponentRegistry::getMask<Ts...>()), version.load());
+}
@@ -1,18 +1,20 @@
 #pragma once
 #include <cstdint>
 
+//Plain value handle into the ECS. Indices are recycled through a free list and the
+//generation is bumped on every destroy, so handles to a reused slot are detected as stale
 class Entity
 {
 public:
 
-	Entity();
-	~Entity();
+	static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
 
-	uint32_t id;
+	uint32_t index = INVALID_INDEX;
+	uint32_t generation = 0;
 
-private:
-
-	static uint32_t nextId;
+	bool isNull() const {
+		return index == INVALID_INDEX;
+	}
 
+	bool operator==(const Entity& other) const = default;
 };
-
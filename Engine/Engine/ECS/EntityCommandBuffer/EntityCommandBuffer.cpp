@@ -0,0 +1,215 @@
+#include "EntityCommandBuffer.h"
+
+namespace {
+	std::atomic<uint64_t> nextBufferId{ 1 };
+}
+
+EntityCommandBuffer::EntityCommandBuffer() : id{ nextBufferId.fetch_add(1) }
+{
+}
+
+EntityCommandBuffer::~EntityCommandBuffer()
+{
+	for (auto& stream : streams) {
+		stream->clear();
+	}
+}
+
+Entity EntityCommandBuffer::spawn()
+{
+	Entity entity;
+	entity.index = pendingCount.fetch_add(1);
+	entity.generation = PENDING_GENERATION;
+	return entity;
+}
+
+void EntityCommandBuffer::destroy(Entity entity)
+{
+	record(Command::DESTROY, 0, entity);
+}
+
+void EntityCommandBuffer::playback(ECS& ecs)
+{
+	sorted.clear();
+	for (auto& stream : streams) {
+		sorted.insert(sorted.end(), stream->commands.begin(), stream->commands.end());
+	}
+
+	//Spawned entities start out empty and reach their archetype with the first move below
+	spawned.clear();
+	uint32_t pending = pendingCount.exchange(0);
+	for (uint32_t i = 0; i < pending; ++i) {
+		spawned.push_back(ecs.createEntity());
+	}
+
+	for (Command& command : sorted) {
+		if (command.entity.generation != PENDING_GENERATION) continue;
+
+		if (command.entity.index >= spawned.size()) {
+			throw std::runtime_error("Entity command buffer placeholder used after playback");
+		}
+		command.entity = spawned[command.entity.index];
+	}
+
+	//Grouped by entity so each one is resolved and moved once, in index order to walk records and chunks forward
+	std::sort(sorted.begin(), sorted.end(), [](const Command& a, const Command& b) {
+		return a.entity.index != b.entity.index ? a.entity.index < b.entity.index : a.sequence < b.sequence;
+		});
+
+	size_t begin = 0;
+	while (begin < sorted.size()) {
+		size_t end = begin + 1;
+		while (end < sorted.size() && sorted[end].entity.index == sorted[begin].entity.index) {
+			end++;
+		}
+
+		applyEntity(ecs, begin, end);
+		begin = end;
+	}
+
+	for (auto& stream : streams) {
+		stream->clear();
+	}
+	sequence.store(0);
+}
+
+bool EntityCommandBuffer::isEmpty()
+{
+	std::lock_guard<std::mutex> lock(streamMutex);
+	for (auto& stream : streams) {
+		if (!stream->commands.empty()) return false;
+	}
+	return pendingCount.load() == 0;
+}
+
+void EntityCommandBuffer::applyEntity(ECS& ecs, size_t begin, size_t end)
+{
+	//Commands may be older than the entity that now owns the index, only the live generation is applied
+	Entity entity{};
+	for (size_t i = begin; i < end && entity.isNull(); ++i) {
+		if (ecs.isAlive(sorted[i].entity)) {
+			entity = sorted[i].entity;
+		}
+	}
+	if (entity.isNull()) {
+		return;
+	}
+
+	ECS::EntityRecord& record = ecs.records[entity.index];
+	ComponentMask mask = record.archetype->mask;
+
+	//Last value added for each component that ends up on the entity
+	std::array<void*, MAX_COMPONENT_TYPES> added{};
+	for (size_t i = begin; i < end; ++i) {
+		const Command& command = sorted[i];
+		if (command.entity != entity) continue;
+
+		switch (command.type) {
+		case Command::DESTROY:
+			ecs.destroyEntity(entity);
+			return;
+		case Command::ADD:
+			mask |= 1ull << command.componentId;
+			added[command.componentId] = command.component;
+			break;
+		case Command::REMOVE:
+			mask &= ~(1ull << command.componentId);
+			added[command.componentId] = nullptr;
+			break;
+		}
+	}
+
+	Archetype* source = record.archetype;
+	if (mask != source->mask) {
+		ecs.moveEntity(entity.index, ecs.getArchetype(mask));
+		ecs.structuralVersion++;
+	}
+
+	//Components new to the entity were left unconstructed by the move, existing ones are replaced
+	uint32_t version = ecs.getVersion();
+	for (uint32_t componentId = 0; componentId < MAX_COMPONENT_TYPES; ++componentId) {
+		if (!added[componentId]) continue;
+
+		const ComponentInfo& info = ComponentRegistry::getInfo(componentId);
+		int32_t column = record.archetype->getColumnIndex(componentId);
+		void* component = record.archetype->getComponent(column, record.row);
+
+		if (source->hasComponent(componentId)) {
+			info.destroy(component);
+		}
+		info.moveConstruct(component, added[componentId]);
+		record.archetype->setVersion(column, record.row, version);
+	}
+}
+
+EntityCommandBuffer::Stream& EntityCommandBuffer::getStream()
+{
+	thread_local uint64_t cachedId = 0;
+	thread_local Stream* cachedStream = nullptr;
+	if (cachedId == id) {
+		return *cachedStream;
+	}
+
+	std::lock_guard<std::mutex> lock(streamMutex);
+	Stream*& stream = threadStreams[std::this_thread::get_id()];
+	if (!stream) {
+		streams.push_back(std::make_unique<Stream>());
+		stream = streams.back().get();
+	}
+
+	cachedId = id;
+	cachedStream = stream;
+	return *stream;
+}
+
+void EntityCommandBuffer::record(Command::TYPE type, uint32_t componentId, Entity entity, void* component)
+{
+	if (entity.isNull()) {
+		throw std::runtime_error("Null entity recorded in entity command buffer");
+	}
+
+	getStream().commands.push_back({
+		.type = type,
+		.componentId = componentId,
+		.entity = entity,
+		.sequence = sequence.fetch_add(1, std::memory_order_relaxed),
+		.component = component
+		});
+}
+
+void* EntityCommandBuffer::Stream::allocate(size_t size, size_t alignment)
+{
+	if (size + alignment > BLOCK_SIZE) {
+		throw std::runtime_error("Component too large for entity command buffer");
+	}
+
+	while (true) {
+		if (block == blocks.size()) {
+			blocks.push_back(std::make_unique<std::byte[]>(BLOCK_SIZE));
+		}
+
+		uintptr_t base = reinterpret_cast<uintptr_t>(blocks[block].get());
+		uintptr_t address = (base + offset + alignment - 1) & ~(uintptr_t(alignment) - 1);
+		if (address + size <= base + BLOCK_SIZE) {
+			offset = address + size - base;
+			return reinterpret_cast<void*>(address);
+		}
+
+		block++;
+		offset = 0;
+	}
+}
+
+void EntityCommandBuffer::Stream::clear()
+{
+	//Added components were moved from on playback (or never used), either way they still need destroying
+	for (Command& command : commands) {
+		if (command.type == Command::ADD) {
+			ComponentRegistry::getInfo(command.componentId).destroy(command.component);
+		}
+	}
+
+	commands.clear();
+	block = 0;
+	offset = 0;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include "../ECS.h"
+
+
+//Records structural changes (spawn, destroy, add and remove components) instead of making them, so they
+//can be issued while iterating views or from worker threads. Every recording thread appends to its own
+//stream without locking. playback() applies everything at a sync point, sorted by entity, and moves each
+//entity to its final archetype once no matter how many components were added or removed
+class EntityCommandBuffer
+{
+public:
+
+	EntityCommandBuffer();
+	EntityCommandBuffer(const EntityCommandBuffer&) = delete;
+	EntityCommandBuffer& operator=(const EntityCommandBuffer&) = delete;
+	~EntityCommandBuffer();
+
+	//Placeholder handle, only valid for further commands in this buffer. Becomes a real entity on playback
+	Entity spawn();
+	void destroy(Entity entity);
+
+	//Components are copied into the buffer now and moved into the ECS on playback
+	template <typename T> void addComponent(Entity entity, const T& component = T{});
+	template <typename T> void removeComponent(Entity entity);
+
+	//Applies and clears every command, must not overlap with recording. Commands for one entity keep
+	//their recording order, commands for entities that are no longer alive are dropped
+	void playback(ECS& ecs);
+
+	bool isEmpty();
+
+private:
+
+	static constexpr uint32_t PENDING_GENERATION = UINT32_MAX;
+	static constexpr size_t BLOCK_SIZE = 16 * 1024;
+
+	struct Command {
+		enum TYPE : uint32_t {
+			DESTROY,
+			ADD,
+			REMOVE
+		};
+
+		TYPE type;
+		uint32_t componentId;
+		Entity entity;
+		uint64_t sequence;
+		//ADD only, constructed in the stream's blocks
+		void* component;
+	};
+
+	//Commands of one recording thread. Blocks are kept between playbacks and reused
+	struct Stream {
+		std::vector<Command> commands;
+		std::vector<std::unique_ptr<std::byte[]>> blocks;
+		size_t block = 0;
+		size_t offset = 0;
+
+		void* allocate(size_t size, size_t alignment);
+		void clear();
+	};
+
+	Stream& getStream();
+	void record(Command::TYPE type, uint32_t componentId, Entity entity, void* component = nullptr);
+	void applyEntity(ECS& ecs, size_t begin, size_t end);
+
+	//Unique per buffer, lets each thread cache its stream without the cache outliving the buffer
+	uint64_t id;
+
+	std::vector<std::unique_ptr<Stream>> streams;
+	std::unordered_map<std::thread::id, Stream*> threadStreams;
+	std::mutex streamMutex;
+
+	std::atomic<uint64_t> sequence{ 0 };
+	std::atomic<uint32_t> pendingCount{ 0 };
+
+	//Scratch for playback
+	std::vector<Command> sorted;
+	std::vector<Entity> spawned;
+};
+
+template<typename T> inline void EntityCommandBuffer::addComponent(Entity entity, const T& component)
+{
+	ComponentRegistry::registerComponent<T>();
+	void* data = getStream().allocate(sizeof(T), alignof(T));
+	new (data) T(component);
+	record(Command::ADD, ComponentRegistry::getID<T>(), entity, data);
+}
+
+template<typename T> inline void EntityCommandBuffer::removeComponent(Entity entity)
+{
+	record(Command::REMOVE, ComponentRegistry::getID<T>(), entity);
+}
@@ -0,0 +1,22 @@
+#include "Prefab.h"
+
+Prefab::~Prefab()
+{
+	for (uint32_t componentId = 0; componentId < MAX_COMPONENT_TYPES; ++componentId) {
+		destroyComponent(componentId);
+	}
+}
+
+void Prefab::destroyComponent(uint32_t componentId)
+{
+	if (!components[componentId]) {
+		return;
+	}
+
+	const ComponentInfo& info = ComponentRegistry::getInfo(componentId);
+	info.destroy(components[componentId]);
+	::operator delete(components[componentId], std::align_val_t{ info.alignment });
+
+	components[componentId] = nullptr;
+	mask &= ~(1ull << componentId);
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <array>
+#include <new>
+#include "../Archetype/Archetype.h"
+
+
+//A set of component values to stamp out many entities from. ecs.spawn(prefab, count) creates all of
+//them directly in the prefab's archetype, copying the values, without going through addComponent
+class Prefab
+{
+public:
+
+	Prefab() = default;
+	Prefab(const Prefab&) = delete;
+	Prefab& operator=(const Prefab&) = delete;
+	~Prefab();
+
+	//Replaces the value if the prefab already has T
+	template <typename T> Prefab& set(const T& component = T{});
+	template <typename T> Prefab& remove();
+	template <typename T> T* get();
+
+	ComponentMask getMask() const {
+		return mask;
+	}
+
+	const void* getComponent(uint32_t componentId) const {
+		return components[componentId];
+	}
+
+private:
+
+	void destroyComponent(uint32_t componentId);
+
+	ComponentMask mask = 0;
+	std::array<void*, MAX_COMPONENT_TYPES> components{};
+};
+
+template<typename T> inline Prefab& Prefab::set(const T& component)
+{
+	constexpr uint32_t componentId = ComponentRegistry::getID<T>();
+	ComponentRegistry::registerComponent<T>();
+
+	destroyComponent(componentId);
+	components[componentId] = ::operator new(sizeof(T), std::align_val_t{ alignof(T) });
+	new (components[componentId]) T(component);
+	mask |= 1ull << componentId;
+
+	return *this;
+}
+
+template<typename T> inline Prefab& Prefab::remove()
+{
+	destroyComponent(ComponentRegistry::getID<T>());
+	return *this;
+}
+
+template<typename T> inline T* Prefab::get()
+{
+	return static_cast<T*>(components[ComponentRegistry::getID<T>()]);
+}
@@ -0,0 +1,83 @@
+#include "Scheduler.h"
+
+Scheduler::Scheduler(JobSystem& jobSystem) : jobSystem{ jobSystem }
+{
+}
+
+Scheduler::~Scheduler()
+{
+}
+
+void Scheduler::addSystem(std::unique_ptr<System> system)
+{
+	system->jobSystem = &jobSystem;
+	system->commands = &commands;
+	timings.push_back({ .name = system->getName(), .milliseconds = 0.0f });
+	nodes.push_back({ .system = std::move(system) });
+	isGraphDirty = true;
+}
+
+void Scheduler::run(ECS& ecs)
+{
+	if (nodes.empty()) {
+		return;
+	}
+
+	if (isGraphDirty) {
+		buildGraph();
+	}
+
+	for (uint32_t i = 0; i < nodes.size(); ++i) {
+		remaining[i].store(nodes[i].dependencyCount, std::memory_order_relaxed);
+	}
+
+	JobSystem::Counter counter;
+	for (uint32_t root : roots) {
+		schedule(root, ecs, counter);
+	}
+
+	jobSystem.wait(counter);
+	commands.playback(ecs);
+}
+
+void Scheduler::buildGraph()
+{
+	roots.clear();
+	for (auto& node : nodes) {
+		node.dependents.clear();
+		node.dependencyCount = 0;
+	}
+
+	//Edges only point forward, so the graph is acyclic and conflicting systems keep their add order
+	for (uint32_t i = 0; i < nodes.size(); ++i) {
+		for (uint32_t j = 0; j < i; ++j) {
+			if (nodes[i].system->conflictsWith(*nodes[j].system)) {
+				nodes[j].dependents.push_back(i);
+				nodes[i].dependencyCount++;
+			}
+		}
+
+		if (nodes[i].dependencyCount == 0) {
+			roots.push_back(i);
+		}
+	}
+
+	remaining = std::make_unique<std::atomic<uint32_t>[]>(nodes.size());
+	isGraphDirty = false;
+}
+
+void Scheduler::schedule(uint32_t node, ECS& ecs, JobSystem::Counter& counter)
+{
+	jobSystem.submit([this, node, &ecs, &counter] {
+		auto start = std::chrono::high_resolution_clock::now();
+		nodes[node].system->update(ecs);
+		auto end = std::chrono::high_resolution_clock::now();
+		timings[node].milliseconds = std::chrono::duration<float, std::chrono::milliseconds::period>(end - start).count();
+
+		for (uint32_t dependent : nodes[node].dependents) {
+			if (remaining[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				schedule(dependent, ecs, counter);
+			}
+		}
+		}, counter);
+}
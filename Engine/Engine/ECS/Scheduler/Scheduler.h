@@ -0,0 +1,64 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include "../System/System.h"
+#include "../../JobSystem/JobSystem.h"
+
+
+//Runs systems as jobs. Each system depends on every earlier added system it conflicts with
+//(declared reads/writes), so results match running them in order while unrelated systems overlap.
+//Structural changes the systems recorded are applied at the end of run()
+class Scheduler
+{
+public:
+
+	struct Timing {
+		std::string name;
+		float milliseconds;
+	};
+
+	Scheduler(JobSystem& jobSystem);
+	~Scheduler();
+
+	template <typename T, typename... Args> T* addSystem(Args&&... args);
+	void addSystem(std::unique_ptr<System> system);
+
+	void run(ECS& ecs);
+
+	//Timings of the last run, in the order systems were added
+	const std::vector<Timing>& getTimings() const {
+		return timings;
+	}
+
+private:
+
+	struct Node {
+		std::unique_ptr<System> system;
+		std::vector<uint32_t> dependents;
+		uint32_t dependencyCount = 0;
+	};
+
+	void buildGraph();
+	void schedule(uint32_t node, ECS& ecs, JobSystem::Counter& counter);
+
+	JobSystem& jobSystem;
+	EntityCommandBuffer commands;
+
+	std::vector<Node> nodes;
+	std::vector<uint32_t> roots;
+	std::unique_ptr<std::atomic<uint32_t>[]> remaining;
+	bool isGraphDirty = true;
+
+	std::vector<Timing> timings;
+};
+
+template<typename T, typename ...Args> inline T* Scheduler::addSystem(Args&& ...args)
+{
+	auto system = std::make_unique<T>(std::forward<Args>(args)...);
+	T* pointer = system.get();
+	addSystem(std::move(system));
+	return pointer;
+}
@@ -1,12 +1,59 @@
 #pragma once
+#include <string>
 #include "../ECS.h"
+#include "../EntityCommandBuffer/EntityCommandBuffer.h"
 
 class System
 {
 public:
-	
+
+	System(std::string name = "System") : name{ std::move(name) } {}
 	virtual ~System() = default;
 
 	virtual void update(ECS& ecs) = 0;
-};
 
+	const std::string& getName() const {
+		return name;
+	}
+
+	ComponentMask getReadMask() const {
+		return readMask;
+	}
+
+	ComponentMask getWriteMask() const {
+		return writeMask;
+	}
+
+	//Systems conflict when one writes a component the other reads or writes
+	bool conflictsWith(const System& other) const {
+		return (writeMask & (other.readMask | other.writeMask)) || (other.writeMask & readMask);
+	}
+
+protected:
+
+	//Declared in the constructor of a derived system, the Scheduler only runs systems
+	//in parallel when these do not overlap. update() must not add or remove entities or components,
+	//it records them in commands instead
+	template <typename... Ts> void reads() {
+		readMask |= ComponentRegistry::getMask<Ts...>();
+	}
+
+	template <typename... Ts> void writes() {
+		writeMask |= ComponentRegistry::getMask<Ts...>();
+	}
+
+	//Set by the Scheduler, lets update() split a large view with eachParallel or submit its own jobs
+	JobSystem* jobSystem = nullptr;
+
+	//Set by the Scheduler, shared by all systems and played back once every system of a run finished.
+	//Safe to record into from any job
+	EntityCommandBuffer* commands = nullptr;
+
+private:
+
+	friend class Scheduler;
+
+	std::string name;
+	ComponentMask readMask = 0;
+	ComponentMask writeMask = 0;
+};
@@ -0,0 +1,189 @@
+#include "TransformSystem.h"
+
+namespace {
+	constexpr uint32_t UNKNOWN_DEPTH = UINT32_MAX;
+	constexpr uint32_t BATCH_SIZE = 256;
+}
+
+TransformSystem::TransformSystem() : System("TransformSystem")
+{
+	writes<Transform>();
+}
+
+void TransformSystem::update(ECS& ecs)
+{
+	run++;
+	//Only adding, removing or moving entities with a Transform can change the hierarchy
+	bool rebuild = structuralVersion != ecs.view<const Transform>().getStructuralVersion();
+
+	//Everything written since the last run needs a new local matrix, a changed parent link moves the entity to another level
+	changedTransforms.clear();
+	ecs.view<Transform>().eachChanged(lastVersion, [&](Entity entity, Transform& transform) {
+		changedTransforms.push_back(&transform);
+
+		if (entity.index >= updatedRuns.size()) {
+			updatedRuns.resize(entity.index + 1, 0);
+		}
+		updatedRuns[entity.index] = run;
+
+		rebuild |= entity.index >= parents.size() || parents[entity.index] != transform.parent;
+		});
+
+	uint32_t batchCount = static_cast<uint32_t>((changedTransforms.size() + BATCH_SIZE - 1) / BATCH_SIZE);
+	auto computeBatch = [this](uint32_t batch) {
+		computeLocalMatrices(batch * BATCH_SIZE, std::min<uint32_t>((batch + 1) * BATCH_SIZE, static_cast<uint32_t>(changedTransforms.size())));
+		};
+
+	if (jobSystem) {
+		jobSystem->parallelFor(batchCount, 1, computeBatch);
+	}
+	else {
+		for (uint32_t batch = 0; batch < batchCount; ++batch) {
+			computeBatch(batch);
+		}
+	}
+
+	if (rebuild) {
+		buildLevels(ecs);
+	}
+
+	//World matrices top down. A rebuild recomputes everything, parents may have been removed.
+	//Rows are written through const lookups so only transforms whose world matrix moved get a new version
+	if (rebuild || !changedTransforms.empty()) {
+		for (auto& level : levels) {
+			work.clear();
+			for (Entity entity : level) {
+				Entity parent = parents[entity.index];
+				bool isParentUpdated = !parent.isNull() && parent.index < updatedRuns.size() && updatedRuns[parent.index] == run;
+				if (!rebuild && !isParentUpdated && updatedRuns[entity.index] != run) continue;
+
+				Transform* transform = const_cast<Transform*>(ecs.getComponent<const Transform>(entity));
+				work.push_back({ entity, transform, parent.isNull() ? nullptr : ecs.getComponent<const Transform>(parent), false });
+			}
+
+			auto updateWorld = [this](uint32_t i) {
+				Work& w = work[i];
+				glm::mat4 worldMatrix = w.parent ? w.parent->worldMatrix * w.transform->localMatrix : w.transform->localMatrix;
+				glm::mat3 worldNormalMatrix = w.parent ? w.parent->worldNormalMatrix * w.transform->localNormalMatrix : w.transform->localNormalMatrix;
+
+				w.isChanged = worldMatrix != w.transform->worldMatrix || worldNormalMatrix != w.transform->worldNormalMatrix;
+				w.transform->worldMatrix = worldMatrix;
+				w.transform->worldNormalMatrix = worldNormalMatrix;
+				};
+
+			if (jobSystem) {
+				jobSystem->parallelFor(static_cast<uint32_t>(work.size()), 256, updateWorld);
+			}
+			else {
+				for (uint32_t i = 0; i < work.size(); ++i) {
+					updateWorld(i);
+				}
+			}
+
+			//Versions are stamped here, chunk maxima are shared between rows of different jobs
+			for (Work& w : work) {
+				if (!w.isChanged) continue;
+
+				updatedRuns[w.entity.index] = run;
+				ecs.getComponent<Transform>(w.entity);
+			}
+		}
+	}
+
+	//Everything this run wrote is stamped with the version before the advance, writes after it are seen next run
+	lastVersion = ecs.advanceVersion();
+}
+
+void TransformSystem::computeLocalMatrices(uint32_t begin, uint32_t end)
+{
+	//Transforms live in archetype rows, gathered into structure of arrays for the kernel and copied back
+	float components[10][BATCH_SIZE];
+	glm::mat4 models[BATCH_SIZE];
+	glm::mat3 normals[BATCH_SIZE];
+
+	uint32_t count = end - begin;
+	for (uint32_t i = 0; i < count; ++i) {
+		const Transform& transform = *changedTransforms[begin + i];
+		components[0][i] = transform.position.x;
+		components[1][i] = transform.position.y;
+		components[2][i] = transform.position.z;
+		components[3][i] = transform.rotation.x;
+		components[4][i] = transform.rotation.y;
+		components[5][i] = transform.rotation.z;
+		components[6][i] = transform.rotation.w;
+		components[7][i] = transform.scale.x;
+		components[8][i] = transform.scale.y;
+		components[9][i] = transform.scale.z;
+	}
+
+	TransformKernel::Input input = {
+		components[0], components[1], components[2],
+		components[3], components[4], components[5], components[6],
+		components[7], components[8], components[9]
+	};
+	TransformKernel::compute(input, count, models, normals);
+
+	for (uint32_t i = 0; i < count; ++i) {
+		changedTransforms[begin + i]->localMatrix = models[i];
+		changedTransforms[begin + i]->localNormalMatrix = normals[i];
+	}
+}
+
+void TransformSystem::buildLevels(ECS& ecs)
+{
+	structuralVersion = ecs.view<const Transform>().getStructuralVersion();
+
+	//Live handle per index for every entity with a Transform, parents without one count as missing
+	std::vector<Entity> entities;
+	ecs.view<const Transform>().each([&](Entity entity, const Transform& transform) {
+		if (entity.index >= entities.size()) {
+			entities.resize(entity.index + 1);
+			parents.resize(entity.index + 1);
+		}
+		entities[entity.index] = entity;
+		parents[entity.index] = transform.parent;
+		});
+
+	parents.resize(entities.size());
+	updatedRuns.resize(entities.size(), 0);
+	depths.assign(entities.size(), UNKNOWN_DEPTH);
+
+	levels.clear();
+	for (uint32_t index = 0; index < entities.size(); ++index) {
+		if (entities[index].isNull()) continue;
+
+		uint32_t depth = getDepth(index, entities);
+		if (depth >= levels.size()) {
+			levels.resize(depth + 1);
+		}
+		levels[depth].push_back(entities[index]);
+	}
+}
+
+uint32_t TransformSystem::getDepth(uint32_t index, const std::vector<Entity>& entities)
+{
+	//Walk up until a root or an already known depth, then fill in the path on the way back
+	std::vector<uint32_t> path;
+	uint32_t current = index;
+	while (depths[current] == UNKNOWN_DEPTH) {
+		Entity parent = parents[current];
+		bool hasParent = !parent.isNull() && parent.index < entities.size() && entities[parent.index] == parent;
+		if (!hasParent) {
+			depths[current] = 0;
+			break;
+		}
+
+		path.push_back(current);
+		if (path.size() > entities.size()) {
+			throw std::runtime_error("Transform hierarchy contains a cycle");
+		}
+		current = parent.index;
+	}
+
+	uint32_t depth = depths[current];
+	for (auto it = path.rbegin(); it != path.rend(); ++it) {
+		depths[*it] = ++depth;
+	}
+
+	return depths[index];
+}
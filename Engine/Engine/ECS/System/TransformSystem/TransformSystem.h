@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+#include <stdexcept>
+#include "../System.h"
+#include "../../../TransformKernel/TransformKernel.h"
+
+
+//Keeps Transform::localMatrix and worldMatrix up to date. Only transforms written since the last run
+//and their descendants are recomputed. Entities are grouped by depth in the hierarchy and a level only
+//reads the level above it, so every level is updated in parallel
+class TransformSystem : public System
+{
+public:
+
+	TransformSystem();
+
+	void update(ECS& ecs) override;
+
+private:
+
+	struct Work {
+		Entity entity;
+		Transform* transform;
+		const Transform* parent;
+		bool isChanged;
+	};
+
+	void computeLocalMatrices(uint32_t begin, uint32_t end);
+	void buildLevels(ECS& ecs);
+	uint32_t getDepth(uint32_t index, const std::vector<Entity>& entities);
+
+	//Breadth first, levels[0] holds the roots
+	std::vector<std::vector<Entity>> levels;
+
+	//Indexed by entity index
+	std::vector<Entity> parents;
+	std::vector<uint32_t> depths;
+	std::vector<uint32_t> updatedRuns;
+
+	std::vector<Transform*> changedTransforms;
+	std::vector<Work> work;
+
+	uint32_t run = 0;
+	uint32_t lastVersion = 0;
+	uint32_t structuralVersion = UINT32_MAX;
+};
@@ -0,0 +1,150 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <array>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include "../Archetype/Archetype.h"
+#include "../../JobSystem/JobSystem.h"
+
+
+//Archetypes matching a component mask. Owned by the ECS and kept between frames,
+//only archetypes created after the last lookup are tested again
+struct Query {
+	ComponentMask mask = 0;
+	std::vector<Archetype*> archetypes;
+	size_t checkedArchetypes = 0;
+};
+
+
+//Typed iteration over every entity that has all of Ts. The callback gets Ts&... (optionally
+//preceded by the Entity handle) and is called directly, no type erasure. Do not add or remove
+//entities or components from inside each(), record them in an EntityCommandBuffer instead
+//Non-const Ts are treated as written and get the current change version, const Ts are read only
+template <typename... Ts>
+class View
+{
+public:
+
+	View(Query& query, uint32_t version) : query{ query }, version{ version } {}
+
+	template <typename F> void each(F&& function) {
+		iterate(function, false, 0);
+	}
+
+	//Only rows where any of Ts changed after version since, whole chunks are skipped by their max version
+	template <typename F> void eachChanged(uint32_t since, F&& function) {
+		iterate(function, true, since);
+	}
+
+	//Chunks are grouped into jobs of at least minRows rows and run on the job system. The callback runs
+	//concurrently for different rows, so it must only touch the components it is given
+	template <typename F> void eachParallel(JobSystem& jobSystem, F&& function, uint32_t minRows = 1024) {
+		std::vector<std::pair<Archetype*, Archetype::Chunk*>> chunks;
+		std::vector<uint32_t> ranges{ 0 };
+		uint32_t rows = 0;
+		for (Archetype* archetype : query.archetypes) {
+			for (auto& chunk : archetype->chunks) {
+				chunks.push_back({ archetype, &chunk });
+				rows += chunk.count;
+				if (rows >= minRows) {
+					ranges.push_back(static_cast<uint32_t>(chunks.size()));
+					rows = 0;
+				}
+			}
+		}
+		if (ranges.back() != chunks.size()) {
+			ranges.push_back(static_cast<uint32_t>(chunks.size()));
+		}
+
+		jobSystem.parallelFor(static_cast<uint32_t>(ranges.size() - 1), 1, [&](uint32_t range) {
+			for (uint32_t i = ranges[range]; i < ranges[range + 1]; ++i) {
+				Archetype* archetype = chunks[i].first;
+				std::array<int32_t, COUNT> columns = { archetype->getColumnIndex(ComponentRegistry::getID<Ts>())... };
+				eachInChunk(function, *archetype, *chunks[i].second, columns, false, 0, std::index_sequence_for<Ts...>{});
+			}
+			});
+	}
+
+	size_t count() const {
+		size_t total = 0;
+		for (Archetype* archetype : query.archetypes) {
+			total += archetype->getEntityCount();
+		}
+		return total;
+	}
+
+	//Changes whenever an entity with all of Ts is added, removed or moved to another archetype
+	uint32_t getStructuralVersion() const {
+		uint32_t total = 0;
+		for (Archetype* archetype : query.archetypes) {
+			total += archetype->getStructuralVersion();
+		}
+		return total;
+	}
+
+private:
+
+	static constexpr size_t COUNT = sizeof...(Ts);
+	static constexpr std::array<bool, COUNT> writes = { !std::is_const_v<Ts>... };
+
+	template <typename F> void iterate(F& function, bool filter, uint32_t since) {
+		for (Archetype* archetype : query.archetypes) {
+			if (archetype->getEntityCount() == 0) continue;
+
+			std::array<int32_t, COUNT> columns = { archetype->getColumnIndex(ComponentRegistry::getID<Ts>())... };
+			for (auto& chunk : archetype->chunks) {
+				if (filter && !isChunkChanged(chunk, columns, since)) continue;
+
+				eachInChunk(function, *archetype, chunk, columns, filter, since, std::index_sequence_for<Ts...>{});
+			}
+		}
+	}
+
+	bool isChunkChanged(const Archetype::Chunk& chunk, const std::array<int32_t, COUNT>& columns, uint32_t since) const {
+		for (size_t c = 0; c < COUNT; ++c) {
+			if (chunk.versions[columns[c]] > since) return true;
+		}
+		return false;
+	}
+
+	template <typename F, size_t... I>
+	void eachInChunk(F& function, Archetype& archetype, Archetype::Chunk& chunk, const std::array<int32_t, COUNT>& columns, bool filter, uint32_t since, std::index_sequence<I...>) {
+		std::tuple<Ts*...> arrays{ archetype.template getColumn<std::remove_cv_t<Ts>>(columns[I], chunk)... };
+		std::array<uint32_t*, COUNT> versions = { archetype.getVersions(columns[I], chunk)... };
+		[[maybe_unused]] Entity* entities = archetype.getEntities(chunk);
+
+		bool written = false;
+		for (uint32_t i = 0; i < chunk.count; ++i) {
+			if (filter) {
+				bool changed = false;
+				for (size_t c = 0; c < COUNT; ++c) {
+					changed |= versions[c][i] > since;
+				}
+				if (!changed) continue;
+			}
+
+			for (size_t c = 0; c < COUNT; ++c) {
+				if (writes[c]) versions[c][i] = version;
+			}
+			written = true;
+
+			if constexpr (std::is_invocable_v<F&, Entity, Ts&...>) {
+				function(entities[i], std::get<I>(arrays)[i]...);
+			}
+			else {
+				function(std::get<I>(arrays)[i]...);
+			}
+		}
+
+		if (written) {
+			for (size_t c = 0; c < COUNT; ++c) {
+				if (writes[c]) chunk.versions[columns[c]] = version;
+			}
+		}
+	}
+
+	Query& query;
+	uint32_t version;
+};
@@ -0,0 +1,203 @@
+#include "JobSystem.h"
+
+namespace {
+	//Which job system and queue the current thread belongs to
+	thread_local JobSystem* currentJobSystem = nullptr;
+	thread_local uint32_t currentQueue = 0;
+
+	constexpr uint32_t SPIN_COUNT = 64;
+}
+
+JobSystem::JobSystem(uint32_t threadCount)
+{
+	if (threadCount == 0) {
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	queues.reserve(threadCount);
+	for (uint32_t i = 0; i < threadCount; ++i) {
+		queues.push_back(std::make_unique<Queue>());
+	}
+
+	threads.reserve(threadCount - 1);
+	for (uint32_t i = 1; i < threadCount; ++i) {
+		threads.emplace_back(&JobSystem::workerLoop, this, i);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	stopping.store(true);
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	sleepCondition.notify_all();
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+}
+
+void JobSystem::submit(Job job, Counter& counter, Counter* dependency)
+{
+	counter.pending.fetch_add(1, std::memory_order_relaxed);
+
+	if (dependency) {
+		std::lock_guard<std::mutex> lock(dependency->mutex);
+		if (dependency->pending.load(std::memory_order_acquire) != 0) {
+			dependency->continuations.push_back({ std::move(job), &counter });
+			return;
+		}
+	}
+
+	push({ std::move(job), &counter });
+}
+
+void JobSystem::wait(Counter& counter)
+{
+	uint32_t index = getQueueIndex();
+
+	while (!counter.isDone()) {
+		Task task;
+		if (pop(task) || steal(task, index)) {
+			execute(task);
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(counter.mutex);
+	if (counter.exception) {
+		std::exception_ptr exception = counter.exception;
+		counter.exception = nullptr;
+		std::rethrow_exception(exception);
+	}
+}
+
+void JobSystem::push(Task task)
+{
+	Queue& queue = *queues[getQueueIndex()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(std::move(task));
+	}
+
+	//Pairs with the sleeping/queued check in workerLoop, one of the two sides always sees the other
+	queuedTasks.fetch_add(1);
+	if (sleepingThreads.load() != 0) {
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+		}
+		sleepCondition.notify_one();
+	}
+}
+
+bool JobSystem::pop(Task& task)
+{
+	Queue& queue = *queues[getQueueIndex()];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (queue.tasks.empty()) {
+		return false;
+	}
+
+	task = std::move(queue.tasks.back());
+	queue.tasks.pop_back();
+	queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+	return true;
+}
+
+bool JobSystem::steal(Task& task, uint32_t thief)
+{
+	uint32_t queueCount = static_cast<uint32_t>(queues.size());
+	for (uint32_t i = 1; i < queueCount; ++i) {
+		Queue& queue = *queues[(thief + i) % queueCount];
+
+		std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+		if (!lock.owns_lock() || queue.tasks.empty()) continue;
+
+		task = std::move(queue.tasks.front());
+		queue.tasks.pop_front();
+		queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+	return false;
+}
+
+void JobSystem::execute(Task& task)
+{
+	try {
+		task.job();
+	}
+	catch (...) {
+		std::lock_guard<std::mutex> lock(task.counter->mutex);
+		if (!task.counter->exception) {
+			task.counter->exception = std::current_exception();
+		}
+	}
+
+	finish(*task.counter);
+}
+
+void JobSystem::finish(Counter& counter)
+{
+	//Not the last job, nothing can be waiting on this decrement
+	uint32_t pending = counter.pending.load(std::memory_order_relaxed);
+	while (pending > 1) {
+		if (counter.pending.compare_exchange_weak(pending, pending - 1, std::memory_order_acq_rel)) {
+			return;
+		}
+	}
+
+	//The last decrement happens under the lock, wait() takes the same lock before the counter can be destroyed
+	std::vector<std::pair<Job, Counter*>> continuations;
+	{
+		std::lock_guard<std::mutex> lock(counter.mutex);
+		if (counter.pending.load(std::memory_order_relaxed) == 1) {
+			continuations.swap(counter.continuations);
+		}
+		counter.pending.fetch_sub(1, std::memory_order_acq_rel);
+	}
+
+	for (auto& [job, continuationCounter] : continuations) {
+		push({ std::move(job), continuationCounter });
+	}
+}
+
+void JobSystem::workerLoop(uint32_t index)
+{
+	currentJobSystem = this;
+	currentQueue = index;
+
+	while (true) {
+		Task task;
+		bool found = false;
+		for (uint32_t spin = 0; spin < SPIN_COUNT && !found; ++spin) {
+			found = pop(task) || steal(task, index);
+			if (!found) {
+				std::this_thread::yield();
+			}
+		}
+
+		if (found) {
+			execute(task);
+			continue;
+		}
+
+		sleepingThreads.fetch_add(1);
+		{
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			sleepCondition.wait(lock, [this] { return stopping.load() || queuedTasks.load() != 0; });
+		}
+		sleepingThreads.fetch_sub(1);
+
+		if (stopping.load() && queuedTasks.load() == 0) {
+			return;
+		}
+	}
+}
+
+uint32_t JobSystem::getQueueIndex() const
+{
+	return currentJobSystem == this ? currentQueue : 0;
+}
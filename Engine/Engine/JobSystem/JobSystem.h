@@ -0,0 +1,124 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <algorithm>
+
+
+//Work stealing job system. Every thread has its own deque, the owner pushes and pops at the back
+//(newest first, cache warm) and idle threads steal from the front of other deques (oldest first)
+class JobSystem
+{
+public:
+
+	using Job = std::function<void()>;
+
+	//Counts unfinished jobs of one batch. Jobs submitted with a dependency are held here until
+	//it drops to zero. The first exception thrown by a job is rethrown from wait()
+	class Counter {
+	public:
+		//Only for polling, call wait() before destroying a counter that still had jobs
+		bool isDone() const {
+			return pending.load(std::memory_order_acquire) == 0;
+		}
+
+	private:
+		friend class JobSystem;
+
+		std::atomic<uint32_t> pending{ 0 };
+		std::mutex mutex;
+		std::vector<std::pair<Job, Counter*>> continuations;
+		std::exception_ptr exception;
+	};
+
+	JobSystem(uint32_t threadCount = 0);
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+	~JobSystem();
+
+	//dependency: the job only becomes runnable once that counter reaches zero
+	void submit(Job job, Counter& counter, Counter* dependency = nullptr);
+
+	//The calling thread runs jobs while it waits, so jobs may submit and wait on other jobs
+	void wait(Counter& counter);
+
+	//function(i) for every i in [0, count), batchSize indices per job. Returns when all are done
+	template <typename F> void parallelFor(uint32_t count, uint32_t batchSize, F&& function);
+
+	//Workers plus the thread that created the job system
+	uint32_t getThreadCount() const {
+		return static_cast<uint32_t>(queues.size());
+	}
+
+private:
+
+	struct Task {
+		Job job;
+		Counter* counter = nullptr;
+	};
+
+	struct alignas(64) Queue {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	void push(Task task);
+	bool pop(Task& task);
+	bool steal(Task& task, uint32_t thief);
+	void execute(Task& task);
+	void finish(Counter& counter);
+	void workerLoop(uint32_t index);
+	uint32_t getQueueIndex() const;
+
+	//Queue 0 belongs to the creating thread and any other thread that is not a worker
+	std::vector<std::unique_ptr<Queue>> queues;
+	std::vector<std::thread> threads;
+
+	std::atomic<uint32_t> queuedTasks{ 0 };
+	std::atomic<uint32_t> sleepingThreads{ 0 };
+	std::mutex sleepMutex;
+	std::condition_variable sleepCondition;
+	std::atomic<bool> stopping{ false };
+};
+
+template<typename F> inline void JobSystem::parallelFor(uint32_t count, uint32_t batchSize, F&& function)
+{
+	if (count == 0) {
+		return;
+	}
+	batchSize = std::max(batchSize, 1u);
+
+	Counter counter;
+	//The first batch runs on the calling thread, the rest are stolen by idle workers
+	for (uint32_t begin = batchSize; begin < count; begin += batchSize) {
+		uint32_t end = std::min(begin + batchSize, count);
+		submit([&function, begin, end] {
+			for (uint32_t i = begin; i < end; ++i) {
+				function(i);
+			}
+			}, counter);
+	}
+
+	//Jobs reference function, so they have to finish before an exception leaves this frame
+	std::exception_ptr exception;
+	try {
+		for (uint32_t i = 0; i < std::min(batchSize, count); ++i) {
+			function(i);
+		}
+	}
+	catch (...) {
+		exception = std::current_exception();
+	}
+
+	wait(counter);
+	if (exception) {
+		std::rethrow_exception(exception);
+	}
+}
@@ -0,0 +1,112 @@
+#include "RadixSort.h"
+#include "../JobSystem/JobSystem.h"
+
+#include <array>
+#include <algorithm>
+
+namespace {
+
+	constexpr uint32_t DIGIT_BITS = 8;
+	constexpr uint32_t DIGIT_COUNT = 1 << DIGIT_BITS;
+	constexpr uint32_t PASS_COUNT = 64 / DIGIT_BITS;
+	//Below this a chunk is not worth a job
+	constexpr uint32_t MIN_CHUNK_SIZE = 4096;
+
+	using Histogram = std::array<uint32_t, DIGIT_COUNT>;
+
+	uint32_t getDigit(uint64_t key, uint32_t pass) {
+		return static_cast<uint32_t>(key >> (pass * DIGIT_BITS)) & (DIGIT_COUNT - 1);
+	}
+
+}
+
+void RadixSort::sort(std::vector<Item>& items, std::vector<Item>& scratch, JobSystem* jobSystem)
+{
+	uint32_t count = static_cast<uint32_t>(items.size());
+	if (count < 2) {
+		return;
+	}
+	scratch.resize(count);
+
+	uint32_t chunkCount = 1;
+	if (jobSystem) {
+		chunkCount = std::clamp(count / MIN_CHUNK_SIZE, 1u, jobSystem->getThreadCount());
+	}
+	uint32_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+	auto forEachChunk = [&](auto&& function) {
+		if (chunkCount == 1) {
+			function(0u);
+		}
+		else {
+			jobSystem->parallelFor(chunkCount, 1, function);
+		}
+		};
+
+	//The digit totals do not depend on the order, so one count up front tells which passes can be skipped
+	std::vector<std::array<Histogram, PASS_COUNT>> totals(chunkCount);
+	forEachChunk([&](uint32_t chunk) {
+		auto& histograms = totals[chunk];
+		for (auto& histogram : histograms) {
+			histogram.fill(0);
+		}
+		uint32_t end = std::min(count, (chunk + 1) * chunkSize);
+		for (uint32_t i = chunk * chunkSize; i < end; ++i) {
+			for (uint32_t pass = 0; pass < PASS_COUNT; ++pass) {
+				histograms[pass][getDigit(items[i].key, pass)]++;
+			}
+		}
+		});
+
+	std::vector<Histogram> offsets(chunkCount);
+	Item* source = items.data();
+	Item* destination = scratch.data();
+
+	for (uint32_t pass = 0; pass < PASS_COUNT; ++pass) {
+		bool isShared = false;
+		for (uint32_t digit = 0; digit < DIGIT_COUNT && !isShared; ++digit) {
+			uint32_t total = 0;
+			for (auto& histograms : totals) {
+				total += histograms[pass][digit];
+			}
+			isShared = total == count;
+		}
+		if (isShared) {
+			continue;
+		}
+
+		//Chunks hold different items after every pass, so their own counts are taken again
+		forEachChunk([&](uint32_t chunk) {
+			Histogram& histogram = offsets[chunk];
+			histogram.fill(0);
+			uint32_t end = std::min(count, (chunk + 1) * chunkSize);
+			for (uint32_t i = chunk * chunkSize; i < end; ++i) {
+				histogram[getDigit(source[i].key, pass)]++;
+			}
+			});
+
+		//Digit major, chunk minor. Earlier chunks go first within a digit, which keeps the sort stable
+		uint32_t offset = 0;
+		for (uint32_t digit = 0; digit < DIGIT_COUNT; ++digit) {
+			for (uint32_t chunk = 0; chunk < chunkCount; ++chunk) {
+				uint32_t digitCount = offsets[chunk][digit];
+				offsets[chunk][digit] = offset;
+				offset += digitCount;
+			}
+		}
+
+		forEachChunk([&](uint32_t chunk) {
+			Histogram& histogram = offsets[chunk];
+			uint32_t end = std::min(count, (chunk + 1) * chunkSize);
+			for (uint32_t i = chunk * chunkSize; i < end; ++i) {
+				destination[histogram[getDigit(source[i].key, pass)]++] = source[i];
+			}
+			});
+
+		std::swap(source, destination);
+	}
+
+	if (source != items.data()) {
+		items.swap(scratch);
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+
+//Least significant digit radix sort of 64 bit keys, 8 bits per pass. Stable, so items with equal keys keep their order.
+//Every pass counts and scatters in chunks on the job system, passes over a digit that every key shares are skipped
+class RadixSort
+{
+public:
+
+	struct Item {
+		uint64_t key;
+		uint32_t value;
+	};
+
+	//scratch is resized to match items, keeping it around avoids allocations between sorts.
+	//Small inputs and a null job system sort on the calling thread
+	static void sort(std::vector<Item>& items, std::vector<Item>& scratch, JobSystem* jobSystem = nullptr);
+};
@@ -1,6 +1,6 @@
 #include "ResourceManager.h"
 
-ResourceManager::ResourceManager()
+ResourceManager::ResourceManager(JobSystem* jobSystem) : jobSystem{ jobSystem }
 {
 	loadTexture(createImage("default.png", TEXTURES));
 }
@@ -82,6 +82,8 @@ std::shared_ptr<ResourceManager::MeshResource> ResourceManager::loadOBJ(const st
 			mesh->indices->push_back(uniqueVertices[vertex]);
 		}
 	}
+
+	*mesh->meshlets = buildMeshlets(*mesh->vertices, *mesh->indices);
 	
 	return mesh;
 }
@@ -127,130 +129,138 @@ std::vector<std::shared_ptr<ResourceManager::MeshResource>> ResourceManager::loa
 		gltfToImageResourceID[i] = imageRes->getID();
 	}
 
+	//Primitives are independent, each one is unpacked by its own job
+	std::vector<const tinygltf::Primitive*> primitives;
 	for (const auto& mesh : model.meshes) {
 		for (const auto& primitive : mesh.primitives) {
-			std::shared_ptr<MeshResource> mesh = std::make_shared<MeshResource>();
+			primitives.push_back(&primitive);
+			meshes.push_back(std::make_shared<MeshResource>());
+		}
+	}
 
-			const tinygltf::Accessor& posAcc = model.accessors.at(primitive.attributes.at("POSITION"));
-			const tinygltf::BufferView& posView = model.bufferViews.at(posAcc.bufferView);
-			const tinygltf::Buffer posBuf = model.buffers.at(posView.buffer);
+	forEach(static_cast<uint32_t>(primitives.size()), [&](uint32_t p) {
+		const tinygltf::Primitive& primitive = *primitives[p];
+		std::shared_ptr<MeshResource> mesh = meshes[p];
 
-			const float* positions = reinterpret_cast<const float*>(&posBuf.data[posView.byteOffset + posAcc.byteOffset]);
+		const tinygltf::Accessor& posAcc = model.accessors.at(primitive.attributes.at("POSITION"));
+		const tinygltf::BufferView& posView = model.bufferViews.at(posAcc.bufferView);
+		const tinygltf::Buffer& posBuf = model.buffers.at(posView.buffer);
 
-			const float* normals = nullptr;
-			if (primitive.attributes.count("NORMAL")) {
-				const auto& acc = model.accessors.at(primitive.attributes.at("NORMAL"));
-				const auto& view = model.bufferViews.at(acc.bufferView);
-				const auto& buf = model.buffers.at(view.buffer);
+		const float* positions = reinterpret_cast<const float*>(&posBuf.data[posView.byteOffset + posAcc.byteOffset]);
 
-				normals = reinterpret_cast<const float*>(&buf.data[view.byteOffset + acc.byteOffset]);
-			}
+		const float* normals = nullptr;
+		if (primitive.attributes.count("NORMAL")) {
+			const auto& acc = model.accessors.at(primitive.attributes.at("NORMAL"));
+			const auto& view = model.bufferViews.at(acc.bufferView);
+			const auto& buf = model.buffers.at(view.buffer);
 
-			const float* tangents = nullptr;
-			if (primitive.attributes.count("TANGENT")) {
-				const auto& acc = model.accessors.at(primitive.attributes.at("TANGENT"));
-				const auto& view = model.bufferViews.at(acc.bufferView);
-				const auto& buf = model.buffers.at(view.buffer);
+			normals = reinterpret_cast<const float*>(&buf.data[view.byteOffset + acc.byteOffset]);
+		}
 
-				tangents = reinterpret_cast<const float*>(&buf.data[view.byteOffset + acc.byteOffset]);
-			}
+		const float* tangents = nullptr;
+		if (primitive.attributes.count("TANGENT")) {
+			const auto& acc = model.accessors.at(primitive.attributes.at("TANGENT"));
+			const auto& view = model.bufferViews.at(acc.bufferView);
+			const auto& buf = model.buffers.at(view.buffer);
 
-			const float* uvs = nullptr;
-			if (primitive.attributes.count("TEXCOORD_0")) {
-				const auto& acc = model.accessors.at(primitive.attributes.at("TEXCOORD_0"));
-				const auto& view = model.bufferViews.at(acc.bufferView);
-				const auto& buf = model.buffers.at(view.buffer);
+			tangents = reinterpret_cast<const float*>(&buf.data[view.byteOffset + acc.byteOffset]);
+		}
 
-				uvs = reinterpret_cast<const float*>(&buf.data[view.byteOffset + acc.byteOffset]);
-			}
+		const float* uvs = nullptr;
+		if (primitive.attributes.count("TEXCOORD_0")) {
+			const auto& acc = model.accessors.at(primitive.attributes.at("TEXCOORD_0"));
+			const auto& view = model.bufferViews.at(acc.bufferView);
+			const auto& buf = model.buffers.at(view.buffer);
 
-			const size_t vertexCount = posAcc.count;
-			for (size_t i = 0; i < vertexCount; ++i) {
-				Vertex vertex{};
+			uvs = reinterpret_cast<const float*>(&buf.data[view.byteOffset + acc.byteOffset]);
+		}
 
-				vertex.pos = {
-					positions[i * 3 + 0],
-					positions[i * 3 + 1],
-					positions[i * 3 + 2]
-				};
+		const size_t vertexCount = posAcc.count;
+		for (size_t i = 0; i < vertexCount; ++i) {
+			Vertex vertex{};
 
-				if (normals) {
-					vertex.normal = {
-						normals[i * 3 + 0],
-						normals[i * 3 + 1],
-						normals[i * 3 + 2]
-					};
-				}
+			vertex.pos = {
+				positions[i * 3 + 0],
+				positions[i * 3 + 1],
+				positions[i * 3 + 2]
+			};
 
-				if (tangents) {
-					vertex.tangent = {
-						tangents[i * 4 + 0],
-						tangents[i * 4 + 1],
-						tangents[i * 4 + 2],
-						tangents[i * 4 + 3]
-					};
-				}
+			if (normals) {
+				vertex.normal = {
+					normals[i * 3 + 0],
+					normals[i * 3 + 1],
+					normals[i * 3 + 2]
+				};
+			}
 
-				if (uvs) {
-					vertex.uv = {
-						uvs[i * 2 + 0],
-						uvs[i * 2 + 1]
-					};
-				}
+			if (tangents) {
+				vertex.tangent = {
+					tangents[i * 4 + 0],
+					tangents[i * 4 + 1],
+					tangents[i * 4 + 2],
+					tangents[i * 4 + 3]
+				};
+			}
 
-				vertex.color = { 1.0f, 1.0f, 1.0f };
-				mesh->vertices->push_back(vertex);
+			if (uvs) {
+				vertex.uv = {
+					uvs[i * 2 + 0],
+					uvs[i * 2 + 1]
+				};
 			}
 
-			if (primitive.indices >= 0) {
-				const tinygltf::Accessor& indexAcc = model.accessors.at(primitive.indices);
-				const tinygltf::BufferView indexView = model.bufferViews.at(indexAcc.bufferView);
-				const tinygltf::Buffer indexBuf = model.buffers.at(indexView.buffer);
-
-				const void* data = &indexBuf.data[indexView.byteOffset + indexAcc.byteOffset];
-
-				const size_t indexCount = indexAcc.count;
-				for (size_t i = 0; i < indexCount; ++i) {
-					uint32_t index = 0;
-					
-					switch (indexAcc.componentType) {
-					case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
-						index = reinterpret_cast<const uint8_t*>(data)[i];
-						break;
-					case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
-						index = reinterpret_cast<const uint16_t*>(data)[i];
-						break;
-					case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
-						index = reinterpret_cast<const uint32_t*>(data)[i];
-						break;
-
-					default:
-						throw std::runtime_error("Not supported type index");
-					}
-
-					mesh->indices->push_back(index);
+			vertex.color = { 1.0f, 1.0f, 1.0f };
+			mesh->vertices->push_back(vertex);
+		}
+
+		if (primitive.indices >= 0) {
+			const tinygltf::Accessor& indexAcc = model.accessors.at(primitive.indices);
+			const tinygltf::BufferView indexView = model.bufferViews.at(indexAcc.bufferView);
+			const tinygltf::Buffer& indexBuf = model.buffers.at(indexView.buffer);
+
+			const void* data = &indexBuf.data[indexView.byteOffset + indexAcc.byteOffset];
+
+			const size_t indexCount = indexAcc.count;
+			for (size_t i = 0; i < indexCount; ++i) {
+				uint32_t index = 0;
+				
+				switch (indexAcc.componentType) {
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+					index = reinterpret_cast<const uint8_t*>(data)[i];
+					break;
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+					index = reinterpret_cast<const uint16_t*>(data)[i];
+					break;
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+					index = reinterpret_cast<const uint32_t*>(data)[i];
+					break;
+
+				default:
+					throw std::runtime_error("Not supported type index");
 				}
+
+				mesh->indices->push_back(index);
 			}
+		}
 
-			if (primitive.material >= 0) {
-				const auto& mat = model.materials[primitive.material];
+		*mesh->meshlets = buildMeshlets(*mesh->vertices, *mesh->indices);
 
-				auto resolveTexture = [&](int texIndex) -> int {
-					if (texIndex < 0) return -1;
-					const auto& tex = model.textures[texIndex];
-					return gltfToImageResourceID[tex.source];
-					};
+		if (primitive.material >= 0) {
+			const auto& mat = model.materials[primitive.material];
 
-				mesh->albedoIndex = resolveTexture(mat.pbrMetallicRoughness.baseColorTexture.index);
-				mesh->roughnessIndex = resolveTexture(mat.pbrMetallicRoughness.metallicRoughnessTexture.index);
-				mesh->normalIndex = resolveTexture(mat.normalTexture.index);
-				mesh->occlusionIndex = resolveTexture(mat.occlusionTexture.index);
-				mesh->emissiveIndex = resolveTexture(mat.emissiveTexture.index);
-			}
+			auto resolveTexture = [&](int texIndex) -> int {
+				if (texIndex < 0) return -1;
+				const auto& tex = model.textures[texIndex];
+				return gltfToImageResourceID[tex.source];
+				};
 
-			meshes.push_back(mesh);
+			mesh->albedoIndex = resolveTexture(mat.pbrMetallicRoughness.baseColorTexture.index);
+			mesh->roughnessIndex = resolveTexture(mat.pbrMetallicRoughness.metallicRoughnessTexture.index);
+			mesh->normalIndex = resolveTexture(mat.normalTexture.index);
+			mesh->occlusionIndex = resolveTexture(mat.occlusionTexture.index);
+			mesh->emissiveIndex = resolveTexture(mat.emissiveTexture.index);
 		}
-	}
+		});
 
 	return meshes;
 }
@@ -306,22 +316,28 @@ void ResourceManager::loadCubeMap(std::shared_ptr<ImageResource> imageResource)
 	if (imageResource->cpuState == UNLOADED) {
 		imageResource->cpuState = LOADING;
 
-		for (size_t i = 0; i < 6; ++i) {
+		//Faces decode in parallel, each job only writes its own layer
+		std::atomic<bool> failed{ false };
+		forEach(6, [&](uint32_t i) {
 			std::string path = imageResource->path + "_" + cubemapFaceNames[i] + ".png";
 
 			int texWidth, texHeight, texChannels;
 			stbi_uc* pixels = stbi_load(path.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
 			if (!pixels) {
-				imageResource->cpuState = ResourceState::FAILED;
+				failed = true;
 				return;
 			}
 
 			imageResource->layers[i].width = texWidth;
 			imageResource->layers[i].height = texHeight;
 			imageResource->layers[i].pixels = pixels;
+			});
 
-			imageResource->cpuState = LOADED;
+		if (failed) {
+			imageResource->cpuState = ResourceState::FAILED;
+			return;
 		}
+		imageResource->cpuState = LOADED;
 	}
 
 	uploadQueue.push(imageResource);
@@ -8,8 +8,10 @@
 #include <queue>
 #include <array>
 #include "../ECS/Component/Component.h"
+#include "../JobSystem/JobSystem.h"
 #include "../../Vulkan/Abstractions/Buffer/VertexBuffer/VertexBuffer.h"
 #include "../../Vulkan/Abstractions/Buffer/IndexBuffer/IndexBuffer.h"
+#include "../../Vulkan/MeshRegistry/Meshlet/Meshlet.h"
 #include <cstring>
 
 
@@ -20,6 +22,8 @@ public:
 	struct MeshResource {
 		std::shared_ptr<Vertices> vertices = std::make_shared<Vertices>();
 		std::shared_ptr<Indices> indices = std::make_shared<Indices>();
+		//Built once the geometry is loaded
+		std::shared_ptr<Meshlets> meshlets = std::make_shared<Meshlets>();
 		
 		uint32_t textureIndex;
 		uint32_t albedoIndex;
@@ -80,7 +84,7 @@ private:
 
 public:
 
-	ResourceManager();
+	ResourceManager(JobSystem* jobSystem = nullptr);
 	std::shared_ptr<ImageResource> createImage(std::string&& path, ResourceType type);
 	std::shared_ptr<MeshResource> loadOBJ(const std::string&& file);
 	std::vector<std::shared_ptr<MeshResource>> loadGLTF(const std::string&& file);
@@ -95,6 +99,19 @@ public:
 
 private:
 
+	//Runs function(i) for every i in [0, count), spread over the job system when there is one
+	template <typename F> void forEach(uint32_t count, F&& function) {
+		if (jobSystem) {
+			jobSystem->parallelFor(count, 1, function);
+			return;
+		}
+		for (uint32_t i = 0; i < count; ++i) {
+			function(i);
+		}
+	}
+
+	JobSystem* jobSystem;
+
 	std::array<std::vector<std::shared_ptr<ImageResource>>, 2> images;
 
 	std::array<uint32_t, 2> idCounters;
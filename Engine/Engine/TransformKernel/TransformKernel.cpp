@@ -0,0 +1,249 @@
+#include "TransformKernel.h"
+#include <algorithm>
+#include <atomic>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define TRANSFORM_KERNEL_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+//MSVC allows AVX intrinsics in any function, gcc and clang need the target enabled per function.
+//Shared helpers are force inlined so they are compiled with the caller's instruction set
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TARGET_AVX2
+#define FORCE_INLINE __forceinline
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define FORCE_INLINE inline __attribute__((always_inline))
+#endif
+
+namespace {
+
+	TransformKernel::PATH detectPath() {
+#ifdef TRANSFORM_KERNEL_X86
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] >= 7) {
+			__cpuid(info, 1);
+			bool osxsave = info[2] & (1 << 27);
+			bool avx = info[2] & (1 << 28);
+
+			__cpuidex(info, 7, 0);
+			bool avx2 = info[1] & (1 << 5);
+
+			//The os has to save the ymm registers on context switches
+			if (osxsave && avx && avx2 && (_xgetbv(0) & 6) == 6) {
+				return TransformKernel::AVX2;
+			}
+		}
+#else
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2")) {
+			return TransformKernel::AVX2;
+		}
+#endif
+		//SSE2 is part of every x64 cpu
+		return TransformKernel::SSE;
+#else
+		return TransformKernel::SCALAR;
+#endif
+	}
+
+	const TransformKernel::PATH supportedPath = detectPath();
+	std::atomic<TransformKernel::PATH> currentPath{ supportedPath };
+
+	void computeScalar(const TransformKernel::Input& in, uint32_t begin, uint32_t end, glm::mat4* models, glm::mat3* normals) {
+		for (uint32_t i = begin; i < end; ++i) {
+			float x = in.rotationX[i], y = in.rotationY[i], z = in.rotationZ[i], w = in.rotationW[i];
+			float sx = in.scaleX[i], sy = in.scaleY[i], sz = in.scaleZ[i];
+
+			glm::vec3 r0{ 1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + w * z), 2.0f * (x * z - w * y) };
+			glm::vec3 r1{ 2.0f * (x * y - w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + w * x) };
+			glm::vec3 r2{ 2.0f * (x * z + w * y), 2.0f * (y * z - w * x), 1.0f - 2.0f * (x * x + y * y) };
+
+			models[i][0] = glm::vec4(r0 * sx, 0.0f);
+			models[i][1] = glm::vec4(r1 * sy, 0.0f);
+			models[i][2] = glm::vec4(r2 * sz, 0.0f);
+			models[i][3] = glm::vec4(in.positionX[i], in.positionY[i], in.positionZ[i], 1.0f);
+
+			//(R * S)^-T = R * S^-1 since R is orthonormal
+			if (normals) {
+				normals[i][0] = r0 / sx;
+				normals[i][1] = r1 / sy;
+				normals[i][2] = r2 / sz;
+			}
+		}
+	}
+
+#ifdef TRANSFORM_KERNEL_X86
+
+	//Registers hold one component of 4 transforms. Transposed they are one column each, written stride floats apart
+	FORCE_INLINE void storeColumns(__m128 x, __m128 y, __m128 z, __m128 w, float* out, size_t stride) {
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+		_mm_storeu_ps(out, x);
+		_mm_storeu_ps(out + stride, y);
+		_mm_storeu_ps(out + stride * 2, z);
+		_mm_storeu_ps(out + stride * 3, w);
+	}
+
+	FORCE_INLINE void store3(float* out, __m128 column) {
+		_mm_storel_pi(reinterpret_cast<__m64*>(out), column);
+		_mm_store_ss(out + 2, _mm_movehl_ps(column, column));
+	}
+
+	//3 float columns, used for the last column of a mat3 so nothing is written past the matrix
+	FORCE_INLINE void storeColumns3(__m128 x, __m128 y, __m128 z, float* out, size_t stride) {
+		__m128 w = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+		store3(out, x);
+		store3(out + stride, y);
+		store3(out + stride * 2, z);
+		store3(out + stride * 3, w);
+	}
+
+	//Columns are computed and stored one at a time, keeping everything in registers.
+	//mat3 columns are 3 floats, so the 4 float stores of the first two columns spill one float
+	//into the next column, which is written right after
+	void computeSSE(const TransformKernel::Input& in, uint32_t count, glm::mat4* models, glm::mat3* normals) {
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 two = _mm_set1_ps(2.0f);
+
+		for (uint32_t i = 0; i + 4 <= count; i += 4) {
+			__m128 x = _mm_loadu_ps(in.rotationX + i), y = _mm_loadu_ps(in.rotationY + i);
+			__m128 z = _mm_loadu_ps(in.rotationZ + i), w = _mm_loadu_ps(in.rotationW + i);
+			__m128 sx = _mm_loadu_ps(in.scaleX + i), sy = _mm_loadu_ps(in.scaleY + i), sz = _mm_loadu_ps(in.scaleZ + i);
+
+			__m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+			__m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+			__m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+			__m128 r00 = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), r01 = _mm_mul_ps(two, _mm_add_ps(xy, wz)), r02 = _mm_mul_ps(two, _mm_sub_ps(xz, wy));
+			__m128 r10 = _mm_mul_ps(two, _mm_sub_ps(xy, wz)), r11 = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), r12 = _mm_mul_ps(two, _mm_add_ps(yz, wx));
+			__m128 r20 = _mm_mul_ps(two, _mm_add_ps(xz, wy)), r21 = _mm_mul_ps(two, _mm_sub_ps(yz, wx)), r22 = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)));
+
+			float* model = &models[i][0][0];
+			storeColumns(_mm_mul_ps(r00, sx), _mm_mul_ps(r01, sx), _mm_mul_ps(r02, sx), zero, model, 16);
+			storeColumns(_mm_mul_ps(r10, sy), _mm_mul_ps(r11, sy), _mm_mul_ps(r12, sy), zero, model + 4, 16);
+			storeColumns(_mm_mul_ps(r20, sz), _mm_mul_ps(r21, sz), _mm_mul_ps(r22, sz), zero, model + 8, 16);
+			storeColumns(_mm_loadu_ps(in.positionX + i), _mm_loadu_ps(in.positionY + i), _mm_loadu_ps(in.positionZ + i), one, model + 12, 16);
+
+			if (!normals) continue;
+
+			__m128 ix = _mm_div_ps(one, sx), iy = _mm_div_ps(one, sy), iz = _mm_div_ps(one, sz);
+			float* normal = &normals[i][0][0];
+			storeColumns(_mm_mul_ps(r00, ix), _mm_mul_ps(r01, ix), _mm_mul_ps(r02, ix), zero, normal, 9);
+			storeColumns(_mm_mul_ps(r10, iy), _mm_mul_ps(r11, iy), _mm_mul_ps(r12, iy), zero, normal + 3, 9);
+			storeColumns3(_mm_mul_ps(r20, iz), _mm_mul_ps(r21, iz), _mm_mul_ps(r22, iz), normal + 6, 9);
+		}
+
+		computeScalar(in, count & ~3u, count, models, normals);
+	}
+
+	//Same as storeColumns for 8 transforms. The shuffles stay inside 128 bit lanes, so the low half
+	//of each result is a column of transform n and the high half the same column of transform n + 4
+	TARGET_AVX2 FORCE_INLINE void storeColumns8(__m256 x, __m256 y, __m256 z, __m256 w, float* out, size_t stride) {
+		__m256 xy0 = _mm256_unpacklo_ps(x, y), xy1 = _mm256_unpackhi_ps(x, y);
+		__m256 zw0 = _mm256_unpacklo_ps(z, w), zw1 = _mm256_unpackhi_ps(z, w);
+		__m256 columns[4] = {
+			_mm256_shuffle_ps(xy0, zw0, _MM_SHUFFLE(1, 0, 1, 0)),
+			_mm256_shuffle_ps(xy0, zw0, _MM_SHUFFLE(3, 2, 3, 2)),
+			_mm256_shuffle_ps(xy1, zw1, _MM_SHUFFLE(1, 0, 1, 0)),
+			_mm256_shuffle_ps(xy1, zw1, _MM_SHUFFLE(3, 2, 3, 2))
+		};
+		for (uint32_t lane = 0; lane < 4; ++lane) {
+			_mm_storeu_ps(out + stride * lane, _mm256_castps256_ps128(columns[lane]));
+			_mm_storeu_ps(out + stride * (lane + 4), _mm256_extractf128_ps(columns[lane], 1));
+		}
+	}
+
+	//Same as storeColumns3 for 8 transforms
+	TARGET_AVX2 FORCE_INLINE void storeColumns8x3(__m256 x, __m256 y, __m256 z, float* out, size_t stride) {
+		__m256 xy0 = _mm256_unpacklo_ps(x, y), xy1 = _mm256_unpackhi_ps(x, y);
+		__m256 zw0 = _mm256_unpacklo_ps(z, z), zw1 = _mm256_unpackhi_ps(z, z);
+		__m256 columns[4] = {
+			_mm256_shuffle_ps(xy0, zw0, _MM_SHUFFLE(1, 0, 1, 0)),
+			_mm256_shuffle_ps(xy0, zw0, _MM_SHUFFLE(3, 2, 3, 2)),
+			_mm256_shuffle_ps(xy1, zw1, _MM_SHUFFLE(1, 0, 1, 0)),
+			_mm256_shuffle_ps(xy1, zw1, _MM_SHUFFLE(3, 2, 3, 2))
+		};
+		for (uint32_t lane = 0; lane < 4; ++lane) {
+			store3(out + stride * lane, _mm256_castps256_ps128(columns[lane]));
+			store3(out + stride * (lane + 4), _mm256_extractf128_ps(columns[lane], 1));
+		}
+	}
+
+	TARGET_AVX2 void computeAVX2(const TransformKernel::Input& in, uint32_t count, glm::mat4* models, glm::mat3* normals) {
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 two = _mm256_set1_ps(2.0f);
+
+		for (uint32_t i = 0; i + 8 <= count; i += 8) {
+			__m256 x = _mm256_loadu_ps(in.rotationX + i), y = _mm256_loadu_ps(in.rotationY + i);
+			__m256 z = _mm256_loadu_ps(in.rotationZ + i), w = _mm256_loadu_ps(in.rotationW + i);
+			__m256 sx = _mm256_loadu_ps(in.scaleX + i), sy = _mm256_loadu_ps(in.scaleY + i), sz = _mm256_loadu_ps(in.scaleZ + i);
+
+			__m256 xx = _mm256_mul_ps(x, x), yy = _mm256_mul_ps(y, y), zz = _mm256_mul_ps(z, z);
+			__m256 xy = _mm256_mul_ps(x, y), xz = _mm256_mul_ps(x, z), yz = _mm256_mul_ps(y, z);
+			__m256 wx = _mm256_mul_ps(w, x), wy = _mm256_mul_ps(w, y), wz = _mm256_mul_ps(w, z);
+
+			__m256 r00 = _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(yy, zz))), r01 = _mm256_mul_ps(two, _mm256_add_ps(xy, wz)), r02 = _mm256_mul_ps(two, _mm256_sub_ps(xz, wy));
+			__m256 r10 = _mm256_mul_ps(two, _mm256_sub_ps(xy, wz)), r11 = _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, zz))), r12 = _mm256_mul_ps(two, _mm256_add_ps(yz, wx));
+			__m256 r20 = _mm256_mul_ps(two, _mm256_add_ps(xz, wy)), r21 = _mm256_mul_ps(two, _mm256_sub_ps(yz, wx)), r22 = _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, yy)));
+
+			float* model = &models[i][0][0];
+			storeColumns8(_mm256_mul_ps(r00, sx), _mm256_mul_ps(r01, sx), _mm256_mul_ps(r02, sx), zero, model, 16);
+			storeColumns8(_mm256_mul_ps(r10, sy), _mm256_mul_ps(r11, sy), _mm256_mul_ps(r12, sy), zero, model + 4, 16);
+			storeColumns8(_mm256_mul_ps(r20, sz), _mm256_mul_ps(r21, sz), _mm256_mul_ps(r22, sz), zero, model + 8, 16);
+			storeColumns8(_mm256_loadu_ps(in.positionX + i), _mm256_loadu_ps(in.positionY + i), _mm256_loadu_ps(in.positionZ + i), one, model + 12, 16);
+
+			if (!normals) continue;
+
+			__m256 ix = _mm256_div_ps(one, sx), iy = _mm256_div_ps(one, sy), iz = _mm256_div_ps(one, sz);
+			float* normal = &normals[i][0][0];
+			storeColumns8(_mm256_mul_ps(r00, ix), _mm256_mul_ps(r01, ix), _mm256_mul_ps(r02, ix), zero, normal, 9);
+			storeColumns8(_mm256_mul_ps(r10, iy), _mm256_mul_ps(r11, iy), _mm256_mul_ps(r12, iy), zero, normal + 3, 9);
+			storeColumns8x3(_mm256_mul_ps(r20, iz), _mm256_mul_ps(r21, iz), _mm256_mul_ps(r22, iz), normal + 6, 9);
+		}
+
+		computeScalar(in, count & ~7u, count, models, normals);
+	}
+
+#endif
+}
+
+void TransformKernel::compute(const Input& input, uint32_t count, glm::mat4* models, glm::mat3* normals)
+{
+	switch (currentPath.load(std::memory_order_relaxed)) {
+#ifdef TRANSFORM_KERNEL_X86
+	case AVX2:
+		computeAVX2(input, count, models, normals);
+		break;
+	case SSE:
+		computeSSE(input, count, models, normals);
+		break;
+#endif
+	default:
+		computeScalar(input, 0, count, models, normals);
+		break;
+	}
+}
+
+TransformKernel::PATH TransformKernel::getPath()
+{
+	return currentPath.load();
+}
+
+TransformKernel::PATH TransformKernel::getSupportedPath()
+{
+	return supportedPath;
+}
+
+void TransformKernel::setPath(PATH path)
+{
+	currentPath.store(std::min(path, supportedPath));
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <glm/glm.hpp>
+
+
+//Batched position/rotation/scale to matrix conversion. Inputs are structure of arrays so 4 (SSE)
+//or 8 (AVX2) transforms are computed per instruction, the widest path the cpu supports is picked at runtime
+class TransformKernel
+{
+public:
+
+	enum PATH : uint32_t {
+		SCALAR,
+		SSE,
+		AVX2
+	};
+
+	//Every pointer holds count floats, rotation is a unit quaternion
+	struct Input {
+		const float* positionX;
+		const float* positionY;
+		const float* positionZ;
+		const float* rotationX;
+		const float* rotationY;
+		const float* rotationZ;
+		const float* rotationW;
+		const float* scaleX;
+		const float* scaleY;
+		const float* scaleZ;
+	};
+
+	//models[i] = translate * rotate * scale, normals[i] = inverse transpose of its upper 3x3 (may be nullptr)
+	static void compute(const Input& input, uint32_t count, glm::mat4* models, glm::mat3* normals);
+
+	static PATH getPath();
+	static PATH getSupportedPath();
+
+	//Forces a narrower path, used to validate and benchmark the paths against each other
+	static void setPath(PATH path);
+};
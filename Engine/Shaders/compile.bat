@@ -10,13 +10,13 @@ C:\VulkanSDK\1.3.280.0\Bin\glslc.exe lighting.frag -o lighting.frag.spv
 C:\VulkanSDK\1.3.280.0\Bin\glslc.exe skybox.vert -o skybox.vert.spv
 C:\VulkanSDK\1.3.280.0\Bin\glslc.exe skybox.frag -o skybox.frag.spv
 
-C:\VulkanSDK\1.3.280.0\Bin\glslc.exe irradiance.vert -o irradiance.vert.spv
-C:\VulkanSDK\1.3.280.0\Bin\glslc.exe irradiance.frag -o irradiance.frag.spv
+C:\VulkanSDK\1.3.280.0\Bin\glslc.exe irradiance.comp -o irradiance.comp.spv
+C:\VulkanSDK\1.3.280.0\Bin\glslc.exe prefilter.comp -o prefilter.comp.spv
+C:\VulkanSDK\1.3.280.0\Bin\glslc.exe brdfLUT.comp -o brdfLUT.comp.spv
 
-C:\VulkanSDK\1.3.280.0\Bin\glslc.exe prefilter.vert -o prefilter.vert.spv
-C:\VulkanSDK\1.3.280.0\Bin\glslc.exe prefilter.frag -o prefilter.frag.spv
-
-C:\VulkanSDK\1.3.280.0\Bin\glslc.exe brdfLUT.vert -o brdfLUT.vert.spv
-C:\VulkanSDK\1.3.280.0\Bin\glslc.exe brdfLUT.frag -o brdfLUT.frag.spv
+C:\VulkanSDK\1.3.280.0\Bin\glslc.exe cull.comp -o cull.comp.spv
+C:\VulkanSDK\1.3.280.0\Bin\glslc.exe meshletCull.comp -o meshletCull.comp.spv
+C:\VulkanSDK\1.3.280.0\Bin\glslc.exe drawBatch.comp -o drawBatch.comp.spv
+C:\VulkanSDK\1.3.280.0\Bin\glslc.exe hiZ.comp -o hiZ.comp.spv
 
 pause
\ No newline at end of file
@@ -0,0 +1,156 @@
+//Shared by the culling shaders, every one of them uses the same pipeline layout
+
+//set 0 - Global
+//set 1 - Culling
+
+layout(set = 0, binding = 0) uniform GlobalUBO {
+    mat4 view;
+    mat4 projection;
+    vec4 camPos;
+} globalUbo;
+
+struct ObjectSSBO {
+    mat4 model;
+    mat3 normalMatrix;
+    uint albedoIndex;
+    uint roughnessIndex;
+    uint normalIndex;
+    uint occlusionIndex;
+    uint emissiveIndex;
+    uint batchIndex;
+    uint _pad0;
+    uint _pad1;
+};
+
+//Objects are split over pages so no storage range passes the device limit, matches DescriptorManager::OBJECT_PAGES
+const uint OBJECT_PAGES = 4u;
+const uint OBJECT_PAGE_SHIFT = 19u;
+const uint OBJECT_PAGE_MASK = (1u << OBJECT_PAGE_SHIFT) - 1u;
+
+layout(set = 0, binding = 1) readonly buffer ObjectBuffer {
+    ObjectSSBO objectSSBOs[];
+} objectPages[OBJECT_PAGES];
+
+#define OBJECT(index) objectPages[nonuniformEXT((index) >> OBJECT_PAGE_SHIFT)].objectSSBOs[(index) & OBJECT_PAGE_MASK]
+
+struct MeshData {
+    uint indexCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstMeshlet;
+    vec4 bounds;
+    uint meshletCount;
+    uint _pad0;
+    uint _pad1;
+    uint _pad2;
+};
+
+struct DrawBatch {
+    uint meshId;
+    uint firstInstance;
+    uint instanceCount;
+};
+
+struct Meshlet {
+    vec4 bounds;
+    vec4 cone;
+    uint firstIndex;
+    uint triangleCount;
+    uint _pad0;
+    uint _pad1;
+};
+
+struct DrawCommand {
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstInstance;
+};
+
+//Indirect dispatch of the meshlet pass, one workgroup per visible object up to the smallest limit every device has.
+//The pass loops over the rest
+struct MeshletDispatch {
+    uint groupCountX;
+    uint groupCountY;
+    uint groupCountZ;
+    uint visibleCount;
+    uint indexCount;
+};
+
+const uint MAX_DISPATCH_GROUPS = 65535u;
+
+//Farthest depth of the early pass, every level halves the one above
+layout(set = 1, binding = 7) uniform sampler2D hiZImage;
+
+const uint PHASE_EARLY = 0u;
+const uint PHASE_LATE = 1u;
+
+//World space frustum planes, xyz normal pointing inwards and w distance
+layout(push_constant) uniform Push {
+    vec4 planes[6];
+    uint objectCount;
+    uint meshCount;
+    uint batchCount;
+    uint phase;
+} push;
+
+
+//Local bounding sphere to world space, the radius grows with the largest axis scale
+vec4 toWorldSphere(mat4 model, vec4 bounds) {
+    vec3 center = (model * vec4(bounds.xyz, 1.0)).xyz;
+    float scale = max(max(length(model[0].xyz), length(model[1].xyz)), length(model[2].xyz));
+    return vec4(center, bounds.w * scale);
+}
+
+bool isOutsideFrustum(vec4 sphere) {
+    for (int i = 0; i < 6; ++i) {
+        if (dot(push.planes[i].xyz, sphere.xyz) + push.planes[i].w < -sphere.w) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//Screen rectangle and nearest depth of the sphere's bounding box against the hi-z pyramid.
+//Anything reaching behind the camera is treated as visible
+bool isOccluded(vec4 sphere) {
+    mat4 viewProjection = globalUbo.projection * globalUbo.view;
+
+    vec2 minUV = vec2(1.0);
+    vec2 maxUV = vec2(0.0);
+    float nearestDepth = 1.0;
+
+    for (int i = 0; i < 8; ++i) {
+        vec3 corner = sphere.xyz + sphere.w * vec3((i & 1) == 0 ? -1.0 : 1.0, (i & 2) == 0 ? -1.0 : 1.0, (i & 4) == 0 ? -1.0 : 1.0);
+        vec4 clip = viewProjection * vec4(corner, 1.0);
+        if (clip.w <= 0.0) {
+            return false;
+        }
+
+        vec3 ndc = clip.xyz / clip.w;
+        vec2 uv = ndc.xy * 0.5 + 0.5;
+        minUV = min(minUV, uv);
+        maxUV = max(maxUV, uv);
+        nearestDepth = min(nearestDepth, ndc.z);
+    }
+
+    ivec2 size = textureSize(hiZImage, 0);
+    ivec2 minTexel = clamp(ivec2(floor(clamp(minUV, 0.0, 1.0) * vec2(size))), ivec2(0), size - 1);
+    ivec2 maxTexel = clamp(ivec2(floor(clamp(maxUV, 0.0, 1.0) * vec2(size))), ivec2(0), size - 1);
+
+    //Lowest level where the rectangle covers at most 2x2 texels
+    int span = max(maxTexel.x - minTexel.x, maxTexel.y - minTexel.y);
+    int level = span > 1 ? findMSB(span - 1) + 1 : 0;
+    level = min(level, textureQueryLevels(hiZImage) - 1);
+
+    ivec2 levelSize = textureSize(hiZImage, level);
+    ivec2 levelMin = min(minTexel >> level, levelSize - 1);
+    ivec2 levelMax = min(maxTexel >> level, levelSize - 1);
+
+    float farthestDepth = max(
+        max(texelFetch(hiZImage, levelMin, level).r, texelFetch(hiZImage, ivec2(levelMax.x, levelMin.y), level).r),
+        max(texelFetch(hiZImage, ivec2(levelMin.x, levelMax.y), level).r, texelFetch(hiZImage, levelMax, level).r));
+
+    return nearestDepth > farthestDepth;
+}
@@ -6,6 +6,7 @@ layout(location = 1) in vec3 fragPosWorld;
 layout(location = 2) in vec3 fragNormal;
 layout(location = 3) in vec4 fragTangent;
 layout(location = 4) in vec2 fragUV;
+layout(location = 5) flat in uint fragObjectIndex;
 
 layout(location = 0) out vec4 outAlbedo;
 layout(location = 1) out vec4 outNormal;
@@ -24,30 +25,34 @@ layout(set = 0, binding = 0) uniform GlobalUBO {
 
 struct ObjectSSBO {
     mat4 model;
+    mat3 normalMatrix;
     uint albedoIndex;
     uint roughnessIndex;
     uint normalIndex;
     uint occlusionIndex;
     uint emissiveIndex;
+    uint batchIndex;
     uint _pad0;
     uint _pad1;
-    uint _pad2;
 };
 
+//Objects are split over pages so no storage range passes the device limit, matches DescriptorManager::OBJECT_PAGES
+const uint OBJECT_PAGES = 4u;
+const uint OBJECT_PAGE_SHIFT = 19u;
+const uint OBJECT_PAGE_MASK = (1u << OBJECT_PAGE_SHIFT) - 1u;
+
 layout(set = 0, binding = 1) buffer ObjectBuffer {
     ObjectSSBO objectSSBOs[];
-};
+} objectPages[OBJECT_PAGES];
 
-layout(set = 1, binding = 0) uniform sampler2D textures[];
+#define OBJECT(index) objectPages[nonuniformEXT((index) >> OBJECT_PAGE_SHIFT)].objectSSBOs[(index) & OBJECT_PAGE_MASK]
 
-layout(push_constant) uniform Push {
-    uint uboIndex;
-} push;
+layout(set = 1, binding = 0) uniform sampler2D textures[];
 
 
 
 void main() {
-    ObjectSSBO object = objectSSBOs[nonuniformEXT(push.uboIndex)];
+    ObjectSSBO object = OBJECT(fragObjectIndex);
 
     outAlbedo = vec4(texture(textures[nonuniformEXT(object.albedoIndex)], fragUV));
 
@@ -13,9 +13,11 @@ layout(location = 1) out vec3 fragPosWorld;
 layout(location = 2) out vec3 fragNormal;
 layout(location = 3) out vec4 fragTangent;
 layout(location = 4) out vec2 fragUV;
+layout(location = 5) flat out uint fragObjectIndex;
 
 //set 0 - Global
 //set 1 - Resources
+//set 2 - Culling
 
 layout(set = 0, binding = 0) uniform GlobalUBO {
     mat4 view;
@@ -25,30 +27,40 @@ layout(set = 0, binding = 0) uniform GlobalUBO {
 
 struct ObjectSSBO {
     mat4 model;
+    mat3 normalMatrix;
     uint albedoIndex;
     uint roughnessIndex;
     uint normalIndex;
     uint occlusionIndex;
     uint emissiveIndex;
+    uint batchIndex;
     uint _pad0;
     uint _pad1;
-    uint _pad2;
 };
 
+//Objects are split over pages so no storage range passes the device limit, matches DescriptorManager::OBJECT_PAGES
+const uint OBJECT_PAGES = 4u;
+const uint OBJECT_PAGE_SHIFT = 19u;
+const uint OBJECT_PAGE_MASK = (1u << OBJECT_PAGE_SHIFT) - 1u;
+
 layout(set = 0, binding = 1) buffer ObjectBuffer {
     ObjectSSBO objectSSBOs[];
-};
+} objectPages[OBJECT_PAGES];
+
+#define OBJECT(index) objectPages[nonuniformEXT((index) >> OBJECT_PAGE_SHIFT)].objectSSBOs[(index) & OBJECT_PAGE_MASK]
 
 layout(set = 1, binding = 0) uniform sampler2D textures[];
 
-layout(push_constant) uniform Push {
-    uint uboIndex;
-} push;
+//Object index of every instance, each draw's first instance points at its batch's range
+layout(set = 2, binding = 5) readonly buffer InstanceBuffer {
+    uint instances[];
+};
 
 
 void main() {
 
-    mat4 model = objectSSBOs[nonuniformEXT(push.uboIndex)].model;
+    uint objectIndex = instances[gl_InstanceIndex];
+    mat4 model = OBJECT(objectIndex).model;
     mat4 view = globalUbo.view;
     mat4 projection = globalUbo.projection;
 
@@ -57,7 +69,7 @@ void main() {
     vec4 positionWorld = model * vec4(inPosition, 1.0);
     gl_Position = projection * view * positionWorld;
     
-    mat3 trans = mat3(transpose(inverse(model)));
+    mat3 trans = OBJECT(objectIndex).normalMatrix;
     fragNormal = normalize(trans * inNormal);
     fragTangent = vec4(normalize(trans * inTangent.xyz), inTangent.w);
 
@@ -65,5 +77,6 @@ void main() {
 
     fragColor = inColor;
     fragUV = inUV;
+    fragObjectIndex = objectIndex;
     
 }
\ No newline at end of file
@@ -1,20 +1,46 @@
-#version 450
-#extension GL_EXT_nonuniform_qualifier : require
+//Shared by the ibl shaders, every one of them uses the same pipeline layout
 
-layout(set = 0, binding = 1) uniform samplerCube skyboxSamplers[];
+//set 0 - IBL target
+
+layout(set = 0, binding = 0) uniform samplerCube skyboxSampler;
 
 layout(push_constant) uniform Push {
     uint faceIndex;
     uint mipLevel;
 } push;
 
-layout(location = 0) in vec3 fragDir;
-layout(location = 0) out vec4 outColor;
-
-
 const float PI = 3.14159265359;
 const uint SAMPLE_COUNT = 1024;
 
+const vec3 faceForward[6] = vec3[](
+    vec3(1.0, 0.0, 0.0),
+    vec3(-1.0, 0.0, 0.0),
+    vec3(0.0, 1.0, 0.0),
+    vec3(0.0, -1.0, 0.0),
+    vec3(0.0, 0.0, 1.0),
+    vec3(0.0, 0.0, -1.0)
+);
+
+const vec3 faceUp[6] = vec3[](
+    -vec3(0.0, 1.0, 0.0),
+    -vec3(0.0, 1.0, 0.0),
+    -vec3(0.0, 0.0, -1.0),
+    -vec3(0.0, 0.0, 1.0),
+    -vec3(0.0, 1.0, 0.0),
+    -vec3(0.0, 1.0, 0.0)
+);
+
+//Direction through the center of a texel of a cube face, the same the face's full screen quad interpolated
+vec3 getCubeDirection(uint face, ivec2 texel, int size) {
+    vec2 position = (vec2(texel) + 0.5) / float(size) * 2.0 - 1.0;
+
+    vec3 forward = faceForward[face];
+    vec3 up = faceUp[face];
+    vec3 right = normalize(cross(forward, up));
+
+    return normalize(forward + position.x * right + position.y * up);
+}
+
 float RadicalInverse_VdC(uint bits) {
     bits = (bits << 16u) | (bits >> 16u);
     bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
@@ -46,25 +72,3 @@ vec3 ImportanceSampleGGX(vec2 Xi, vec3 N, float roughness) {
 
     return normalize(tangent * H.x + bitangent * H.y + N * H.z);
 }
-
-void main() {
-    vec3 N = normalize(fragDir);
-    float roughness = float(push.mipLevel) / float(4.0);
-    vec3 prefilteredColor = vec3(0.0);
-    float totalWeight = 0.0;
-
-    for (uint i = 0u; i < SAMPLE_COUNT; ++i) {
-        vec2 Xi = Hammersley(i, SAMPLE_COUNT);
-        vec3 H = ImportanceSampleGGX(Xi, N, roughness);
-        vec3 L = normalize(2.0 * dot(N,H) * H - N);
-
-        float NdotL = max(dot(N,L), 0.0);
-        if (NdotL > 0.0) {
-            prefilteredColor += texture(skyboxSamplers[0], L).rgb * NdotL;
-            totalWeight += NdotL;
-        }
-    }
-
-    prefilteredColor = prefilteredColor / totalWeight;
-    outColor = vec4(prefilteredColor, 1.0);
-}
\ No newline at end of file
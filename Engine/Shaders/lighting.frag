@@ -20,20 +20,26 @@ layout(set = 0, binding = 0) uniform GlobalUBO {
 
 struct ObjectSSBO {
     mat4 model;
+    mat3 normalMatrix;
     uint albedoIndex;
     uint roughnessIndex;
     uint normalIndex;
     uint occlusionIndex;
     uint emissiveIndex;
+    uint batchIndex;
     uint _pad0;
     uint _pad1;
-    uint _pad2;
 };
 
 //readonly??
+//Objects are split over pages so no storage range passes the device limit, matches DescriptorManager::OBJECT_PAGES
+const uint OBJECT_PAGES = 4u;
+const uint OBJECT_PAGE_SHIFT = 19u;
+const uint OBJECT_PAGE_MASK = (1u << OBJECT_PAGE_SHIFT) - 1u;
+
 layout(set = 0, binding = 1) buffer ObjectBuffer {
     ObjectSSBO objectSSBOs[];
-};
+} objectPages[OBJECT_PAGES];
 
 struct LightSSBO {
     vec4 type;
@@ -59,6 +65,9 @@ layout(set = 2, binding = 8) uniform sampler2D positionImage;
 
 layout(push_constant) uniform Push {
     uint uboIndex;
+    uint skyboxIndex;
+    //0 until the ibl maps were computed, their bindings are not written before
+    uint isEnvironmentReady;
 } push;
 
 const float PI = 3.141595359;
@@ -276,21 +285,23 @@ void main() {
         //color += calculatePBR(normal, V, fragPos, albedo, metallic, roughness, light);
     }
 
-    vec3 F0 = mix(vec3(0.04), albedo, metallic);
-    vec3 F = FresnelSchlickRoughness(max(dot(normal, V), 0.0), F0, roughness);
+    if (push.isEnvironmentReady != 0u) {
+        vec3 F0 = mix(vec3(0.04), albedo, metallic);
+        vec3 F = FresnelSchlickRoughness(max(dot(normal, V), 0.0), F0, roughness);
 
-    vec3 irradiance = texture(irradianceCubeMap, normal).rgb;
-    vec3 diffuseIBL = irradiance * albedo;
+        vec3 irradiance = texture(irradianceCubeMap, normal).rgb;
+        vec3 diffuseIBL = irradiance * albedo;
 
-    vec3 kD = (1.0 - F) * (1.0 - metallic);
-    diffuseIBL *= kD;
+        vec3 kD = (1.0 - F) * (1.0 - metallic);
+        diffuseIBL *= kD;
 
-    vec3 R = reflect(-V, normal);
-    vec3 prefilteredColor = textureLod(prefilterCubeMap, R, roughness * 4).rgb;
-    vec2 brdf = texture(brdfLUTMap, vec2(max(dot(normal, V), 0.0), roughness)).rg;
-    vec3 specularIBL = prefilteredColor * (F * brdf.x + brdf.y);
+        vec3 R = reflect(-V, normal);
+        vec3 prefilteredColor = textureLod(prefilterCubeMap, R, roughness * 4).rgb;
+        vec2 brdf = texture(brdfLUTMap, vec2(max(dot(normal, V), 0.0), roughness)).rg;
+        vec3 specularIBL = prefilteredColor * (F * brdf.x + brdf.y);
 
-    color += diffuseIBL + specularIBL;
+        color += diffuseIBL + specularIBL;
+    }
 
 
     
@@ -35,19 +35,25 @@ layout(set = 0, binding = 0) uniform GlobalUBO {
 
 struct ObjectSSBO {
     mat4 model;
+    mat3 normalMatrix;
     uint albedoIndex;
     uint roughnessIndex;
     uint normalIndex;
     uint occlusionIndex;
     uint emissiveIndex;
-	uint _pad0;
+	uint batchIndex;
+    uint _pad0;
     uint _pad1;
-    uint _pad2;
 };
 
+//Objects are split over pages so no storage range passes the device limit, matches DescriptorManager::OBJECT_PAGES
+const uint OBJECT_PAGES = 4u;
+const uint OBJECT_PAGE_SHIFT = 19u;
+const uint OBJECT_PAGE_MASK = (1u << OBJECT_PAGE_SHIFT) - 1u;
+
 layout(set = 0, binding = 1) buffer ObjectBuffer {
     ObjectSSBO objectSSBOs[];
-};
+} objectPages[OBJECT_PAGES];
 
 
 layout(set = 2, binding = 0) uniform sampler2D albedoImage;
@@ -38,14 +38,12 @@ void Buffer::destroyBuffer()
 void* Buffer::map()
 {
 	if (!isMapped) {
-		void* data;
-		if (vmaMapMemory(vulkanResources.allocator, allocation, &data) != VK_SUCCESS) {
+		if (vmaMapMemory(vulkanResources.allocator, allocation, &mappedPointer) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to map buffer");
 		}
 		isMapped = true;
-		return data;
 	}
-	return nullptr;
+	return mappedPointer;
 }
 
 void Buffer::unmap()
@@ -53,11 +51,19 @@ void Buffer::unmap()
 	if (isMapped) {
 		vmaUnmapMemory(vulkanResources.allocator, allocation);
 		isMapped = false;
+		mappedPointer = nullptr;
 	}
 }
 
 void Buffer::copy(VkDeviceSize size, void* data, VkDeviceSize offset)
 {
+	//Buffers that are already mapped (or were created mapped) are written directly
+	void* mapped = isMapped ? mappedPointer : allocateInfo.pMappedData;
+	if (mapped) {
+		std::memcpy(static_cast<char*>(mapped) + offset, data, size);
+		return;
+	}
+
 	void* dst = nullptr;
 	if (vmaMapMemory(vulkanResources.allocator, allocation, &dst) != VK_SUCCESS) {
 		throw std::runtime_error("Failed to map buffer for data copy");
@@ -8,8 +8,8 @@ class Buffer
 public:
 	friend class VulkanApp;
 	friend class Renderer;
-	friend class VertexBuffer;
-	friend class IndexBuffer;
+	friend class MeshRegistry;
+	friend class UploadEngine;
 
 	Buffer(VulkanResources& vulkanResources);
 	void initBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VmaMemoryUsage memoryUsage, VmaAllocationCreateFlags flags = 0, VkSharingMode sharingMode = VK_SHARING_MODE_EXCLUSIVE);
@@ -25,6 +25,7 @@ protected:
 	VmaAllocation allocation = nullptr;
 	VmaAllocationInfo allocateInfo;
 	bool isMapped = false;
+	void* mappedPointer = nullptr;
 
 	VulkanResources& vulkanResources;
 };
@@ -1,31 +1,5 @@
 #pragma once
 #include "../../../Helper/Helper.h"
 
-#include "../Buffer.h"
-#include "../../../Abstractions/CommandBuffer/CommandBuffer.h"
-
+//Geometry lives in the mesh registry's index pool, indices are local to their mesh
 using Indices = std::vector<uint32_t>;
-
-class IndexBuffer : protected Buffer
-{
-public:
-
-	friend class Renderer;
-
-	IndexBuffer(VulkanResources& vulkanResources);
-	void initIndexBuffer(std::shared_ptr<Indices> indices, VkQueue transferQueue, VkCommandPool commandPool);
-	void bind(VkCommandBuffer commandBuffer);
-	void destroyIndexBuffer();
-	~IndexBuffer();
-
-
-	uint32_t indexCount;
-
-private:
-	void uploadThroughStaging(void* data, VkDeviceSize size, VkQueue transferQueue, VkCommandPool commandPool);
-
-private:
-	VulkanResources& vulkanResources;
-
-};
-
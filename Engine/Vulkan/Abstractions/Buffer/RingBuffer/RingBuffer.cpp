@@ -0,0 +1,69 @@
+#include "RingBuffer.h"
+
+RingBuffer::RingBuffer(VulkanResources& vulkanResources) : Buffer{ vulkanResources }, vulkanResources{ vulkanResources }
+{
+
+}
+
+void RingBuffer::initRingBuffer(VkDeviceSize frameSize, uint32_t frameCount, VkBufferUsageFlags usage)
+{
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(vulkanResources.physicalDevice, &properties);
+
+	//Dynamic offsets have to honour the alignment of every descriptor type the buffer is used with
+	alignment = 1;
+	if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT) {
+		alignment = std::max(alignment, properties.limits.minUniformBufferOffsetAlignment);
+	}
+	if (usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT) {
+		alignment = std::max(alignment, properties.limits.minStorageBufferOffsetAlignment);
+	}
+
+	this->frameSize = (frameSize + alignment - 1) & ~(alignment - 1);
+
+	Buffer::initBuffer(this->frameSize * frameCount, usage, VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+		VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT);
+	mappedData = static_cast<char*>(Buffer::allocateInfo.pMappedData);
+
+	VkMemoryPropertyFlags memoryProperties = 0;
+	vmaGetAllocationMemoryProperties(vulkanResources.allocator, Buffer::allocation, &memoryProperties);
+	isCoherent = (memoryProperties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+
+	frameBegin = 0;
+	head = 0;
+}
+
+void RingBuffer::beginFrame(uint32_t frame)
+{
+	frameBegin = frameSize * frame;
+	head = frameBegin;
+}
+
+RingBuffer::Allocation RingBuffer::allocate(VkDeviceSize size)
+{
+	VkDeviceSize offset = (head + alignment - 1) & ~(alignment - 1);
+	if (offset + size > frameBegin + frameSize) {
+		throw std::runtime_error("Ring buffer frame region is full");
+	}
+	head = offset + size;
+
+	return { mappedData + offset, static_cast<uint32_t>(offset) };
+}
+
+void RingBuffer::flush()
+{
+	if (!isCoherent && head > frameBegin) {
+		vmaFlushAllocation(vulkanResources.allocator, Buffer::allocation, frameBegin, head - frameBegin);
+	}
+}
+
+void RingBuffer::destroyRingBuffer()
+{
+	Buffer::destroyBuffer();
+	mappedData = nullptr;
+}
+
+RingBuffer::~RingBuffer()
+{
+	destroyRingBuffer();
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "../../../Helper/Helper.h"
+
+#include "../Buffer.h"
+
+
+//Persistently mapped buffer with one region per frame in flight. Every frame allocates linearly from its own
+//region and writes straight into the mapping, shaders reach the allocations through dynamic offsets.
+//Prefers device local + host visible memory when the device has it
+class RingBuffer : protected Buffer
+{
+public:
+	friend class Renderer;
+
+	struct Allocation {
+		void* data = nullptr;
+		uint32_t offset = 0;
+	};
+
+	RingBuffer(VulkanResources& vulkanResources);
+	void initRingBuffer(VkDeviceSize frameSize, uint32_t frameCount, VkBufferUsageFlags usage);
+
+	//Starts allocating from the region of frame. Only call once that frame's previous submit has finished
+	void beginFrame(uint32_t frame);
+	Allocation allocate(VkDeviceSize size);
+
+	//Makes this frame's writes visible to the gpu, only does work on non coherent memory
+	void flush();
+
+	void destroyRingBuffer();
+	~RingBuffer();
+
+	VkDeviceSize getFrameSize() const {
+		return frameSize;
+	}
+
+private:
+	VulkanResources& vulkanResources;
+	char* mappedData = nullptr;
+	bool isCoherent = true;
+
+	VkDeviceSize frameSize = 0;
+	VkDeviceSize alignment = 1;
+	VkDeviceSize frameBegin = 0;
+	VkDeviceSize head = 0;
+};
@@ -1,10 +1,8 @@
 #pragma once
 #include "../../../Helper/Helper.h"
 
-#include "../Buffer.h"
-#include "../../../Abstractions/CommandBuffer/CommandBuffer.h"
-
 
+//Geometry lives in the mesh registry's vertex pool, this is its layout
 struct Vertex {
 	glm::vec3 pos;
 	glm::vec3 color;
@@ -15,24 +13,7 @@ struct Vertex {
 	bool operator==(const Vertex& other) const {
 		return pos == other.pos && color == other.color && normal == other.normal && tangent == other.tangent && uv == other.uv;
 	}
-};
-
-using Vertices = std::vector<Vertex>;
-
-class VertexBuffer : protected Buffer
-{
-public:
-	friend class Renderer;
-
-	VertexBuffer(VulkanResources& vulkanResources);
-	void initVertexBuffer(std::shared_ptr<Vertices> vertices, VkQueue transferQueue, VkCommandPool commandPool);
-	void bind(VkCommandBuffer commandBuffer);
-	void destroyVertexBuffer();
-	~VertexBuffer();
 
-	uint32_t vertexCount;
-
-public:
 	static VkVertexInputBindingDescription getBindingDescription() {
 		VkVertexInputBindingDescription bindingDescription{};
 		bindingDescription.binding = 0;
@@ -71,11 +52,7 @@ public:
 
 		return attributeDescriptions;
 	}
-
-private:
-	void uploadThroughStaging(void* data, VkDeviceSize size, VkQueue transferQueue, VkCommandPool commandPool);
-
-private:
-	VulkanResources& vulkanResources;
 };
 
+using Vertices = std::vector<Vertex>;
+
@@ -19,11 +19,12 @@ CommandBuffer& CommandBuffer::allocate(VkCommandBufferLevel level)
 	return *this;
 }
 
-void CommandBuffer::begin(VkCommandBufferUsageFlags usageFlags)
+void CommandBuffer::begin(VkCommandBufferUsageFlags usageFlags, const VkCommandBufferInheritanceInfo* inheritanceInfo)
 {
 	VkCommandBufferBeginInfo beginInfo{};
 	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 	beginInfo.flags = usageFlags;
+	beginInfo.pInheritanceInfo = inheritanceInfo;
 
 	if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
 		throw std::runtime_error("Failed to begin command buffer");
@@ -60,6 +61,52 @@ void CommandBuffer::submit(VkQueue queue, VkFence fence, VkSemaphore waitSemapho
 	}
 }
 
+void CommandBuffer::submitTimeline(VkQueue queue, VkSemaphore timelineSemaphore, uint64_t value, VkSemaphore waitSemaphore, VkSemaphore signalSemaphore, VkPipelineStageFlags waitStage)
+{
+	submitTimeline(queue, timelineSemaphore, value, { { waitSemaphore, 0, waitStage } }, signalSemaphore);
+}
+
+void CommandBuffer::submitTimeline(VkQueue queue, VkSemaphore timelineSemaphore, uint64_t value, const std::vector<SemaphoreWait>& waits, VkSemaphore signalSemaphore)
+{
+	std::vector<VkSemaphore> waitSemaphores;
+	std::vector<uint64_t> waitValues;
+	std::vector<VkPipelineStageFlags> waitStages;
+	for (const auto& wait : waits) {
+		if (wait.semaphore != VK_NULL_HANDLE) {
+			waitSemaphores.push_back(wait.semaphore);
+			waitValues.push_back(wait.value);
+			waitStages.push_back(wait.stage);
+		}
+	}
+
+	std::array<VkSemaphore, 2> signalSemaphores{ timelineSemaphore, signalSemaphore };
+	//Binary semaphores ignore their value
+	std::array<uint64_t, 2> signalValues{ value, 0 };
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo{};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+	timelineInfo.pWaitSemaphoreValues = waitValues.data();
+	timelineInfo.signalSemaphoreValueCount = signalSemaphore != VK_NULL_HANDLE ? 2 : 1;
+	timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.pNext = &timelineInfo;
+	submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+	submitInfo.pWaitSemaphores = waitSemaphores.data();
+	submitInfo.pWaitDstStageMask = waitStages.data();
+	submitInfo.signalSemaphoreCount = timelineInfo.signalSemaphoreValueCount;
+	submitInfo.pSignalSemaphores = signalSemaphores.data();
+
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+
+	if (vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to submit command buffer");
+	}
+}
+
 void CommandBuffer::free()
 {
 	if (commandBuffer != VK_NULL_HANDLE) {
@@ -9,14 +9,25 @@ class CommandBuffer
 public:
 	friend class VulkanApp;
 	friend class Renderer;
-	friend class VertexBuffer;
-	friend class IndexBuffer;
+	friend class UploadEngine;
+	friend class AsyncCompute;
 
 	CommandBuffer(VulkanResources& vulkanResources, VkCommandPool& commandPool);
 	CommandBuffer& allocate(VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
-	void begin(VkCommandBufferUsageFlags usageFlags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+	//Secondary command buffers need the inheritance info, primaries ignore it
+	void begin(VkCommandBufferUsageFlags usageFlags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, const VkCommandBufferInheritanceInfo* inheritanceInfo = nullptr);
 	void end();
 	void submit(VkQueue queue, VkFence fence = VK_NULL_HANDLE, VkSemaphore waitSemaphore = VK_NULL_HANDLE, VkSemaphore signalSemaphore = VK_NULL_HANDLE, VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+	//Semaphore a submit waits for before stage. Binary semaphores ignore value, null ones are skipped
+	struct SemaphoreWait {
+		VkSemaphore semaphore = VK_NULL_HANDLE;
+		uint64_t value = 0;
+		VkPipelineStageFlags stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	};
+
+	//Signals value on a timeline semaphore instead of a fence, the binary semaphores are for the swapchain
+	void submitTimeline(VkQueue queue, VkSemaphore timelineSemaphore, uint64_t value, VkSemaphore waitSemaphore = VK_NULL_HANDLE, VkSemaphore signalSemaphore = VK_NULL_HANDLE, VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+	void submitTimeline(VkQueue queue, VkSemaphore timelineSemaphore, uint64_t value, const std::vector<SemaphoreWait>& waits, VkSemaphore signalSemaphore = VK_NULL_HANDLE);
 	void free();
 	~CommandBuffer();
 
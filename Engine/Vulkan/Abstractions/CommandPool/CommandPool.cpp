@@ -4,11 +4,11 @@ CommandPool::CommandPool(VulkanResources& vulkanResources) : vulkanResources{ vu
 {
 }
 
-void CommandPool::initCommandPool(uint32_t queueIndex)
+void CommandPool::initCommandPool(uint32_t queueIndex, VkCommandPoolCreateFlags flags)
 {
 	VkCommandPoolCreateInfo commandPoolInfo{};
 	commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-	commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	commandPoolInfo.flags = flags;
 	commandPoolInfo.queueFamilyIndex = queueIndex;
 
 	if (vkCreateCommandPool(vulkanResources.device, &commandPoolInfo, nullptr, &commandPool) != VK_SUCCESS) {
@@ -16,6 +16,13 @@ void CommandPool::initCommandPool(uint32_t queueIndex)
 	}
 }
 
+void CommandPool::reset()
+{
+	if (vkResetCommandPool(vulkanResources.device, commandPool, 0) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to reset command pool");
+	}
+}
+
 void CommandPool::destroyCommandPool()
 {
 	if (commandPool != VK_NULL_HANDLE) {
@@ -9,9 +9,13 @@ public:
 	friend class VulkanApp;
 	friend class App;
 	friend class Renderer;
+	friend class UploadEngine;
+	friend class AsyncCompute;
 
 	CommandPool(VulkanResources& vulkanResources);
-	void initCommandPool(uint32_t queueIndex);
+	void initCommandPool(uint32_t queueIndex, VkCommandPoolCreateFlags flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+	//Resets every command buffer allocated from the pool, none of them may still be pending
+	void reset();
 	void destroyCommandPool();
 	~CommandPool();
 
@@ -161,9 +161,25 @@ VkImageView Image::createFaceMipView(uint32_t face, uint32_t mip)
 	return view;
 }
 
+VkImageView Image::createMipArrayView(uint32_t mip, uint32_t layerCount)
+{
+	VkImageViewCreateInfo info{};
+	info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	info.image = image;
+	info.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+	info.format = imageFormat;
+	info.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, mip, 1, 0, layerCount };
+
+	VkImageView view;
+	vkCreateImageView(vulkanResources.device, &info, nullptr, &view);
+	transientViews.push_back(view);
+	return view;
+}
+
 void Image::destroyTransientViews()
 {
 	for (auto& view : transientViews) {
 		vkDestroyImageView(vulkanResources.device, view, nullptr);
 	}
+	transientViews.clear();
 }
@@ -8,6 +8,8 @@ public:
 
 	friend class Renderer;
 	friend class App;
+	friend class UploadEngine;
+	friend class AsyncCompute;
 
 	Image(VulkanResources& vulkanResources);
 	void initImage(VkImageType type, VkFormat format, VkExtent3D extent, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, uint32_t mipLevels = 1, uint32_t arrayLayers = 1, VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT, VkImageTiling tiling = VK_IMAGE_TILING_OPTIMAL, VkImageCreateFlags flags = 0);
@@ -20,6 +22,8 @@ public:
 
 	VkImageView createFaceView(uint32_t face);
 	VkImageView createFaceMipView(uint32_t face, uint32_t mip);
+	//Every layer of one mip as a 2D array, for storage writes into all faces of a cube map
+	VkImageView createMipArrayView(uint32_t mip, uint32_t layerCount);
 	void destroyTransientViews();
 
 
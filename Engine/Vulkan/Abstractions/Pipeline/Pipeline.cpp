@@ -77,6 +77,30 @@ void Pipeline::initPipeline(
 	}
 }
 
+void Pipeline::initComputePipeline(VkShaderModule& computeShaderModule, VkPipelineLayoutCreateInfo pipelineLayoutInfo)
+{
+	this->pipelineLayoutInfo = pipelineLayoutInfo;
+
+	if (vkCreatePipelineLayout(vulkanResources.device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create pipeline layout");
+	}
+
+	VkPipelineShaderStageCreateInfo computeShaderStageInfo{};
+	computeShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	computeShaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	computeShaderStageInfo.module = computeShaderModule;
+	computeShaderStageInfo.pName = "main";
+
+	VkComputePipelineCreateInfo pipelineInfo{};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineInfo.stage = computeShaderStageInfo;
+	pipelineInfo.layout = pipelineLayout;
+
+	if (vkCreateComputePipelines(vulkanResources.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create compute pipeline");
+	}
+}
+
 void Pipeline::destroyPipeline()
 {
 	if (pipeline != VK_NULL_HANDLE) {
@@ -22,6 +22,7 @@ public:
 		VkPipelineViewportStateCreateInfo viewportStateInfo,
 		VkPipelineMultisampleStateCreateInfo multisamplingStateInfo,
 		VkRenderPass renderPass);
+	void initComputePipeline(VkShaderModule& computeShaderModule, VkPipelineLayoutCreateInfo pipelineLayoutInfo);
 	void destroyPipeline();
 	~Pipeline();
 
@@ -0,0 +1,95 @@
+#include "Timeline.h"
+
+Timeline::Timeline(VulkanResources& vulkanResources) : vulkanResources{ vulkanResources }
+{
+}
+
+void Timeline::initTimeline()
+{
+	VkSemaphoreTypeCreateInfo typeInfo{};
+	typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	typeInfo.initialValue = 0;
+
+	VkSemaphoreCreateInfo semaphoreInfo{};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.pNext = &typeInfo;
+
+	if (vkCreateSemaphore(vulkanResources.device, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create timeline semaphore");
+	}
+
+	submittedValue = 0;
+	completedValue = 0;
+}
+
+uint64_t Timeline::getCompletedValue()
+{
+	if (vkGetSemaphoreCounterValue(vulkanResources.device, semaphore, &completedValue) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to read timeline semaphore");
+	}
+	return completedValue;
+}
+
+bool Timeline::wait(uint64_t value, uint64_t timeout)
+{
+	if (value <= completedValue) {
+		return true;
+	}
+
+	VkSemaphoreWaitInfo waitInfo{};
+	waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores = &semaphore;
+	waitInfo.pValues = &value;
+
+	VkResult result = vkWaitSemaphores(vulkanResources.device, &waitInfo, timeout);
+	if (result == VK_TIMEOUT) {
+		return false;
+	}
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to wait for timeline semaphore");
+	}
+
+	completedValue = std::max(completedValue, value);
+	return true;
+}
+
+void Timeline::release(uint64_t value, std::function<void()> release)
+{
+	pendingReleases.push_back({ value, std::move(release) });
+}
+
+void Timeline::collect()
+{
+	if (pendingReleases.empty()) {
+		return;
+	}
+
+	//Releases are queued in submit order, so the first one still pending ends the walk
+	getCompletedValue();
+	while (!pendingReleases.empty() && pendingReleases.front().value <= completedValue) {
+		auto release = std::move(pendingReleases.front().release);
+		pendingReleases.pop_front();
+		release();
+	}
+}
+
+void Timeline::destroyTimeline()
+{
+	while (!pendingReleases.empty()) {
+		auto release = std::move(pendingReleases.front().release);
+		pendingReleases.pop_front();
+		release();
+	}
+
+	if (semaphore != VK_NULL_HANDLE) {
+		vkDestroySemaphore(vulkanResources.device, semaphore, nullptr);
+		semaphore = VK_NULL_HANDLE;
+	}
+}
+
+Timeline::~Timeline()
+{
+	destroyTimeline();
+}
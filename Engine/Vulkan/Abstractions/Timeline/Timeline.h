@@ -0,0 +1,56 @@
+#pragma once
+#include "../../Helper/Helper.h"
+
+#include <deque>
+#include <algorithm>
+
+
+//Timeline semaphore counting submissions. Every submit signals the next value, so the cpu can wait for one specific
+//submit instead of the whole device. Anything the gpu may still use is handed over with the value of the last submit
+//using it and released once the gpu is past that value
+class Timeline
+{
+public:
+	Timeline(VulkanResources& vulkanResources);
+	Timeline(const Timeline&) = delete;
+	Timeline& operator=(const Timeline&) = delete;
+	void initTimeline();
+	//Runs every pending release, the gpu has to be idle
+	void destroyTimeline();
+	~Timeline();
+
+	//Value for the next submit to signal
+	uint64_t next() {
+		return ++submittedValue;
+	}
+
+	//Last value handed to a submit, 0 before the first one
+	uint64_t getSubmittedValue() const {
+		return submittedValue;
+	}
+
+	uint64_t getCompletedValue();
+
+	//False when the timeout (in nanoseconds) ran out first
+	bool wait(uint64_t value, uint64_t timeout = UINT64_MAX);
+
+	//release runs from collect() once the gpu signaled value
+	void release(uint64_t value, std::function<void()> release);
+	void collect();
+
+	VkSemaphore semaphore = VK_NULL_HANDLE;
+
+private:
+
+	struct PendingRelease {
+		uint64_t value;
+		std::function<void()> release;
+	};
+
+	uint64_t submittedValue = 0;
+	//Cached, values only grow
+	uint64_t completedValue = 0;
+	std::deque<PendingRelease> pendingReleases;
+
+	VulkanResources& vulkanResources;
+};
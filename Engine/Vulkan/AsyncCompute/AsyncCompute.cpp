@@ -0,0 +1,226 @@
+#include "AsyncCompute.h"
+
+AsyncCompute::AsyncCompute(VulkanResources& vulkanResources) : commandPool{ vulkanResources }, timeline{ vulkanResources }, vulkanResources{ vulkanResources }
+{
+}
+
+AsyncCompute::~AsyncCompute()
+{
+	destroyAsyncCompute();
+}
+
+void AsyncCompute::initAsyncCompute(VkQueue queue, uint32_t queueIndex, uint32_t graphicsQueueIndex)
+{
+	this->queue = queue;
+	this->queueIndex = queueIndex;
+	this->graphicsQueueIndex = graphicsQueueIndex;
+
+	commandPool.initCommandPool(queueIndex, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+	timeline.initTimeline();
+}
+
+void AsyncCompute::schedule(Job job)
+{
+	scheduledJobs.push_back(std::move(job));
+}
+
+void AsyncCompute::release(VkCommandBuffer commandBuffer)
+{
+	//Inputs are only read, the compute side makes nothing available and waits for nothing but the semaphore
+	if (hasOwnershipTransfer()) {
+		std::vector<VkImageMemoryBarrier> barriers;
+		VkPipelineStageFlags stages = 0;
+		for (const auto& job : scheduledJobs) {
+			for (const auto& input : job.inputs) {
+				barriers.push_back(getTransfer(input, input.layout, graphicsQueueIndex, queueIndex));
+				stages |= input.graphicsStage;
+			}
+		}
+
+		if (!barriers.empty()) {
+			vkCmdPipelineBarrier(commandBuffer, stages, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+				0, nullptr,
+				0, nullptr,
+				static_cast<uint32_t>(barriers.size()), barriers.data());
+		}
+	}
+
+	releasedJobs.insert(releasedJobs.end(), std::make_move_iterator(scheduledJobs.begin()), std::make_move_iterator(scheduledJobs.end()));
+	scheduledJobs.clear();
+}
+
+uint64_t AsyncCompute::submit(CommandBuffer::SemaphoreWait graphicsWait)
+{
+	if (releasedJobs.empty()) {
+		return timeline.getSubmittedValue();
+	}
+
+	auto batch = std::make_unique<Batch>();
+	if (!freeCommandBuffers.empty()) {
+		batch->commandBuffer = std::move(freeCommandBuffers.back());
+		freeCommandBuffers.pop_back();
+	}
+	else {
+		batch->commandBuffer = std::make_unique<CommandBuffer>(vulkanResources, commandPool.commandPool);
+		batch->commandBuffer->allocate();
+	}
+	batch->commandBuffer->begin();
+	VkCommandBuffer commandBuffer = batch->commandBuffer->commandBuffer;
+
+	//Inputs are acquired from graphics, outputs are discarded and made writable
+	std::vector<VkImageMemoryBarrier> barriers;
+	for (const auto& job : releasedJobs) {
+		if (hasOwnershipTransfer()) {
+			for (const auto& input : job.inputs) {
+				VkImageMemoryBarrier barrier = getTransfer(input, input.layout, graphicsQueueIndex, queueIndex);
+				barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+				barriers.push_back(barrier);
+			}
+		}
+		for (const auto& output : job.outputs) {
+			VkImageMemoryBarrier barrier = getTransfer(output, VK_IMAGE_LAYOUT_UNDEFINED, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED);
+			barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			barriers.push_back(barrier);
+		}
+	}
+	if (!barriers.empty()) {
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+			0, nullptr,
+			0, nullptr,
+			static_cast<uint32_t>(barriers.size()), barriers.data());
+	}
+
+	for (auto& job : releasedJobs) {
+		job.record(commandBuffer);
+	}
+
+	//Everything goes back to graphics, which repeats these barriers in acquire()
+	const uint32_t srcQueueIndex = hasOwnershipTransfer() ? queueIndex : VK_QUEUE_FAMILY_IGNORED;
+	const uint32_t dstQueueIndex = hasOwnershipTransfer() ? graphicsQueueIndex : VK_QUEUE_FAMILY_IGNORED;
+	barriers.clear();
+	for (const auto& job : releasedJobs) {
+		if (hasOwnershipTransfer()) {
+			for (const auto& input : job.inputs) {
+				barriers.push_back(getTransfer(input, input.layout, srcQueueIndex, dstQueueIndex));
+			}
+		}
+		for (const auto& output : job.outputs) {
+			VkImageMemoryBarrier barrier = getTransfer(output, VK_IMAGE_LAYOUT_GENERAL, srcQueueIndex, dstQueueIndex);
+			barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			barriers.push_back(barrier);
+		}
+	}
+	if (!barriers.empty()) {
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+			0, nullptr,
+			0, nullptr,
+			static_cast<uint32_t>(barriers.size()), barriers.data());
+	}
+
+	batch->commandBuffer->end();
+	batch->value = timeline.next();
+	batch->commandBuffer->submitTimeline(queue, timeline.semaphore, batch->value, std::vector<CommandBuffer::SemaphoreWait>{ graphicsWait });
+
+	batch->jobs = std::move(releasedJobs);
+	releasedJobs.clear();
+	submittedBatches.push_back(std::move(batch));
+
+	return submittedBatches.back()->value;
+}
+
+CommandBuffer::SemaphoreWait AsyncCompute::acquire(VkCommandBuffer commandBuffer)
+{
+	std::vector<VkImageMemoryBarrier> barriers;
+	std::vector<std::function<void()>> callbacks;
+	VkPipelineStageFlags stages = 0;
+	uint64_t value = acquiredValue;
+
+	//Only finished batches, the semaphore wait below is already satisfied
+	const uint64_t completedValue = timeline.getCompletedValue();
+	while (!submittedBatches.empty() && submittedBatches.front()->value <= completedValue) {
+		Batch& batch = *submittedBatches.front();
+		for (auto& job : batch.jobs) {
+			for (const auto& input : job.inputs) {
+				if (hasOwnershipTransfer()) {
+					VkImageMemoryBarrier barrier = getTransfer(input, input.layout, queueIndex, graphicsQueueIndex);
+					barrier.dstAccessMask = input.graphicsAccess;
+					barriers.push_back(barrier);
+				}
+				stages |= input.graphicsStage;
+			}
+			for (const auto& output : job.outputs) {
+				if (hasOwnershipTransfer()) {
+					VkImageMemoryBarrier barrier = getTransfer(output, VK_IMAGE_LAYOUT_GENERAL, queueIndex, graphicsQueueIndex);
+					barrier.dstAccessMask = output.graphicsAccess;
+					barriers.push_back(barrier);
+				}
+				stages |= output.graphicsStage;
+			}
+			if (job.onAcquired) {
+				callbacks.push_back(std::move(job.onAcquired));
+			}
+		}
+
+		value = batch.value;
+		freeCommandBuffers.push_back(std::move(batch.commandBuffer));
+		submittedBatches.pop_front();
+	}
+
+	if (value == acquiredValue) {
+		return {};
+	}
+
+	//Jobs without images may still have written buffers, their results are waited for everywhere
+	if (stages == 0) {
+		stages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+	}
+	if (!barriers.empty()) {
+		vkCmdPipelineBarrier(commandBuffer, stages, stages, 0,
+			0, nullptr,
+			0, nullptr,
+			static_cast<uint32_t>(barriers.size()), barriers.data());
+	}
+
+	acquiredValue = value;
+	for (auto& callback : callbacks) {
+		callback();
+	}
+
+	return { timeline.semaphore, value, stages };
+}
+
+VkImageMemoryBarrier AsyncCompute::getTransfer(const ImageUse& use, VkImageLayout oldLayout, uint32_t srcQueueIndex, uint32_t dstQueueIndex) const
+{
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = 0;
+	barrier.oldLayout = oldLayout;
+	barrier.newLayout = use.layout;
+	barrier.srcQueueFamilyIndex = srcQueueIndex;
+	barrier.dstQueueFamilyIndex = dstQueueIndex;
+	barrier.image = use.image->image;
+	barrier.subresourceRange = use.range;
+	return barrier;
+}
+
+void AsyncCompute::destroyAsyncCompute()
+{
+	if (queue == VK_NULL_HANDLE) {
+		return;
+	}
+
+	timeline.wait(timeline.getSubmittedValue());
+
+	//Command buffers go back to the pool before it is destroyed
+	scheduledJobs.clear();
+	releasedJobs.clear();
+	submittedBatches.clear();
+	freeCommandBuffers.clear();
+	acquiredValue = 0;
+
+	timeline.destroyTimeline();
+	commandPool.destroyCommandPool();
+	queue = VK_NULL_HANDLE;
+}
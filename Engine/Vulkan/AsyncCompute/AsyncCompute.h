@@ -0,0 +1,105 @@
+#pragma once
+#include "../Helper/Helper.h"
+
+#include <deque>
+#include <memory>
+#include "../Abstractions/Image/Image.h"
+#include "../Abstractions/CommandPool/CommandPool.h"
+#include "../Abstractions/CommandBuffer/CommandBuffer.h"
+#include "../Abstractions/Timeline/Timeline.h"
+
+
+//Runs compute jobs on the compute queue, alongside the graphics work. Scheduled jobs are handed to the compute queue by
+//release() in a graphics command buffer and go out with the next submit(), which waits for that graphics submit. Jobs
+//finish in their own time: acquire() only takes over the results of jobs the compute timeline already passed, so
+//graphics never waits on the gpu for a job that is still running and the results show up a few frames later.
+//When the compute queue has its own family, every image a job uses changes hands twice, inputs go to compute and back
+//and outputs are handed to graphics. Graphics must not use the inputs until the job was acquired
+class AsyncCompute
+{
+public:
+
+	//Inputs are read in layout and stay in it. Outputs start out discarded, the job writes them in GENERAL and they end
+	//in layout. The graphics stage and access are the last use before the job (inputs) and the first one after it.
+	//An image belongs to one job at a time
+	struct ImageUse {
+		Image* image = nullptr;
+		VkImageSubresourceRange range{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		VkPipelineStageFlags graphicsStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		VkAccessFlags graphicsAccess = VK_ACCESS_SHADER_READ_BIT;
+	};
+
+	struct Job {
+		//Records the dispatches, inputs and outputs are ready and synchronized against the job's own barriers
+		std::function<void(VkCommandBuffer)> record;
+		std::vector<ImageUse> inputs;
+		std::vector<ImageUse> outputs;
+		//Runs inside the acquire() that hands the job's images back, graphics can use them from that command buffer on
+		std::function<void()> onAcquired;
+	};
+
+	AsyncCompute(VulkanResources& vulkanResources);
+	AsyncCompute(const AsyncCompute&) = delete;
+	AsyncCompute& operator=(const AsyncCompute&) = delete;
+	~AsyncCompute();
+
+	//graphicsQueueIndex: family that hands over the inputs and uses the results
+	void initAsyncCompute(VkQueue queue, uint32_t queueIndex, uint32_t graphicsQueueIndex);
+	//Waits for the jobs still in flight
+	void destroyAsyncCompute();
+
+	void schedule(Job job);
+
+	//Records the releases of the scheduled jobs' inputs into a graphics command buffer. The jobs go out with the
+	//next submit(), which has to come after the submit of commandBuffer
+	void release(VkCommandBuffer commandBuffer);
+
+	//Submits the released jobs as one batch that waits for graphicsWait, the submit release() was recorded into.
+	//Returns the value it signals, the last submitted value when there was nothing to submit
+	uint64_t submit(CommandBuffer::SemaphoreWait graphicsWait);
+
+	//Records the acquires of every finished job into commandBuffer and runs their callbacks. Its submit has to wait for
+	//the returned semaphore, which is null when nothing finished since the last call and never blocks otherwise
+	CommandBuffer::SemaphoreWait acquire(VkCommandBuffer commandBuffer);
+
+	bool isComplete(uint64_t value) {
+		return value <= timeline.getCompletedValue();
+	}
+
+	//Scheduled, released or running jobs that were not acquired yet
+	bool hasPendingJobs() const {
+		return !scheduledJobs.empty() || !releasedJobs.empty() || !submittedBatches.empty();
+	}
+
+private:
+
+	struct Batch {
+		std::unique_ptr<CommandBuffer> commandBuffer;
+		std::vector<Job> jobs;
+		uint64_t value = 0;
+	};
+
+	bool hasOwnershipTransfer() const {
+		return queueIndex != graphicsQueueIndex;
+	}
+
+	//Moves use's image from oldLayout to its layout between the two families, access masks are left to the caller
+	VkImageMemoryBarrier getTransfer(const ImageUse& use, VkImageLayout oldLayout, uint32_t srcQueueIndex, uint32_t dstQueueIndex) const;
+
+	VkQueue queue = VK_NULL_HANDLE;
+	uint32_t queueIndex = 0;
+	uint32_t graphicsQueueIndex = 0;
+
+	CommandPool commandPool;
+	Timeline timeline;
+
+	std::vector<Job> scheduledJobs;
+	std::vector<Job> releasedJobs;
+	std::deque<std::unique_ptr<Batch>> submittedBatches;
+	std::vector<std::unique_ptr<CommandBuffer>> freeCommandBuffers;
+	//Value of the last batch acquire() handed back
+	uint64_t acquiredValue = 0;
+
+	VulkanResources& vulkanResources;
+};
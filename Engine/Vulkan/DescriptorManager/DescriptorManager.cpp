@@ -5,17 +5,28 @@ DescriptorManager::DescriptorManager(VulkanResources& vulkanResources) : vulkanR
 
 }
 
-void DescriptorManager::initDescriptorManager()
+void DescriptorManager::initDescriptorManager(uint32_t framesInFlight)
 {
+	this->framesInFlight = framesInFlight;
+
 	initDescriptorPool();
 	initGlobalDescriptorSet();
 	initBindlessResourceDescriptorSet();
 	initTargetDescriptorSet();
+	initCullingDescriptorSets();
+	initHiZDescriptorSets();
+	initIBLDescriptorSets();
 }
 
 void DescriptorManager::destroy()
 {
 	descriptorPool.destroyDescriptorPool();
+	cullingDescriptorSets.clear();
+	hiZDescriptorSets.clear();
+	iblDescriptorSets.clear();
+	vkDestroyDescriptorSetLayout(vulkanResources.device, iblDescriptorSetLayout, nullptr);
+	vkDestroyDescriptorSetLayout(vulkanResources.device, hiZDescriptorSetLayout, nullptr);
+	vkDestroyDescriptorSetLayout(vulkanResources.device, cullingDescriptorSetLayout, nullptr);
 	vkDestroyDescriptorSetLayout(vulkanResources.device, targetDescriptorSetLayout, nullptr);
 	vkDestroyDescriptorSetLayout(vulkanResources.device, bindlessResourceDescriptorSetLayout, nullptr);
 	vkDestroyDescriptorSetLayout(vulkanResources.device, globalDescriptorSetLayout, nullptr);
@@ -30,12 +41,14 @@ void DescriptorManager::initDescriptorPool()
 {
 	descriptorPool.initDescriptorPool(
 		{
-			{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1},
-			{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1 + 1},
-			{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 6000 + 6000 + 10},
-			{VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, 1}
+			{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1},
+			{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, OBJECT_PAGES + 1},
+			{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 6000 + 6000 + 10 + framesInFlight + MAX_HIZ_LEVELS + IBL_SETS},
+			{VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, 1},
+			{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 14 * framesInFlight},
+			{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, MAX_HIZ_LEVELS + IBL_SETS}
 		},
-		3, // 3 sets
+		3 + framesInFlight + MAX_HIZ_LEVELS + IBL_SETS, // 3 sets + culling per frame + hi-z per level + ibl per map
 		VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT); // For bindless
 
 
@@ -43,32 +56,40 @@ void DescriptorManager::initDescriptorPool()
 
 void DescriptorManager::initGlobalDescriptorSet() //Non-Bindless
 {
+	//Every object page and the lights take a dynamic storage buffer
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(vulkanResources.physicalDevice, &properties);
+	if (properties.limits.maxDescriptorSetStorageBuffersDynamic < OBJECT_PAGES + 1) {
+		throw std::runtime_error("Device does not support enough dynamic storage buffers for the object pages");
+	}
+
 	std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
 	//Binding 0 - Global UBO
 	bindings[0].binding = 0;
-	bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 	bindings[0].descriptorCount = 1;
-	bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+	bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
 	bindings[0].pImmutableSamplers = nullptr;
 
-	//Binding 1 - Object SSBO
+	//Binding 1 - Object SSBO pages, also read by culling
 	bindings[1].binding = 1;
-	bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-	bindings[1].descriptorCount = 1;
-	bindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+	bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+	bindings[1].descriptorCount = OBJECT_PAGES;
+	bindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
 	bindings[1].pImmutableSamplers = nullptr;
 
 	//Binding 1 - Lights SSBO
 	bindings[2].binding = 2;
-	bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
 	bindings[2].descriptorCount = 1;
 	bindings[2].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 	bindings[2].pImmutableSamplers = nullptr;
 
+	//Dynamic buffers cannot be updated after bind. They are written once and every frame only changes the offsets
 	std::array<VkDescriptorBindingFlags, 3> bindingFlags = {
-		VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT,
-		VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT,
-		VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT
+		VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT,
+		VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT,
+		VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT
 	};
 
 	VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
@@ -80,7 +101,6 @@ void DescriptorManager::initGlobalDescriptorSet() //Non-Bindless
 	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
 	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
 	layoutInfo.pBindings = bindings.data();
-	layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
 	layoutInfo.pNext = &bindingFlagsInfo;
 
 	if (vkCreateDescriptorSetLayout(vulkanResources.device, &layoutInfo, nullptr, &globalDescriptorSetLayout) != VK_SUCCESS) {
@@ -199,15 +219,23 @@ void DescriptorManager::initTargetDescriptorSet() //Non-Bindless
 	bindings[8].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 	bindings[8].pImmutableSamplers = nullptr;
 
+	//The ibl maps are computed while the first frames render. Their bindings stay empty until then and are written
+	//while those frames are still pending, the lighting pass does not read them before
+	std::array<VkDescriptorBindingFlags, 9> bindingFlags{};
+	for (uint32_t binding : { SKYBOX_IRRADIANCE_IMAGE, SKYBOX_PREFILTER_IMAGE, SKYBOX_LUT_IMAGE }) {
+		bindingFlags[binding] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+	}
+
 	VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
 	bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
-	bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-	bindingFlagsInfo.pBindingFlags = nullptr;
+	bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+	bindingFlagsInfo.pBindingFlags = bindingFlags.data();
 
 	VkDescriptorSetLayoutCreateInfo layoutInfo{};
 	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
 	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
 	layoutInfo.pBindings = bindings.data();
+	layoutInfo.pNext = &bindingFlagsInfo;
 
 	if (vkCreateDescriptorSetLayout(vulkanResources.device, &layoutInfo, nullptr, &targetDescriptorSetLayout) != VK_SUCCESS) {
 		throw std::runtime_error("Failed to create global descriptor set layout");
@@ -248,3 +276,190 @@ void DescriptorManager::initRayTracingDescriptorSet()
 
 	raytracingDescriptorSet.initDescriptorSet(raytracingDescriptorSetLayout, descriptorPool.descriptorPool);
 }
+
+void DescriptorManager::initCullingDescriptorSets() //Non-Bindless
+{
+	std::array<VkDescriptorSetLayoutBinding, 15> bindings{};
+	//Binding 0 - Mesh Table
+	bindings[0].binding = 0;
+	bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[0].descriptorCount = 1;
+	bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	bindings[0].pImmutableSamplers = nullptr;
+
+	//Binding 1 - Draw Commands
+	bindings[1].binding = 1;
+	bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[1].descriptorCount = 1;
+	bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	bindings[1].pImmutableSamplers = nullptr;
+
+	//Binding 2 - Draw Count
+	bindings[2].binding = 2;
+	bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[2].descriptorCount = 1;
+	bindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	bindings[2].pImmutableSamplers = nullptr;
+
+	//Binding 3 - Draw Batches
+	bindings[3].binding = 3;
+	bindings[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[3].descriptorCount = 1;
+	bindings[3].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	bindings[3].pImmutableSamplers = nullptr;
+
+	//Binding 4 - Visible Instances per Batch
+	bindings[4].binding = 4;
+	bindings[4].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[4].descriptorCount = 1;
+	bindings[4].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	bindings[4].pImmutableSamplers = nullptr;
+
+	//Binding 5 - Instances, object index of every instance. Read by the g-buffer
+	bindings[5].binding = 5;
+	bindings[5].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[5].descriptorCount = 1;
+	bindings[5].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT;
+	bindings[5].pImmutableSamplers = nullptr;
+
+	//Binding 6 - Visibility of every object in the last frame
+	bindings[6].binding = 6;
+	bindings[6].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[6].descriptorCount = 1;
+	bindings[6].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	bindings[6].pImmutableSamplers = nullptr;
+
+	//Binding 7 - Hi-Z Pyramid
+	bindings[7].binding = 7;
+	bindings[7].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	bindings[7].descriptorCount = 1;
+	bindings[7].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	bindings[7].pImmutableSamplers = nullptr;
+
+	//Binding 8 - Meshlets of every mesh
+	bindings[8].binding = 8;
+	bindings[8].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[8].descriptorCount = 1;
+	bindings[8].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	bindings[8].pImmutableSamplers = nullptr;
+
+	//Binding 9 - Mesh Indices, the index pool
+	bindings[9].binding = 9;
+	bindings[9].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[9].descriptorCount = 1;
+	bindings[9].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	bindings[9].pImmutableSamplers = nullptr;
+
+	//Binding 10 - Visible Instances, instance slot of every visible object
+	bindings[10].binding = 10;
+	bindings[10].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[10].descriptorCount = 1;
+	bindings[10].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	bindings[10].pImmutableSamplers = nullptr;
+
+	//Binding 11 - Meshlet Dispatch, indirect dispatch and counters of the meshlet pass
+	bindings[11].binding = 11;
+	bindings[11].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[11].descriptorCount = 1;
+	bindings[11].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	bindings[11].pImmutableSamplers = nullptr;
+
+	//Binding 12 - Draw Indices, compacted indices of the visible meshlets
+	bindings[12].binding = 12;
+	bindings[12].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[12].descriptorCount = 1;
+	bindings[12].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	bindings[12].pImmutableSamplers = nullptr;
+
+	//Binding 13 - Meshlet Masks, a bit per meshlet of the pool that some visible instance sees
+	bindings[13].binding = 13;
+	bindings[13].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[13].descriptorCount = 1;
+	bindings[13].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	bindings[13].pImmutableSamplers = nullptr;
+
+	//Binding 14 - Draw Order, rank of every batch by its sort key
+	bindings[14].binding = 14;
+	bindings[14].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[14].descriptorCount = 1;
+	bindings[14].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	bindings[14].pImmutableSamplers = nullptr;
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+	layoutInfo.pBindings = bindings.data();
+
+	if (vkCreateDescriptorSetLayout(vulkanResources.device, &layoutInfo, nullptr, &cullingDescriptorSetLayout) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create culling descriptor set layout");
+	}
+
+	cullingDescriptorSets.reserve(framesInFlight);
+	for (uint32_t i = 0; i < framesInFlight; ++i) {
+		cullingDescriptorSets.emplace_back(vulkanResources).initDescriptorSet(cullingDescriptorSetLayout, descriptorPool.descriptorPool);
+	}
+}
+
+void DescriptorManager::initHiZDescriptorSets() //Non-Bindless
+{
+	std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+	//Binding 0 - Source, depth buffer or the previous level
+	bindings[0].binding = 0;
+	bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	bindings[0].descriptorCount = 1;
+	bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	bindings[0].pImmutableSamplers = nullptr;
+
+	//Binding 1 - Destination level
+	bindings[1].binding = 1;
+	bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	bindings[1].descriptorCount = 1;
+	bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	bindings[1].pImmutableSamplers = nullptr;
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+	layoutInfo.pBindings = bindings.data();
+
+	if (vkCreateDescriptorSetLayout(vulkanResources.device, &layoutInfo, nullptr, &hiZDescriptorSetLayout) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create hi-z descriptor set layout");
+	}
+
+	hiZDescriptorSets.reserve(MAX_HIZ_LEVELS);
+	for (uint32_t i = 0; i < MAX_HIZ_LEVELS; ++i) {
+		hiZDescriptorSets.emplace_back(vulkanResources).initDescriptorSet(hiZDescriptorSetLayout, descriptorPool.descriptorPool);
+	}
+}
+
+void DescriptorManager::initIBLDescriptorSets() //Non-Bindless
+{
+	std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+	//Binding 0 - Skybox
+	bindings[0].binding = 0;
+	bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	bindings[0].descriptorCount = 1;
+	bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	bindings[0].pImmutableSamplers = nullptr;
+
+	//Binding 1 - Map written, all faces of one mip for the cube maps
+	bindings[1].binding = 1;
+	bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	bindings[1].descriptorCount = 1;
+	bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	bindings[1].pImmutableSamplers = nullptr;
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+	layoutInfo.pBindings = bindings.data();
+
+	if (vkCreateDescriptorSetLayout(vulkanResources.device, &layoutInfo, nullptr, &iblDescriptorSetLayout) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create ibl descriptor set layout");
+	}
+
+	iblDescriptorSets.reserve(IBL_SETS);
+	for (uint32_t i = 0; i < IBL_SETS; ++i) {
+		iblDescriptorSets.emplace_back(vulkanResources).initDescriptorSet(iblDescriptorSetLayout, descriptorPool.descriptorPool);
+	}
+}
@@ -31,6 +31,20 @@ public:
 		LIGHTING_SSBO = 2
 	};
 
+	//Objects are split over pages, no single storage range may be larger than the device allows (at least 2^27 bytes).
+	//A page holds a power of two objects so the shaders find it with a shift
+	static constexpr uint32_t OBJECT_PAGES = 4;
+	static constexpr uint32_t OBJECT_PAGE_SHIFT = 19;
+	static constexpr uint32_t OBJECTS_PER_PAGE = 1u << OBJECT_PAGE_SHIFT;
+
+	//Dynamic offsets of the global set, ordered by binding and then by array element
+	enum GLOBAL_OFFSET : uint32_t {
+		GLOBAL_UBO_OFFSET = 0,
+		OBJECT_SSBO_OFFSET = 1,
+		LIGHTING_SSBO_OFFSET = 1 + OBJECT_PAGES,
+		GLOBAL_OFFSET_COUNT = 2 + OBJECT_PAGES
+	};
+
 	enum TARGET_BINDING : uint32_t {
 		ALBEDO_IMAGE = 0,
 		NORMAL_IMAGE = 1,
@@ -48,8 +62,44 @@ public:
 		TEXTURES = 0
 	};
 
+	enum CULLING_BINDING : uint32_t {
+		MESH_TABLE = 0,
+		DRAW_COMMANDS = 1,
+		DRAW_COUNT = 2,
+		DRAW_BATCHES = 3,
+		BATCH_COUNTS = 4,
+		INSTANCES = 5,
+		VISIBILITY = 6,
+		HIZ_IMAGE = 7,
+		MESHLETS = 8,
+		MESH_INDICES = 9,
+		VISIBLE_INSTANCES = 10,
+		MESHLET_DISPATCH = 11,
+		DRAW_INDICES = 12,
+		MESHLET_MASKS = 13,
+		DRAW_ORDER = 14
+	};
+
+	enum HIZ_BINDING : uint32_t {
+		SOURCE_IMAGE = 0,
+		DESTINATION_IMAGE = 1
+	};
+
+	enum IBL_BINDING : uint32_t {
+		SKYBOX_IMAGE = 0,
+		IBL_IMAGE = 1
+	};
+
+	//Enough levels for a 32768 wide depth buffer
+	static constexpr uint32_t MAX_HIZ_LEVELS = 16;
+
+	//Mips of the prefiltered cube map, roughness 0 to 1
+	static constexpr uint32_t PREFILTER_MIPS = 5;
+	//Irradiance, every prefilter mip and the brdf lut
+	static constexpr uint32_t IBL_SETS = PREFILTER_MIPS + 2;
+
 	DescriptorManager(VulkanResources& vulkanResources);
-	void initDescriptorManager();
+	void initDescriptorManager(uint32_t framesInFlight);
 	void destroy();
 	~DescriptorManager();
 
@@ -60,6 +110,9 @@ private:
 	void initBindlessResourceDescriptorSet();
 	void initTargetDescriptorSet();
 	void initRayTracingDescriptorSet();
+	void initCullingDescriptorSets();
+	void initHiZDescriptorSets();
+	void initIBLDescriptorSets();
 
 	VulkanResources& vulkanResources;
 
@@ -77,6 +130,20 @@ private:
 	VkDescriptorSetLayout raytracingDescriptorSetLayout;
 	DescriptorSet raytracingDescriptorSet{ vulkanResources };
 
+	//One per frame in flight, rewritten while recording that frame
+	VkDescriptorSetLayout cullingDescriptorSetLayout;
+	std::vector<DescriptorSet> cullingDescriptorSets;
+
+	//One per level of the hi-z pyramid, reads the level above (or the depth buffer) and writes the level
+	VkDescriptorSetLayout hiZDescriptorSetLayout;
+	std::vector<DescriptorSet> hiZDescriptorSets;
+
+	//One per map the ibl compute shaders write, each reads the skybox
+	VkDescriptorSetLayout iblDescriptorSetLayout;
+	std::vector<DescriptorSet> iblDescriptorSets;
+
+	uint32_t framesInFlight = 2;
+
 
 
 
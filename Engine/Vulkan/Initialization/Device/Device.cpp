@@ -8,9 +8,36 @@ Device::Device(VulkanResources& vulkanResources) : vulkanResources{ vulkanResour
 
 void Device::initDevice()
 {
+	//Indirect draws built on the gpu, the object index travels as the first instance
+	VkPhysicalDeviceFeatures features{};
+	features.multiDrawIndirect = VK_TRUE;
+	features.drawIndirectFirstInstance = VK_TRUE;
+	//The ibl maps are written as storage images, the brdf lut is rg16f
+	features.shaderStorageImageExtendedFormats = VK_TRUE;
+
+	//Descriptor indexing and buffer device address are core in 1.2, so they are requested here together with draw indirect count.
+	//vk-bootstrap chains these into the device itself
+	VkPhysicalDeviceVulkan12Features features12{};
+	features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	features12.drawIndirectCount = VK_TRUE;
+	features12.timelineSemaphore = VK_TRUE;
+	features12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+	features12.runtimeDescriptorArray = VK_TRUE;
+	features12.descriptorBindingPartiallyBound = VK_TRUE;
+	features12.descriptorBindingVariableDescriptorCount = VK_TRUE;
+	features12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+	features12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+	features12.descriptorBindingUniformBufferUpdateAfterBind = VK_TRUE;
+	features12.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+	features12.shaderUniformBufferArrayNonUniformIndexing = VK_TRUE;
+	features12.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+	features12.bufferDeviceAddress = VK_TRUE;
+
 	//Physical Device
 	vkb::PhysicalDeviceSelector selector{ vulkanResources.vkb_instance };
 	auto physicalDeviceReturn = selector.set_surface(vulkanResources.surface)
+		.set_required_features(features)
+		.set_required_features_12(features12)
 		.add_required_extension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)
 		.add_required_extension(VK_KHR_MAINTENANCE3_EXTENSION_NAME)
 		.add_required_extension(VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME)
@@ -23,23 +50,6 @@ void Device::initDevice()
 	}
 
 
-	VkPhysicalDeviceDescriptorIndexingFeatures descriptorIndexingFeatures{};
-	descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
-	descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
-	descriptorIndexingFeatures.runtimeDescriptorArray = VK_TRUE;
-	descriptorIndexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
-	descriptorIndexingFeatures.descriptorBindingVariableDescriptorCount = VK_TRUE;
-	descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
-	descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
-	descriptorIndexingFeatures.descriptorBindingUniformBufferUpdateAfterBind = VK_TRUE;
-	descriptorIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
-	descriptorIndexingFeatures.shaderUniformBufferArrayNonUniformIndexing = VK_TRUE;
-	descriptorIndexingFeatures.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
-
-	VkPhysicalDeviceBufferDeviceAddressFeatures bufferDeviceAddressFeatures{};
-	bufferDeviceAddressFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
-	bufferDeviceAddressFeatures.bufferDeviceAddress = VK_TRUE;
-
 	VkPhysicalDeviceAccelerationStructureFeaturesKHR accelerationStructureFeatures{};
 	accelerationStructureFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR;
 	accelerationStructureFeatures.accelerationStructure = VK_TRUE;
@@ -51,7 +61,7 @@ void Device::initDevice()
 
 	//Logical Device
 	vkb::DeviceBuilder deviceBuilder{ physicalDeviceReturn.value() };
-	auto deviceReturn = deviceBuilder.add_pNext(&descriptorIndexingFeatures).add_pNext(&bufferDeviceAddressFeatures).add_pNext(&accelerationStructureFeatures).add_pNext(&rayTracingPipelineFeatures).build();
+	auto deviceReturn = deviceBuilder.add_pNext(&accelerationStructureFeatures).add_pNext(&rayTracingPipelineFeatures).build();
 	if (!deviceReturn) {
 		throw std::runtime_error("Failed to create logical device");
 	}
@@ -80,6 +90,36 @@ void Device::initQueues()
 		throw std::runtime_error("Failed to create present queue");
 	}
 	presentQueue = presentQueueReturn.value();
+
+	//Transfer queue, a dedicated family (copy engine) runs uploads alongside rendering. Any other family without graphics
+	//comes next, uploads go through the graphics queue when there is none
+	auto transferIndexReturn = device.get_dedicated_queue_index(vkb::QueueType::transfer);
+	if (!transferIndexReturn) {
+		transferIndexReturn = device.get_queue_index(vkb::QueueType::transfer);
+	}
+	if (transferIndexReturn) {
+		transferQueueIndex = transferIndexReturn.value();
+		vkGetDeviceQueue(vulkanResources.device, transferQueueIndex, 0, &transferQueue);
+	}
+	else {
+		transferQueueIndex = getQueueIndex(vkb::QueueType::graphics);
+		transferQueue = graphicsQueue;
+	}
+
+	//Compute queue, a family without graphics runs compute jobs alongside rendering. They go through the graphics
+	//queue when there is none
+	auto computeIndexReturn = device.get_dedicated_queue_index(vkb::QueueType::compute);
+	if (!computeIndexReturn) {
+		computeIndexReturn = device.get_queue_index(vkb::QueueType::compute);
+	}
+	if (computeIndexReturn) {
+		computeQueueIndex = computeIndexReturn.value();
+		vkGetDeviceQueue(vulkanResources.device, computeQueueIndex, 0, &computeQueue);
+	}
+	else {
+		computeQueueIndex = getQueueIndex(vkb::QueueType::graphics);
+		computeQueue = graphicsQueue;
+	}
 }
 
 void Device::initAllocator()
@@ -26,6 +26,12 @@ private:
 
 	VkQueue graphicsQueue;
 	VkQueue presentQueue;
+	//Family without graphics when the device has one, the graphics queue otherwise
+	VkQueue transferQueue;
+	uint32_t transferQueueIndex;
+	//Family with compute but without graphics when the device has one (async compute), the graphics queue otherwise
+	VkQueue computeQueue;
+	uint32_t computeQueueIndex;
 
 	VulkanResources& vulkanResources;
 };
@@ -0,0 +1,529 @@
+#include "MeshRegistry.h"
+
+MeshRegistry::MeshRegistry(VulkanResources& vulkanResources) : vulkanResources{ vulkanResources }
+{
+}
+
+MeshRegistry::~MeshRegistry()
+{
+	destroyMeshRegistry();
+}
+
+void MeshRegistry::initMeshRegistry(UploadEngine& uploadEngine, uint32_t framesInFlight, VkDeviceSize defragmentBudget)
+{
+	this->uploadEngine = &uploadEngine;
+	this->framesInFlight = std::max(framesInFlight, 1u);
+	this->defragmentBudget = defragmentBudget;
+
+	initPool(vertexPool, sizeof(Vertex), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+	//Meshlet culling reads the indices it compacts
+	initPool(indexPool, sizeof(uint32_t), VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+	initPool(meshletPool, sizeof(Meshlet), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+}
+
+void MeshRegistry::initPool(Pool& pool, VkDeviceSize elementSize, VkBufferUsageFlags usage)
+{
+	pool.elementSize = elementSize;
+	pool.usage = usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+}
+
+uint32_t MeshRegistry::add(const std::shared_ptr<Vertices>& vertices, const std::shared_ptr<Indices>& indices, std::shared_ptr<Meshlets> meshlets)
+{
+	auto it = registered.find(vertices.get());
+	if (it != registered.end() && it->second.vertices.lock() == vertices && it->second.indices.lock() == indices) {
+		return it->second.meshId;
+	}
+
+	uint32_t meshId = static_cast<uint32_t>(meshes.size());
+	MeshEntry& mesh = meshes.emplace_back();
+	mesh.range.indexCount = static_cast<uint32_t>(indices->size());
+	mesh.range.vertexCount = static_cast<uint32_t>(vertices->size());
+	mesh.key = vertices.get();
+
+	//Sphere around the center of the bounding box, slightly larger than the tightest one but cheap to build
+	if (!vertices->empty()) {
+		glm::vec3 minimum = (*vertices)[0].pos;
+		glm::vec3 maximum = (*vertices)[0].pos;
+		for (const Vertex& vertex : *vertices) {
+			minimum = glm::min(minimum, vertex.pos);
+			maximum = glm::max(maximum, vertex.pos);
+		}
+
+		glm::vec3 center = (minimum + maximum) * 0.5f;
+		float radius = 0.0f;
+		for (const Vertex& vertex : *vertices) {
+			radius = std::max(radius, glm::length(vertex.pos - center));
+		}
+		mesh.range.bounds = glm::vec4(center, radius);
+	}
+
+	if (!meshlets) {
+		meshlets = std::make_shared<Meshlets>(buildMeshlets(*vertices, *indices));
+	}
+	mesh.range.meshletCount = static_cast<uint32_t>(meshlets->size());
+
+	pending.push_back({ meshId, vertices, indices, std::move(meshlets) });
+	registered[vertices.get()] = { vertices, indices, meshId };
+
+	return meshId;
+}
+
+void MeshRegistry::remove(uint32_t meshId)
+{
+	MeshEntry& mesh = meshes[meshId];
+	if (mesh.isRemoved) {
+		return;
+	}
+
+	//Queued uploads still write the ranges, they are retired once the last one went out
+	if (!mesh.isUploading) {
+		retireRanges(mesh);
+	}
+
+	auto it = registered.find(mesh.key);
+	if (it != registered.end() && it->second.meshId == meshId) {
+		registered.erase(it);
+	}
+
+	mesh.isRemoved = true;
+	isMeshTableDirty = true;
+}
+
+void MeshRegistry::retireRanges(MeshEntry& mesh)
+{
+	for (Pool* pool : { &vertexPool, &indexPool, &meshletPool }) {
+		VmaVirtualAllocation& allocation = getAllocation(mesh, *pool);
+		if (allocation != VK_NULL_HANDLE) {
+			retire(*pool, allocation);
+			allocation = VK_NULL_HANDLE;
+		}
+	}
+	mesh.range = {};
+}
+
+void MeshRegistry::finishUpload(uint32_t meshId)
+{
+	//The registry was destroyed while the upload was queued
+	if (meshId >= meshes.size()) {
+		return;
+	}
+
+	MeshEntry& mesh = meshes[meshId];
+	mesh.isUploading = false;
+	uploadingCount--;
+
+	if (mesh.isRemoved) {
+		retireRanges(mesh);
+		return;
+	}
+	mesh.isUploaded = true;
+	isMeshTableDirty = true;
+}
+
+void MeshRegistry::flush(VkCommandBuffer commandBuffer)
+{
+	releaseRetired();
+
+	//Growing and defragmenting read ranges that copies of earlier frames wrote, those were only made visible to vertex input
+	if (!pending.empty() || vertexPool.isFragmented || indexPool.isFragmented || meshletPool.isFragmented) {
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+	}
+
+	bool isRecorded = false;
+
+	if (!pending.empty()) {
+		//Ranges first, growing moves every live mesh so the uploads below have to use the final offsets. Growing copies
+		//the old buffer on this queue and would miss uploads still on their way into it, a mesh that needs a larger pool
+		//waits until those went out. The meshes after it wait as well, so they can not keep the pool from growing
+		const uint64_t capacity = static_cast<uint64_t>(vertexPool.capacity) + indexPool.capacity + meshletPool.capacity;
+		const bool isGrowable = uploadingCount == 0;
+
+		std::vector<PendingMesh> waiting;
+		std::vector<PendingMesh> uploads;
+		for (auto& upload : pending) {
+			MeshEntry& mesh = meshes[upload.meshId];
+			if (mesh.isRemoved) {
+				continue;
+			}
+			if (waiting.empty() && allocate(mesh, isGrowable, commandBuffer)) {
+				uploads.push_back(std::move(upload));
+			}
+			else {
+				waiting.push_back(std::move(upload));
+			}
+		}
+
+		//Growing copied the live meshes
+		isRecorded = static_cast<uint64_t>(vertexPool.capacity) + indexPool.capacity + meshletPool.capacity != capacity;
+
+		//Each range streams through the upload engine's staging ring, the frames that acquire the submit sending a mesh's
+		//last range can draw it. Data is copied when it has to wait, the registry's cpu copies are freed once their other
+		//owners let go
+		for (const auto& upload : uploads) {
+			MeshEntry& mesh = meshes[upload.meshId];
+			const std::array<std::pair<Pool*, const void*>, 3> ranges = { {
+				{ &vertexPool, upload.vertices->data() },
+				{ &indexPool, upload.indices->data() },
+				{ &meshletPool, upload.meshlets->data() }
+			} };
+
+			std::vector<std::pair<Pool*, const void*>> parts;
+			for (const auto& range : ranges) {
+				if (getCount(mesh, *range.first) > 0) {
+					parts.push_back(range);
+				}
+			}
+			if (parts.empty()) {
+				mesh.isUploaded = true;
+				continue;
+			}
+
+			mesh.isUploading = true;
+			uploadingCount++;
+			for (size_t i = 0; i < parts.size(); ++i) {
+				Pool& pool = *parts[i].first;
+				const uint32_t meshId = upload.meshId;
+				//Uploads go out in order, once the last one did the others did too
+				std::function<void()> onSubmitted = nullptr;
+				if (i + 1 == parts.size()) {
+					onSubmitted = [this, meshId]() {
+						finishUpload(meshId);
+						};
+				}
+
+				//Growing and defragmentation copy uploaded ranges on the graphics queue
+				uploadEngine->uploadBuffer(*pool.buffer, pool.elementSize * getOffset(mesh, pool), parts[i].second, pool.elementSize * getCount(mesh, pool),
+					VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+					VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT, std::move(onSubmitted));
+			}
+		}
+
+		pending = std::move(waiting);
+	}
+
+	if (vertexPool.isFragmented || indexPool.isFragmented || meshletPool.isFragmented) {
+		//Defragmentation may read ranges written by the copies above
+		if (isRecorded) {
+			VkMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+		}
+
+		VkDeviceSize budget = defragmentBudget;
+		bool isMoved = defragment(vertexPool, budget, commandBuffer);
+		isMoved |= defragment(indexPool, budget, commandBuffer);
+		isMoved |= defragment(meshletPool, budget, commandBuffer);
+
+		isRecorded |= isMoved;
+		isMeshTableDirty |= isMoved;
+	}
+
+	if (isMeshTableDirty) {
+		writeMeshTable();
+	}
+
+	if (isRecorded) {
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+	}
+}
+
+void MeshRegistry::writeMeshTable()
+{
+	isMeshTableDirty = false;
+	if (meshes.empty()) {
+		return;
+	}
+
+	//Frames that bound an earlier version keep reading it, every version gets a buffer of its own
+	TableVersion& table = queuedTables.emplace_back();
+	table.version = ++tableVersion;
+	table.table = std::make_unique<Buffer>(vulkanResources);
+	table.table->initBuffer(sizeof(GpuMesh) * meshes.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+	table.vertexBuffer = vertexPool.buffer.get();
+	table.indexBuffer = indexPool.buffer.get();
+	table.meshletBuffer = meshletPool.buffer.get();
+	table.vertexCount = vertexPool.capacity;
+	table.indexCount = indexPool.capacity;
+	table.meshletCount = meshletPool.capacity;
+	table.meshCount = static_cast<uint32_t>(meshes.size());
+
+	//Ranges not uploaded yet or removed have no indices and are never drawn
+	std::vector<GpuMesh> data(meshes.size());
+	for (size_t meshId = 0; meshId < meshes.size(); ++meshId) {
+		const MeshEntry& mesh = meshes[meshId];
+		data[meshId] = {
+			.indexCount = mesh.isUploaded ? mesh.range.indexCount : 0,
+			.firstIndex = mesh.range.firstIndex,
+			.vertexOffset = mesh.range.vertexOffset,
+			.firstMeshlet = mesh.range.firstMeshlet,
+			.bounds = mesh.range.bounds,
+			.meshletCount = mesh.isUploaded ? mesh.range.meshletCount : 0,
+			.padding = { 0, 0, 0 }
+		};
+	}
+
+	const uint64_t version = table.version;
+	uploadEngine->uploadBuffer(*table.table, 0, data.data(), sizeof(GpuMesh) * data.size(), VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, [this, version]() {
+		bindTable(version);
+		});
+}
+
+void MeshRegistry::bindTable(uint64_t version)
+{
+	//Versions go out in order, a later one replaces the ones before it
+	while (!queuedTables.empty() && queuedTables.front().version <= version) {
+		if (boundTable.table) {
+			retire(std::move(boundTable.table), queuedTables.front().version);
+		}
+		boundTable = std::move(queuedTables.front());
+		queuedTables.pop_front();
+	}
+}
+
+bool MeshRegistry::allocate(MeshEntry& mesh, bool isGrowable, VkCommandBuffer commandBuffer)
+{
+	for (Pool* pool : { &vertexPool, &indexPool, &meshletPool }) {
+		const uint32_t count = getCount(mesh, *pool);
+		if (count == 0) {
+			continue;
+		}
+
+		uint32_t offset = 0;
+		if (!allocate(*pool, count, getAllocation(mesh, *pool), offset, isGrowable, commandBuffer)) {
+			//Nothing was written to the ranges taken so far
+			for (Pool* taken : { &vertexPool, &indexPool, &meshletPool }) {
+				VmaVirtualAllocation& allocation = getAllocation(mesh, *taken);
+				if (allocation != VK_NULL_HANDLE) {
+					vmaVirtualFree(taken->block, allocation);
+					allocation = VK_NULL_HANDLE;
+				}
+			}
+			return false;
+		}
+		setOffset(mesh, *pool, offset);
+	}
+
+	return true;
+}
+
+bool MeshRegistry::allocate(Pool& pool, uint32_t count, VmaVirtualAllocation& allocation, uint32_t& offset, bool isGrowable, VkCommandBuffer commandBuffer)
+{
+	VmaVirtualAllocationCreateInfo allocationInfo{};
+	allocationInfo.size = count;
+
+	VkDeviceSize virtualOffset = 0;
+	if (pool.block == VK_NULL_HANDLE || vmaVirtualAllocate(pool.block, &allocationInfo, &allocation, &virtualOffset) != VK_SUCCESS) {
+		if (!isGrowable) {
+			return false;
+		}
+
+		grow(pool, count, commandBuffer);
+		if (vmaVirtualAllocate(pool.block, &allocationInfo, &allocation, &virtualOffset) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to allocate mesh range");
+		}
+	}
+
+	offset = static_cast<uint32_t>(virtualOffset);
+	return true;
+}
+
+void MeshRegistry::grow(Pool& pool, uint32_t requiredCount, VkCommandBuffer commandBuffer)
+{
+	//Doubling keeps the number of reallocations (and gpu side copies) logarithmic in the scene size
+	uint32_t newCapacity = std::max({ pool.capacity * 2, pool.capacity + requiredCount, 1u << 16 });
+
+	std::unique_ptr<Buffer> oldBuffer = std::move(pool.buffer);
+	VmaVirtualBlock oldBlock = pool.block;
+
+	pool.buffer = std::make_unique<Buffer>(vulkanResources);
+	pool.buffer->initBuffer(pool.elementSize * newCapacity, pool.usage, VMA_MEMORY_USAGE_GPU_ONLY);
+
+	VmaVirtualBlockCreateInfo blockInfo{};
+	blockInfo.size = newCapacity;
+	if (vmaCreateVirtualBlock(&blockInfo, &pool.block) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create mesh pool block");
+	}
+
+	//Live ranges are packed to the front of the new block, which also drops any fragmentation. Meshes allocated
+	//earlier in this flush move too but have nothing to copy yet, nothing is uploading into the old buffer
+	std::vector<VkBufferCopy> regions;
+	for (auto& mesh : meshes) {
+		VmaVirtualAllocation& allocation = getAllocation(mesh, pool);
+		if (allocation == VK_NULL_HANDLE) {
+			continue;
+		}
+
+		VmaVirtualAllocationCreateInfo allocationInfo{};
+		allocationInfo.size = getCount(mesh, pool);
+
+		VkDeviceSize offset = 0;
+		if (vmaVirtualAllocate(pool.block, &allocationInfo, &allocation, &offset) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to allocate mesh range");
+		}
+
+		if (mesh.isUploaded) {
+			regions.push_back({ pool.elementSize * getOffset(mesh, pool), pool.elementSize * offset, pool.elementSize * allocationInfo.size });
+		}
+		setOffset(mesh, pool, static_cast<uint32_t>(offset));
+	}
+
+	if (!regions.empty()) {
+		vkCmdCopyBuffer(commandBuffer, oldBuffer->buffer, pool.buffer->buffer, static_cast<uint32_t>(regions.size()), regions.data());
+	}
+
+	//Retired ranges belonged to the old block, the old buffer is retired as a whole instead
+	std::erase_if(retired, [&pool](const Retired& entry) {
+		return entry.pool == &pool;
+		});
+
+	if (oldBlock != VK_NULL_HANDLE) {
+		vmaClearVirtualBlock(oldBlock);
+		vmaDestroyVirtualBlock(oldBlock);
+	}
+	if (oldBuffer) {
+		retire(std::move(oldBuffer), tableVersion + 1);
+	}
+
+	pool.capacity = newCapacity;
+	pool.isFragmented = false;
+	isMeshTableDirty = true;
+}
+
+bool MeshRegistry::defragment(Pool& pool, VkDeviceSize& budget, VkCommandBuffer commandBuffer)
+{
+	//Highest ranges first, each moves to the lowest free spot that fits it if that is lower than where it is.
+	//Sources and destinations are both allocated while copying, so no copy overlaps or reads another's output
+	std::vector<uint32_t> candidates;
+	for (uint32_t meshId = 0; meshId < meshes.size(); ++meshId) {
+		if (meshes[meshId].isUploaded && getAllocation(meshes[meshId], pool) != VK_NULL_HANDLE) {
+			candidates.push_back(meshId);
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(), [&](uint32_t a, uint32_t b) {
+		return getOffset(meshes[a], pool) > getOffset(meshes[b], pool);
+		});
+
+	std::vector<VkBufferCopy> regions;
+	bool isBudgetSpent = false;
+	for (uint32_t meshId : candidates) {
+		if (budget == 0) {
+			isBudgetSpent = true;
+			break;
+		}
+
+		MeshEntry& mesh = meshes[meshId];
+		VmaVirtualAllocationCreateInfo allocationInfo{};
+		allocationInfo.size = getCount(mesh, pool);
+		allocationInfo.flags = VMA_VIRTUAL_ALLOCATION_CREATE_STRATEGY_MIN_OFFSET_BIT;
+
+		VmaVirtualAllocation allocation = VK_NULL_HANDLE;
+		VkDeviceSize offset = 0;
+		if (vmaVirtualAllocate(pool.block, &allocationInfo, &allocation, &offset) != VK_SUCCESS) {
+			continue;
+		}
+		if (offset >= getOffset(mesh, pool)) {
+			vmaVirtualFree(pool.block, allocation);
+			continue;
+		}
+
+		VkDeviceSize size = pool.elementSize * allocationInfo.size;
+		regions.push_back({ pool.elementSize * getOffset(mesh, pool), pool.elementSize * offset, size });
+
+		retire(pool, getAllocation(mesh, pool));
+		getAllocation(mesh, pool) = allocation;
+		setOffset(mesh, pool, static_cast<uint32_t>(offset));
+
+		budget -= std::min(budget, size);
+	}
+
+	//Ranges freed by these moves set the flag again once they are released
+	pool.isFragmented = isBudgetSpent;
+
+	if (regions.empty()) {
+		return false;
+	}
+
+	vkCmdCopyBuffer(commandBuffer, pool.buffer->buffer, pool.buffer->buffer, static_cast<uint32_t>(regions.size()), regions.data());
+	return true;
+}
+
+void MeshRegistry::retire(Pool& pool, VmaVirtualAllocation allocation)
+{
+	retired.push_back({ .framesLeft = framesInFlight, .tableVersion = tableVersion + 1, .pool = &pool, .allocation = allocation });
+}
+
+void MeshRegistry::retire(std::unique_ptr<Buffer> buffer, uint64_t version)
+{
+	retired.push_back({ .framesLeft = framesInFlight, .tableVersion = version, .buffer = std::move(buffer) });
+}
+
+void MeshRegistry::releaseRetired()
+{
+	for (auto& entry : retired) {
+		//Frames still bind a table that refers to it
+		if (entry.tableVersion > boundTable.version) {
+			continue;
+		}
+
+		entry.framesLeft--;
+		if (entry.framesLeft == 0 && entry.allocation != VK_NULL_HANDLE) {
+			vmaVirtualFree(entry.pool->block, entry.allocation);
+			//The freed range is a hole unless it was the highest one, let defragmentation check
+			entry.pool->isFragmented = true;
+		}
+	}
+
+	//Buffers are destroyed with their entries
+	std::erase_if(retired, [](const Retired& entry) {
+		return entry.framesLeft == 0;
+		});
+}
+
+void MeshRegistry::bind(VkCommandBuffer commandBuffer)
+{
+	if (!boundTable.vertexBuffer || !boundTable.indexBuffer) {
+		return;
+	}
+
+	VkDeviceSize offset = 0;
+	vkCmdBindVertexBuffers(commandBuffer, 0, 1, &boundTable.vertexBuffer->buffer, &offset);
+	vkCmdBindIndexBuffer(commandBuffer, boundTable.indexBuffer->buffer, 0, VK_INDEX_TYPE_UINT32);
+}
+
+void MeshRegistry::destroyPool(Pool& pool)
+{
+	if (pool.block != VK_NULL_HANDLE) {
+		vmaClearVirtualBlock(pool.block);
+		vmaDestroyVirtualBlock(pool.block);
+		pool.block = VK_NULL_HANDLE;
+	}
+	pool.buffer.reset();
+	pool.capacity = 0;
+	pool.isFragmented = false;
+}
+
+void MeshRegistry::destroyMeshRegistry()
+{
+	retired.clear();
+	destroyPool(vertexPool);
+	destroyPool(indexPool);
+	destroyPool(meshletPool);
+	queuedTables.clear();
+	boundTable = {};
+	tableVersion = 0;
+	isMeshTableDirty = false;
+	meshes.clear();
+	pending.clear();
+	registered.clear();
+	uploadingCount = 0;
+}
@@ -0,0 +1,263 @@
+#pragma once
+#include "../Helper/Helper.h"
+
+#include <unordered_map>
+#include <memory>
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include "../Abstractions/Buffer/Buffer.h"
+#include "../Abstractions/Buffer/VertexBuffer/VertexBuffer.h"
+#include "../Abstractions/Buffer/IndexBuffer/IndexBuffer.h"
+#include "../UploadEngine/UploadEngine.h"
+#include "Meshlet/Meshlet.h"
+
+
+//Scene geometry shared by every draw. Each mesh lives in a range of one vertex and one index buffer and is
+//referred to by its id. Ranges are suballocated from VMA virtual blocks (counted in elements, not bytes),
+//so meshes can be added and removed while rendering. Indices stay local to their mesh, draws add vertexOffset.
+//Geometry streams through the upload engine, growing and defragmentation are recorded into the frame's command
+//buffer, nothing waits.
+//A table of every mesh's range and bounds is kept on the gpu as well, so draws can be built by shaders. Every version
+//of it goes through the upload engine into a buffer of its own, frames bind the last version that was sent together
+//with the pools it describes. Ranges and buffers a version stops using are kept until frames in flight are done.
+//Every mesh also has a range of meshlets in a third pool, and the index pool can be read as a storage buffer
+class MeshRegistry
+{
+public:
+
+	struct MeshRange {
+		uint32_t firstIndex = 0;
+		uint32_t indexCount = 0;
+		int32_t vertexOffset = 0;
+		uint32_t vertexCount = 0;
+		uint32_t firstMeshlet = 0;
+		uint32_t meshletCount = 0;
+		//Local space bounding sphere, center in xyz and radius in w
+		glm::vec4 bounds{ 0.0f };
+	};
+
+	//Mesh table entry, matches MeshData in the culling shader
+	struct GpuMesh {
+		uint32_t indexCount;
+		uint32_t firstIndex;
+		int32_t vertexOffset;
+		uint32_t firstMeshlet;
+		glm::vec4 bounds;
+		uint32_t meshletCount;
+		uint32_t padding[3];
+	};
+
+	MeshRegistry(VulkanResources& vulkanResources);
+	MeshRegistry(const MeshRegistry&) = delete;
+	MeshRegistry& operator=(const MeshRegistry&) = delete;
+	~MeshRegistry();
+
+	//framesInFlight: how many flushes a freed range or replaced buffer is kept before it is reused, counted from
+	//the submit that sent the first mesh table without it
+	void initMeshRegistry(UploadEngine& uploadEngine, uint32_t framesInFlight, VkDeviceSize defragmentBudget = 4 * 1024 * 1024);
+
+	//Returns the mesh id, the data is queued on the upload engine at the next flush and drawn once a mesh table sent
+	//after it was bound. A mesh that needs a larger pool waits for the uploads in flight first. Adding geometry
+	//that is already registered (same vertex and index arrays) returns the existing id.
+	//Meshlets are normally built at import, they are built here when there are none
+	uint32_t add(const std::shared_ptr<Vertices>& vertices, const std::shared_ptr<Indices>& indices, std::shared_ptr<Meshlets> meshlets = nullptr);
+
+	//The mesh draws nothing from now on, its ranges are reused once frames in flight are done with them.
+	//Ids are not reused, a stale id stays empty
+	void remove(uint32_t meshId);
+
+	//Queues uploads and the mesh table update on the upload engine and records buffer growth and a budgeted
+	//defragmentation step. Call once per frame after the upload engine's acquire, outside of a render pass and before
+	//the draws. Ends with a barrier that makes the moved geometry visible to vertex input and compute shaders
+	void flush(VkCommandBuffer commandBuffer);
+
+	void bind(VkCommandBuffer commandBuffer);
+	void destroyMeshRegistry();
+
+	//Ranges can move during flush (growing, defragmentation), read them when recording draws
+	const MeshRange& getMesh(uint32_t meshId) const {
+		return meshes[meshId].range;
+	}
+
+	//Capacities of the bound pools, every range of the bound table lies inside
+	uint32_t getVertexCount() const {
+		return boundTable.vertexCount;
+	}
+
+	uint32_t getIndexCount() const {
+		return boundTable.indexCount;
+	}
+
+	uint32_t getMeshletCount() const {
+		return boundTable.meshletCount;
+	}
+
+	//The pools the bound table refers to, valid once getMeshTable is not null
+	Buffer& getVertexBuffer() {
+		return *boundTable.vertexBuffer;
+	}
+
+	Buffer& getIndexBuffer() {
+		return *boundTable.indexBuffer;
+	}
+
+	//Null until the first mesh with meshlets was flushed
+	Buffer* getMeshletBuffer() {
+		return boundTable.meshletBuffer;
+	}
+
+	//GpuMesh per mesh id of the last version the upload engine sent, null until the first one went out. It and the
+	//pools change at the upload engine's submit, read them after it
+	Buffer* getMeshTable() {
+		return boundTable.table.get();
+	}
+
+	uint32_t getMeshCount() const {
+		return static_cast<uint32_t>(meshes.size());
+	}
+
+	//Entries of the bound table, meshes added after it was written are not in it yet
+	uint32_t getTableMeshCount() const {
+		return boundTable.meshCount;
+	}
+
+private:
+
+	struct Pool {
+		std::unique_ptr<Buffer> buffer;
+		VmaVirtualBlock block = VK_NULL_HANDLE;
+		uint32_t capacity = 0;
+		VkDeviceSize elementSize = 0;
+		VkBufferUsageFlags usage = 0;
+		//Set when a range is freed, cleared once defragmentation finds nothing left to move
+		bool isFragmented = false;
+	};
+
+	struct MeshEntry {
+		MeshRange range;
+		VmaVirtualAllocation vertexAllocation = VK_NULL_HANDLE;
+		VmaVirtualAllocation indexAllocation = VK_NULL_HANDLE;
+		VmaVirtualAllocation meshletAllocation = VK_NULL_HANDLE;
+		const Vertices* key = nullptr;
+		//Queued on the upload engine, its ranges stay allocated until the last one went out
+		bool isUploading = false;
+		bool isUploaded = false;
+		bool isRemoved = false;
+	};
+
+	struct PendingMesh {
+		uint32_t meshId;
+		std::shared_ptr<Vertices> vertices;
+		std::shared_ptr<Indices> indices;
+		std::shared_ptr<Meshlets> meshlets;
+	};
+
+	struct RegisteredGeometry {
+		std::weak_ptr<Vertices> vertices;
+		std::weak_ptr<Indices> indices;
+		uint32_t meshId;
+	};
+
+	//Things the gpu may still read, released framesInFlight flushes after table version tableVersion was sent
+	struct Retired {
+		uint32_t framesLeft;
+		uint64_t tableVersion = 0;
+		Pool* pool = nullptr;
+		VmaVirtualAllocation allocation = VK_NULL_HANDLE;
+		std::unique_ptr<Buffer> buffer;
+	};
+
+	//A mesh table and the pools its ranges lie in
+	struct TableVersion {
+		uint64_t version = 0;
+		std::unique_ptr<Buffer> table;
+		Buffer* vertexBuffer = nullptr;
+		Buffer* indexBuffer = nullptr;
+		Buffer* meshletBuffer = nullptr;
+		uint32_t vertexCount = 0;
+		uint32_t indexCount = 0;
+		uint32_t meshletCount = 0;
+		uint32_t meshCount = 0;
+	};
+
+	void initPool(Pool& pool, VkDeviceSize elementSize, VkBufferUsageFlags usage);
+	void destroyPool(Pool& pool);
+
+	//Every range of the mesh or none. Offsets in elements, grows a pool (copying live meshes into the new buffer) when
+	//it is full and isGrowable
+	bool allocate(MeshEntry& mesh, bool isGrowable, VkCommandBuffer commandBuffer);
+	bool allocate(Pool& pool, uint32_t count, VmaVirtualAllocation& allocation, uint32_t& offset, bool isGrowable, VkCommandBuffer commandBuffer);
+	void grow(Pool& pool, uint32_t requiredCount, VkCommandBuffer commandBuffer);
+	bool defragment(Pool& pool, VkDeviceSize& budget, VkCommandBuffer commandBuffer);
+	//Queues a new version of the table, it is bound from the submit that sends it on
+	void writeMeshTable();
+	void bindTable(uint64_t version);
+
+	VmaVirtualAllocation& getAllocation(MeshEntry& mesh, const Pool& pool) {
+		if (&pool == &vertexPool) {
+			return mesh.vertexAllocation;
+		}
+		return &pool == &indexPool ? mesh.indexAllocation : mesh.meshletAllocation;
+	}
+
+	uint32_t getOffset(const MeshEntry& mesh, const Pool& pool) const {
+		if (&pool == &vertexPool) {
+			return static_cast<uint32_t>(mesh.range.vertexOffset);
+		}
+		return &pool == &indexPool ? mesh.range.firstIndex : mesh.range.firstMeshlet;
+	}
+
+	uint32_t getCount(const MeshEntry& mesh, const Pool& pool) const {
+		if (&pool == &vertexPool) {
+			return mesh.range.vertexCount;
+		}
+		return &pool == &indexPool ? mesh.range.indexCount : mesh.range.meshletCount;
+	}
+
+	void setOffset(MeshEntry& mesh, const Pool& pool, uint32_t offset) {
+		if (&pool == &vertexPool) {
+			mesh.range.vertexOffset = static_cast<int32_t>(offset);
+		}
+		else if (&pool == &indexPool) {
+			mesh.range.firstIndex = offset;
+		}
+		else {
+			mesh.range.firstMeshlet = offset;
+		}
+	}
+
+	//Kept until the next table version, the first one that no longer refers to them, was sent
+	void retire(Pool& pool, VmaVirtualAllocation allocation);
+	void retire(std::unique_ptr<Buffer> buffer, uint64_t version);
+	void retireRanges(MeshEntry& mesh);
+	//Runs when the submit sending the mesh's last range went out
+	void finishUpload(uint32_t meshId);
+	void releaseRetired();
+
+	Pool vertexPool;
+	Pool indexPool;
+	Pool meshletPool;
+
+	//Versions queued on the upload engine, oldest first, and the last one it sent
+	std::deque<TableVersion> queuedTables;
+	TableVersion boundTable;
+	uint64_t tableVersion = 0;
+	//Set whenever a range changes, the whole table is rewritten at the next flush
+	bool isMeshTableDirty = false;
+
+	std::vector<MeshEntry> meshes;
+	std::vector<PendingMesh> pending;
+	//Meshes whose last upload was not sent yet
+	uint32_t uploadingCount = 0;
+	std::vector<Retired> retired;
+
+	//Keyed by the vertex array. The weak pointers tell whether the address still belongs to the same data
+	std::unordered_map<const Vertices*, RegisteredGeometry> registered;
+
+	UploadEngine* uploadEngine = nullptr;
+	uint32_t framesInFlight = 2;
+	VkDeviceSize defragmentBudget = 0;
+
+	VulkanResources& vulkanResources;
+};
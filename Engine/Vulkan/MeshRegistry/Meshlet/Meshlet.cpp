@@ -0,0 +1,105 @@
+#include "Meshlet.h"
+
+static void finishMeshlet(Meshlet& meshlet, const Vertices& vertices, const Indices& indices)
+{
+	const uint32_t* triangles = indices.data() + meshlet.firstIndex;
+	uint32_t indexCount = meshlet.triangleCount * 3;
+
+	//Sphere around the center of the bounding box, like the mesh bounds
+	glm::vec3 minimum = vertices[triangles[0]].pos;
+	glm::vec3 maximum = minimum;
+	for (uint32_t i = 0; i < indexCount; ++i) {
+		minimum = glm::min(minimum, vertices[triangles[i]].pos);
+		maximum = glm::max(maximum, vertices[triangles[i]].pos);
+	}
+
+	glm::vec3 center = (minimum + maximum) * 0.5f;
+	float radius = 0.0f;
+	for (uint32_t i = 0; i < indexCount; ++i) {
+		radius = std::max(radius, glm::length(vertices[triangles[i]].pos - center));
+	}
+	meshlet.bounds = glm::vec4(center, radius);
+
+	//Normals of the winding the g-buffer treats as front facing, degenerate triangles have none
+	std::vector<glm::vec3> normals;
+	normals.reserve(meshlet.triangleCount);
+	glm::vec3 axis{ 0.0f };
+	for (uint32_t i = 0; i < indexCount; i += 3) {
+		glm::vec3 a = vertices[triangles[i + 0]].pos;
+		glm::vec3 b = vertices[triangles[i + 1]].pos;
+		glm::vec3 c = vertices[triangles[i + 2]].pos;
+
+		glm::vec3 normal = glm::cross(b - a, c - a);
+		float length = glm::length(normal);
+		if (length > 0.0f) {
+			normals.push_back(normal / length);
+			axis += normal / length;
+		}
+	}
+
+	float axisLength = glm::length(axis);
+	if (normals.empty() || axisLength == 0.0f) {
+		return;
+	}
+	axis /= axisLength;
+
+	float minimumDot = 1.0f;
+	for (const glm::vec3& normal : normals) {
+		minimumDot = std::min(minimumDot, glm::dot(axis, normal));
+	}
+
+	//A cone of half a sphere or wider always has a triangle facing the camera
+	float cutoff = minimumDot <= 0.0f ? 1.0f : std::sqrt(1.0f - minimumDot * minimumDot);
+	meshlet.cone = glm::vec4(axis, cutoff);
+}
+
+Meshlets buildMeshlets(const Vertices& vertices, const Indices& indices)
+{
+	Meshlets meshlets;
+	if (vertices.empty() || indices.size() < 3) {
+		return meshlets;
+	}
+
+	//Meshlet that last counted each vertex, so a vertex shared inside a meshlet is counted once
+	std::vector<uint32_t> owners(vertices.size(), UINT32_MAX);
+	uint32_t vertexCount = 0;
+	Meshlet meshlet{};
+
+	uint32_t triangleIndexCount = static_cast<uint32_t>(indices.size() / 3 * 3);
+	for (uint32_t i = 0; i < triangleIndexCount; i += 3) {
+		uint32_t meshletId = static_cast<uint32_t>(meshlets.size());
+
+		uint32_t newVertices = 0;
+		for (uint32_t corner = 0; corner < 3; ++corner) {
+			uint32_t index = indices[i + corner];
+			bool isRepeated = (corner > 0 && index == indices[i]) || (corner > 1 && index == indices[i + 1]);
+			if (owners[index] != meshletId && !isRepeated) {
+				newVertices++;
+			}
+		}
+
+		if (meshlet.triangleCount == Meshlet::MAX_TRIANGLES || vertexCount + newVertices > Meshlet::MAX_VERTICES) {
+			finishMeshlet(meshlet, vertices, indices);
+			meshlets.push_back(meshlet);
+
+			meshletId++;
+			meshlet = {};
+			meshlet.firstIndex = i;
+			vertexCount = 0;
+		}
+
+		for (uint32_t corner = 0; corner < 3; ++corner) {
+			uint32_t index = indices[i + corner];
+			if (owners[index] != meshletId) {
+				owners[index] = meshletId;
+				vertexCount++;
+			}
+		}
+		meshlet.triangleCount++;
+	}
+
+	finishMeshlet(meshlet, vertices, indices);
+	meshlets.push_back(meshlet);
+
+	return meshlets;
+}
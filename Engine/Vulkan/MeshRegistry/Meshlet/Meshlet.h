@@ -0,0 +1,27 @@
+#pragma once
+#include "../../Helper/Helper.h"
+
+#include "../../Abstractions/Buffer/VertexBuffer/VertexBuffer.h"
+#include "../../Abstractions/Buffer/IndexBuffer/IndexBuffer.h"
+
+
+//Cluster of a mesh's triangles, culled on its own. Matches Meshlet in the culling shaders
+struct Meshlet {
+	static constexpr uint32_t MAX_VERTICES = 64;
+	static constexpr uint32_t MAX_TRIANGLES = 124;
+
+	//Local space bounding sphere, center in xyz and radius in w
+	glm::vec4 bounds{ 0.0f };
+	//Average triangle normal in xyz, sine of the widest angle to it in w. 1 when the triangles can never all face away
+	glm::vec4 cone{ 0.0f, 0.0f, 0.0f, 1.0f };
+	//Relative to the mesh's first index, the meshlet's triangles are a contiguous run of its indices
+	uint32_t firstIndex = 0;
+	uint32_t triangleCount = 0;
+	uint32_t padding[2] = { 0, 0 };
+};
+
+using Meshlets = std::vector<Meshlet>;
+
+//Splits the triangles in index order, a meshlet ends when the next triangle would take it over either limit.
+//Leaves the indices as they are, so meshlets only need offsets into the mesh
+Meshlets buildMeshlets(const Vertices& vertices, const Indices& indices);
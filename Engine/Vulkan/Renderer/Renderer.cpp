@@ -8,35 +8,40 @@ Renderer::Renderer(VulkanContext& vulkanContext) : vulkanContext{ vulkanContext
 
 void Renderer::init()
 {
+	if (maxFramesInFlight < 1 || maxFramesInFlight > MAX_FRAMES_IN_FLIGHT) {
+		throw std::runtime_error("Frames in flight must be between 1 and " + std::to_string(MAX_FRAMES_IN_FLIGHT));
+	}
+
 	graphicsCommandPool.initCommandPool(vulkanContext.device.getQueueIndex(vkb::QueueType::graphics));
 	swapchain.initSwapchain();
-	initUniformBuffers();
-	initStorageBuffers();
+	initFrameRing();
 	initCommandBuffers();
 	initSyncObjects();
+	uploadEngine.initUploadEngine(vulkanContext.device.transferQueue, vulkanContext.device.transferQueueIndex, vulkanContext.device.getQueueIndex(vkb::QueueType::graphics), uploadStagingSize);
+	meshRegistry.initMeshRegistry(uploadEngine, maxFramesInFlight);
+	asyncCompute.initAsyncCompute(vulkanContext.device.computeQueue, vulkanContext.device.computeQueueIndex, vulkanContext.device.getQueueIndex(vkb::QueueType::graphics));
 
 	initSampler();
 
 	initSwapchainRenderPass();
 	initGBufferPass();
 	initLightingPass();
-	initPreprocessIBLPasses();
 
 	initSwapchainResources();
 	initGBufferResources();
 	initLightingResources();
 	initPreprocessIBLResources();
 
-	descriptorManager.initDescriptorManager();
+	descriptorManager.initDescriptorManager(maxFramesInFlight);
 	initSwapchainPipeline();
+	initCullingPipeline();
+	initDrawBuffers();
+	initHiZResources();
 	initGBufferPipeline();
 	initSkyboxPipeline();
 	initLightingPipeline();
 	initPreprocessIBLPipelines();
 
-	size_t maxImageSize = 4096 * 4096 * 4;
-	stagingBuffer.initStagingBuffer(maxImageSize);
-	
 
 	bindDescriptors();
 }
@@ -73,20 +78,25 @@ void Renderer::destroy()
 			vkDestroySemaphore(vulkanContext.vulkanResources.device, renderFinishedSemaphores[i], nullptr);
 			renderFinishedSemaphores[i] = VK_NULL_HANDLE;
 		}
-		if (inFlightFences[i] != VK_NULL_HANDLE) {
-			vkDestroyFence(vulkanContext.vulkanResources.device, inFlightFences[i], nullptr);
-			inFlightFences[i] = VK_NULL_HANDLE;
-		}
 	}
 	imageAvailableSemaphores.clear();
 	renderFinishedSemaphores.clear();
-	inFlightFences.clear();
+	//The device is idle, whatever waits for a frame can go now
+	frameTimeline.destroyTimeline();
+	frameValues.clear();
 
 	// Free command buffers (safe because device is idle)
+	for (auto& secondaries : gBufferCommandBuffers) {
+		for (auto& cb : secondaries) {
+			cb.free();
+		}
+	}
+	gBufferCommandBuffers.clear();
 	for (auto& cb : commandBuffers) {
 		cb.free();
 	}
 	commandBuffers.clear();
+	frameCommandPools.clear();
 
 	// Descriptor set layout and sampler
 	
@@ -106,24 +116,32 @@ void Renderer::destroy()
 
 	// Destroy image views / images (Image::destroyImage should also be safe / idempotent)
 
-	gBufferAlbedoImage.destroyImage();
-	gBufferNormalImage.destroyImage();
-	gBufferMaterialImage.destroyImage();
-	gBufferDepthImage.destroyImage();
-	lightingImage.destroyImage();
 	for (auto& image : images) {
 		delete image;
 	}
-
-	// Destroy framebuffers (idempotent)
-	gBufferFramebuffer.destroyFrameBuffer();
-	lightingFramebuffer.destroyFrameBuffer();
-
-	// Destroy swapchain image views
-	if (!swapchainImageViews.empty()) {
-		swapchain.swapchain.destroy_image_views(swapchainImageViews);
-		swapchainImageViews.clear();
-	}
+	defaultTexture = nullptr;
+	skyboxImage = nullptr;
+	isEnvironmentReady = false;
+
+	meshRegistry.destroyMeshRegistry();
+	frameRing.destroyRingBuffer();
+	drawCommandBuffers.clear();
+	drawCountBuffers.clear();
+	instanceBuffers.clear();
+	batchCountBuffers.clear();
+	visibleInstanceBuffers.clear();
+	meshletDispatchBuffers.clear();
+	drawIndexBuffers.clear();
+	drawIndexCapacities.clear();
+	meshletMaskBuffers.clear();
+	meshletMaskCapacities.clear();
+	visibilityBuffer.reset();
+	cullingPipeline.destroyPipeline();
+	meshletPipeline.destroyPipeline();
+	drawBatchPipeline.destroyPipeline();
+	hiZPipeline.destroyPipeline();
+
+	destroySwapchainResources();
 
 	// mark other RAII-managed resources left to their destructors
 
@@ -137,7 +155,12 @@ Renderer::~Renderer()
 
 bool Renderer::beginFrame()
 {
-	vkWaitForFences(vulkanContext.vulkanResources.device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+	//Waits for the last submit that used this frame's slot, not for the frames after it
+	if (!frameTimeline.wait(frameValues[currentFrame], FRAME_TIMEOUT)) {
+		throw std::runtime_error("Timed out waiting for a frame in flight");
+	}
+	frameTimeline.collect();
+	uploadEngine.collect();
 
 	auto result = vkAcquireNextImageKHR(vulkanContext.vulkanResources.device, swapchain.swapchain.swapchain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
 	if (result == VK_ERROR_OUT_OF_DATE_KHR) {
@@ -148,10 +171,11 @@ bool Renderer::beginFrame()
 		throw std::runtime_error("ahh");
 	}
 
-	vkResetFences(vulkanContext.vulkanResources.device, 1, &inFlightFences[currentFrame]);
-
 
-	vkResetCommandBuffer(commandBuffers[currentFrame].commandBuffer, 0);
+	//Everything recorded for this frame last time has finished, its pools are reset as a whole
+	for (auto& pool : frameCommandPools[currentFrame]) {
+		pool.reset();
+	}
 
 	return true;
 }
@@ -161,6 +185,12 @@ void Renderer::submit(ECS& ecs, Camera& camera)
 
 	commandBuffers[currentFrame].begin();
 
+	//Uploads recorded since the last frame go out now, this frame waits for them on the gpu only
+	uploadEngine.submit();
+	CommandBuffer::SemaphoreWait uploadWait = uploadEngine.acquire(commandBuffers[currentFrame].commandBuffer);
+	//Compute jobs that finished since the last frame are handed back, the ones still running are not waited for
+	CommandBuffer::SemaphoreWait computeWait = asyncCompute.acquire(commandBuffers[currentFrame].commandBuffer);
+
 	//if (handleResourcesUpload(resourceManager, commandBuffers[currentFrame].commandBuffer)) {
 	//	commandBuffers[currentFrame].end();
 	//	//Submit
@@ -168,125 +198,77 @@ void Renderer::submit(ECS& ecs, Camera& camera)
 	//	return;
 	//};
 
-	//Processing scene
-	uint32_t currentVertexOffset = 0;
-	uint32_t currentIndexOffset = 0;
-	uint32_t uboIndex = 0;
-	drawInfos.clear();
-	lightInfos.clear();
-	drawInfos.reserve(ecs.getEntityCount());
-	lightInfos.reserve(ecs.getEntityCount());
-	batchedVertices.clear();
-	batchedIndices.clear();
-
-	ecs.onEachEntity([&](std::shared_ptr<Entity> entity) {
-		const auto& l = ecs.getComponent<Light>(entity);
-		if (l) {
-			lightInfos.push_back({
-				.type = l->type,
-				.direction = l->direction,
-				.position = l->position,
-				.color = l->color
-				});
-			return;
-		}
-		const auto& t = ecs.getComponent<Transform>(entity);
-		const auto& m = ecs.getComponent<Mesh>(entity);
-		const auto& ma = ecs.getComponent<Material>(entity);
-
-		drawInfos.push_back({
-			.indexCount = static_cast<uint32_t>(m->indices->size()),
-			.firstIndex = currentIndexOffset,
-			.vertexOffset = 0,
-			.ssboIndex = uboIndex++,
-			.transform = t,
-			.material = ma
-			});
-
-		batchedVertices.insert(batchedVertices.end(), m->vertices->begin(), m->vertices->end());
-		for (size_t i = 0; i < m->indices->size(); ++i) {
-			batchedIndices.push_back((*m->indices)[i] + currentVertexOffset);
-		}
-		currentVertexOffset += m->vertices->size();
-		currentIndexOffset += m->indices->size();
-		});
-
-	if (!isMainVertexBufferInitialized) {
-		mainVertexBuffer.initVertexBuffer(std::make_shared<Vertices>(batchedVertices), vulkanContext.device.graphicsQueue, graphicsCommandPool.commandPool);
-		mainIndexBuffer.initIndexBuffer(std::make_shared<Indices>(batchedIndices), vulkanContext.device.graphicsQueue, graphicsCommandPool.commandPool);
-		isMainVertexBufferInitialized = true;
-	}
-	
-
+	//beginFrame waited for this frame's last submit, so its region of the ring can be written again
+	frameRing.beginFrame(currentFrame);
 
-	mainVertexBuffer.bind(commandBuffers[currentFrame].commandBuffer);
-	mainIndexBuffer.bind(commandBuffers[currentFrame].commandBuffer);
-
-
-	//Updating UBOs and SSBOs
-	descriptorManager.globalDescriptorSet.update(DescriptorManager::GLOBAL_BINDING::GLOBAL_UBO, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, { globalUniformBuffers[currentFrame].buffer, 0, VK_WHOLE_SIZE });
-	descriptorManager.globalDescriptorSet.update(DescriptorManager::GLOBAL_BINDING::OBJECT_SSBO, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, { objectStorageBuffers[currentFrame].buffer, 0, VK_WHOLE_SIZE });
-	descriptorManager.globalDescriptorSet.update(DescriptorManager::GLOBAL_BINDING::LIGHTING_SSBO, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, { lightStorageBuffers[currentFrame].buffer, 0, VK_WHOLE_SIZE });
-
-	//Writing to UBOs and SSBOs
-	{
-		std::vector<objectSSBO> ssbo(1000);
-		for (int i = 0; i < drawInfos.size(); ++i) {
-			auto& drawInfo = drawInfos[i];
-			ssbo[i] = {
-				.model = drawInfo.transform->transformationMatrix(),
-				.albedoIndex = drawInfo.material->albedoIndex,
-				.roughnessIndex = drawInfo.material->roughnessIndex,
-				.normalIndex = drawInfo.material->normalIndex,
-				.occlusionIndex = drawInfo.material->occlusionIndex,
-				.emissiveIndex = drawInfo.material->emissiveIndex
-			};
+	//Processing scene
+	updateScene(ecs);
+	sortDraws(ecs, camera, DrawKey::ORDER::STATE);
 
-		}
+	//New geometry goes to the upload engine, growth and defragmentation of the pools are recorded ahead of this frame's draws
+	meshRegistry.flush(commandBuffers[currentFrame].commandBuffer);
 
-		/*for (size_t i = 0; i < std::min<size_t>(drawInfos.size(), 8); ++i) {
-			auto& d = drawInfos[i];
-			std::cout << "[SSBO] draw=" << d.ssboIndex
-				<< " albedo=" << d.material->albedoIndex
-				<< " normal=" << d.material->normalIndex
-				<< " roughness=" << d.material->roughnessIndex
-				<< " occlusion=" << d.material->occlusionIndex
-				<< " emissive=" << d.material->emissiveIndex
-				<< "\n";
-		}*/
-
-		objectStorageBuffers[currentFrame].copy(sizeof(objectSSBO) * ssbo.size(), ssbo.data());
-	}
 
+	//Writing to UBOs and SSBOs, straight into this frame's region of the ring
 	{
-		std::vector<lightSSBO> ssbo(100);
-		for (int i = 0; i < lightInfos.size(); ++i) {
-			ssbo[i] = {
-				.lightType = glm::vec4(lightInfos[i].type, 0.0f, 0.0f, 0.0f),
-				.lightDir = lightInfos[i].direction,
-				.lightPos = lightInfos[i].position,
-				.lightColor = lightInfos[i].color
-			};
-		}
+		RingBuffer::Allocation uboAllocation = frameRing.allocate(sizeof(globalUBO));
+		globalOffsets[DescriptorManager::GLOBAL_OFFSET::GLOBAL_UBO_OFFSET] = uboAllocation.offset;
 
-		lightStorageBuffers[currentFrame].copy(sizeof(lightSSBO) * ssbo.size(), ssbo.data());
-	}
-
-	{
-		globalUBO ubo{
+		*static_cast<globalUBO*>(uboAllocation.data) = {
 			.view = camera.getViewMatrix(),
 			.projection = camera.getProjectionMatrix(),
 			.camPos = glm::vec4(camera.position, 0.0f),
 			.dimensions = glm::vec4(static_cast<float>(swapchain.swapchain.extent.width), static_cast<float>(swapchain.swapchain.extent.height), 0.0f, 0.0f),
 			.inverseProjection = camera.getInverseProjectionMatrix(),
 			.inverseView = camera.getInverseViewMatrix(),
-			.numberOfEntities = glm::vec4(drawInfos.size(), lightInfos.size(), 0.0f, 0.0f)
+			.numberOfEntities = glm::vec4(objectCount, lightCount, 0.0f, 0.0f)
 		};
 
-		globalUniformBuffers[currentFrame].copy(sizeof(ubo), &ubo);
+		frameRing.flush();
 	}
 
-	
+	glm::mat4 viewProjection = camera.getProjectionMatrix() * camera.getViewMatrix();
+	updateCullingDescriptors();
+
+	//The g-buffer's secondaries only depend on what is bound, so they are recorded on the job system
+	//while the culling commands are recorded here. Every batch has one instanced draw
+	uint32_t drawCount = static_cast<uint32_t>(drawBatches.size());
+	uint32_t jobCount = std::min(recordingJobCount, (drawCount + MIN_DRAWS_PER_RECORDING_JOB - 1) / MIN_DRAWS_PER_RECORDING_JOB);
+	auto recordJob = [this, drawCount, jobCount](uint32_t job) {
+		uint32_t firstDraw = static_cast<uint32_t>(static_cast<uint64_t>(drawCount) * job / jobCount);
+		uint32_t endDraw = static_cast<uint32_t>(static_cast<uint64_t>(drawCount) * (job + 1) / jobCount);
+		recordGBufferCommands(job, firstDraw, endDraw - firstDraw);
+		};
+
+	JobSystem::Counter recordingCounter;
+	if (jobSystem) {
+		for (uint32_t job = 0; job < jobCount; ++job) {
+			jobSystem->submit([recordJob, job] { recordJob(job); }, recordingCounter);
+		}
+	}
+
+	//Jobs reference the counter, so they have to finish before an exception leaves this frame
+	std::exception_ptr exception;
+	try {
+		if (!jobSystem) {
+			for (uint32_t job = 0; job < jobCount; ++job) {
+				recordJob(job);
+			}
+		}
+
+		//Culling on the gpu, builds the draws of what was visible last frame
+		recordCulling(commandBuffers[currentFrame].commandBuffer, viewProjection, CULLING_PHASE::EARLY);
+	}
+	catch (...) {
+		exception = std::current_exception();
+	}
+
+	if (jobSystem) {
+		jobSystem->wait(recordingCounter);
+	}
+	if (exception) {
+		std::rethrow_exception(exception);
+	}
 
 
 
@@ -311,39 +293,63 @@ void Renderer::submit(ECS& ecs, Camera& camera)
 	scissor.extent = swapchain.swapchain.extent;
 
 
-	//G-Buffer Pass
-	VkRenderPassBeginInfo gBufferRenderPassBeginInfo{};
-	gBufferRenderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	gBufferRenderPassBeginInfo.renderPass = gBufferRenderPass.renderPass;
-	gBufferRenderPassBeginInfo.framebuffer = gBufferFramebuffer.framebuffer;
-	gBufferRenderPassBeginInfo.renderArea.offset = { 0,0 };
-	gBufferRenderPassBeginInfo.renderArea.extent = swapchain.swapchain.extent;
-	gBufferRenderPassBeginInfo.clearValueCount = 5;
-	gBufferRenderPassBeginInfo.pClearValues = clearColors;
-
-	vkCmdBeginRenderPass(commandBuffers[currentFrame].commandBuffer, &gBufferRenderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-	vkCmdBindPipeline(commandBuffers[currentFrame].commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, gBufferPipeline.pipeline);
-	vkCmdSetViewport(commandBuffers[currentFrame].commandBuffer, 0, 1, &viewport);
-	vkCmdSetScissor(commandBuffers[currentFrame].commandBuffer, 0, 1, &scissor);
-
-	std::array<VkDescriptorSet, 2> gBufferSets{
-		descriptorManager.globalDescriptorSet.descriptorSet,
-		descriptorManager.bindlessResourceDescriptorSet.descriptorSet,
+	//G-Buffer Pass, once per culling phase. The late one loads what the early one drew
+	std::vector<VkCommandBuffer> gBufferSecondaries(jobCount);
+	auto recordGBufferPass = [&](VkRenderPass renderPass, CULLING_PHASE phase) {
+		VkRenderPassBeginInfo gBufferRenderPassBeginInfo{};
+		gBufferRenderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		gBufferRenderPassBeginInfo.renderPass = renderPass;
+		gBufferRenderPassBeginInfo.framebuffer = gBufferFramebuffer.framebuffer;
+		gBufferRenderPassBeginInfo.renderArea.offset = { 0,0 };
+		gBufferRenderPassBeginInfo.renderArea.extent = swapchain.swapchain.extent;
+		gBufferRenderPassBeginInfo.clearValueCount = 5;
+		gBufferRenderPassBeginInfo.pClearValues = clearColors;
+
+		vkCmdBeginRenderPass(commandBuffers[currentFrame].commandBuffer, &gBufferRenderPassBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+		if (jobCount > 0) {
+			for (uint32_t job = 0; job < jobCount; ++job) {
+				gBufferSecondaries[job] = gBufferCommandBuffers[currentFrame][job * 2 + phase].commandBuffer;
+			}
+			vkCmdExecuteCommands(commandBuffers[currentFrame].commandBuffer, jobCount, gBufferSecondaries.data());
+		}
+		vkCmdEndRenderPass(commandBuffers[currentFrame].commandBuffer);
 	};
 
-	vkCmdBindDescriptorSets(commandBuffers[currentFrame].commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, gBufferPipeline.pipelineLayout, 0, gBufferSets.size(), gBufferSets.data(), 0, nullptr);
+	recordGBufferPass(gBufferRenderPass.renderPass, CULLING_PHASE::EARLY);
 
+	//Occlusion culling against the early depth, then the objects it reveals are drawn on top
+	recordHiZ(commandBuffers[currentFrame].commandBuffer);
+	recordCulling(commandBuffers[currentFrame].commandBuffer, viewProjection, CULLING_PHASE::LATE);
 
-	for (const auto& info : drawInfos) {
-		PushConstant push{
-			.ssboIndex = info.ssboIndex,
-		};
-
-		vkCmdPushConstants(commandBuffers[currentFrame].commandBuffer, gBufferPipeline.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstant), &push);
-		vkCmdDrawIndexed(commandBuffers[currentFrame].commandBuffer, info.indexCount, 1, info.firstIndex, info.vertexOffset, 0);
+	{
+		VkImageMemoryBarrier depthBarrier{};
+		depthBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		depthBarrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		depthBarrier.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		depthBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		depthBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		depthBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		depthBarrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		depthBarrier.image = gBufferDepthImage.image;
+		depthBarrier.subresourceRange = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1 };
+
+		VkMemoryBarrier colorBarrier{};
+		colorBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		colorBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		colorBarrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+		vkCmdPipelineBarrier(
+			commandBuffers[currentFrame].commandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			0,
+			1, &colorBarrier,
+			0, nullptr,
+			1, &depthBarrier
+		);
 	}
 
-	vkCmdEndRenderPass(commandBuffers[currentFrame].commandBuffer);
+	recordGBufferPass(gBufferLateRenderPass.renderPass, CULLING_PHASE::LATE);
 
 
 	VkImage images[5]{};
@@ -410,19 +416,23 @@ void Renderer::submit(ECS& ecs, Camera& camera)
 
 	PushConstant push{
 		.ssboIndex = 0,
-		.skyboxIndex = 0
+		.skyboxIndex = 0,
+		.isEnvironmentReady = isEnvironmentReady ? 1u : 0u
 	};
 
 
-	vkCmdBindPipeline(commandBuffers[currentFrame].commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, skyboxPipeline.pipeline);
-	std::array<VkDescriptorSet, 3> skyboxSets{
-		descriptorManager.globalDescriptorSet.descriptorSet,
-		descriptorManager.bindlessResourceDescriptorSet.descriptorSet,
-		descriptorManager.targetDescriptorSet.descriptorSet
-	};
-	vkCmdBindDescriptorSets(commandBuffers[currentFrame].commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, skyboxPipeline.pipelineLayout, 0, skyboxSets.size(), skyboxSets.data(), 0, nullptr);
-	vkCmdPushConstants(commandBuffers[currentFrame].commandBuffer, skyboxPipeline.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstant), &push);
-	vkCmdDraw(commandBuffers[currentFrame].commandBuffer, 36, 1, 0, 0);
+	//The ibl job owns the skybox until its maps were acquired
+	if (isEnvironmentReady) {
+		vkCmdBindPipeline(commandBuffers[currentFrame].commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, skyboxPipeline.pipeline);
+		std::array<VkDescriptorSet, 3> skyboxSets{
+			descriptorManager.globalDescriptorSet.descriptorSet,
+			descriptorManager.bindlessResourceDescriptorSet.descriptorSet,
+			descriptorManager.targetDescriptorSet.descriptorSet
+		};
+		vkCmdBindDescriptorSets(commandBuffers[currentFrame].commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, skyboxPipeline.pipelineLayout, 0, skyboxSets.size(), skyboxSets.data(), static_cast<uint32_t>(globalOffsets.size()), globalOffsets.data());
+		vkCmdPushConstants(commandBuffers[currentFrame].commandBuffer, skyboxPipeline.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstant), &push);
+		vkCmdDraw(commandBuffers[currentFrame].commandBuffer, 36, 1, 0, 0);
+	}
 
 
 	vkCmdBindPipeline(commandBuffers[currentFrame].commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, lightingPipeline.pipeline);
@@ -431,7 +441,7 @@ void Renderer::submit(ECS& ecs, Camera& camera)
 		descriptorManager.bindlessResourceDescriptorSet.descriptorSet,
 		descriptorManager.targetDescriptorSet.descriptorSet
 	};
-	vkCmdBindDescriptorSets(commandBuffers[currentFrame].commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, lightingPipeline.pipelineLayout, 0, lightingSets.size(), lightingSets.data(), 0, nullptr);
+	vkCmdBindDescriptorSets(commandBuffers[currentFrame].commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, lightingPipeline.pipelineLayout, 0, lightingSets.size(), lightingSets.data(), static_cast<uint32_t>(globalOffsets.size()), globalOffsets.data());
 	vkCmdPushConstants(commandBuffers[currentFrame].commandBuffer, lightingPipeline.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstant), &push);
 	vkCmdDraw(commandBuffers[currentFrame].commandBuffer, 6, 1, 0, 0);
 
@@ -494,145 +504,182 @@ void Renderer::submit(ECS& ecs, Camera& camera)
 
 	vkCmdEndRenderPass(commandBuffers[currentFrame].commandBuffer);
 
+	//Jobs scheduled during the frame go to the compute queue once it was submitted
+	asyncCompute.release(commandBuffers[currentFrame].commandBuffer);
 
 	commandBuffers[currentFrame].end();
 	//Submit
-	commandBuffers[currentFrame].submit(vulkanContext.device.graphicsQueue, inFlightFences[currentFrame], imageAvailableSemaphores[currentFrame], renderFinishedSemaphores[currentFrame]);
+	frameValues[currentFrame] = frameTimeline.next();
+	commandBuffers[currentFrame].submitTimeline(vulkanContext.device.graphicsQueue, frameTimeline.semaphore, frameValues[currentFrame], { { imageAvailableSemaphores[currentFrame], 0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT }, uploadWait, computeWait }, renderFinishedSemaphores[currentFrame]);
+	asyncCompute.submit({ frameTimeline.semaphore, frameValues[currentFrame], VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT });
 }
 
-void Renderer::submit2(ECS& ecs, Camera& camera)
+void Renderer::updateScene(ECS& ecs)
 {
-	commandBuffers[currentFrame].begin();
-
-	//if (handleResourcesUpload(resourceManager, commandBuffers[currentFrame].commandBuffer)) {
-	//	commandBuffers[currentFrame].end();
-	//	//Submit
-	//	commandBuffers[currentFrame].submit(vulkanContext.device.graphicsQueue, inFlightFences[currentFrame], imageAvailableSemaphores[currentFrame], renderFinishedSemaphores[currentFrame]);
-	//	return;
-	//};
-
-	//Processing scene
-	uint32_t currentVertexOffset = 0;
-	uint32_t currentIndexOffset = 0;
-	uint32_t uboIndex = 0;
-	drawInfos.clear();
-	lightInfos.clear();
-	drawInfos.reserve(ecs.getEntityCount());
-	lightInfos.reserve(ecs.getEntityCount());
-	batchedVertices.clear();
-	batchedIndices.clear();
-
-	ecs.onEachEntity([&](std::shared_ptr<Entity> entity) {
-		const auto& l = ecs.getComponent<Light>(entity);
-		if (l) {
-			lightInfos.push_back({
-				.type = l->type,
-				.direction = l->direction,
-				.position = l->position,
-				.color = l->color
-				});
-			return;
+	//Geometry is registered once per mesh. Only meshes written since the last check can carry new data
+	bool meshesChanged = false;
+	pendingMeshes.clear();
+	ecs.view<const Mesh>().eachChanged(meshVersion, [&](Entity entity, const Mesh& m) {
+		meshesChanged = true;
+		if (m.vertices && m.indices) {
+			pendingMeshes.push_back(entity);
 		}
-		const auto& t = ecs.getComponent<Transform>(entity);
-		const auto& m = ecs.getComponent<Mesh>(entity);
-		const auto& ma = ecs.getComponent<Material>(entity);
-
-		drawInfos.push_back({
-			.indexCount = static_cast<uint32_t>(m->indices->size()),
-			.firstIndex = currentIndexOffset,
-			.vertexOffset = 0,
-			.ssboIndex = uboIndex++,
-			.transform = t,
-			.material = ma
-			});
-
-		batchedVertices.insert(batchedVertices.end(), m->vertices->begin(), m->vertices->end());
-		for (size_t i = 0; i < m->indices->size(); ++i) {
-			batchedIndices.push_back((*m->indices)[i] + currentVertexOffset);
-		}
-		currentVertexOffset += m->vertices->size();
-		currentIndexOffset += m->indices->size();
 		});
 
-	if (!isMainVertexBufferInitialized) {
-		mainVertexBuffer.initVertexBuffer(std::make_shared<Vertices>(batchedVertices), vulkanContext.device.graphicsQueue, graphicsCommandPool.commandPool);
-		mainIndexBuffer.initIndexBuffer(std::make_shared<Indices>(batchedIndices), vulkanContext.device.graphicsQueue, graphicsCommandPool.commandPool);
-		isMainVertexBufferInitialized = true;
+	for (Entity entity : pendingMeshes) {
+		Mesh* m = ecs.getComponent<Mesh>(entity);
+		m->meshId = meshRegistry.add(m->vertices, m->indices, m->meshlets);
+		m->vertices.reset();
+		m->indices.reset();
+		m->meshlets.reset();
 	}
-
-
-
-	mainVertexBuffer.bind(commandBuffers[currentFrame].commandBuffer);
-	mainIndexBuffer.bind(commandBuffers[currentFrame].commandBuffer);
-
-
-	//Updating UBOs and SSBOs
-	descriptorManager.globalDescriptorSet.update(DescriptorManager::GLOBAL_BINDING::GLOBAL_UBO, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, { globalUniformBuffers[currentFrame].buffer, 0, VK_WHOLE_SIZE });
-	descriptorManager.globalDescriptorSet.update(DescriptorManager::GLOBAL_BINDING::OBJECT_SSBO, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, { objectStorageBuffers[currentFrame].buffer, 0, VK_WHOLE_SIZE });
-	descriptorManager.globalDescriptorSet.update(DescriptorManager::GLOBAL_BINDING::LIGHTING_SSBO, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, { lightStorageBuffers[currentFrame].buffer, 0, VK_WHOLE_SIZE });
-
-	//Writing to UBOs and SSBOs
-	{
-		std::vector<objectSSBO> ssbo(1000);
-		for (int i = 0; i < drawInfos.size(); ++i) {
-			auto& drawInfo = drawInfos[i];
-			ssbo[i] = {
-				.model = drawInfo.transform->transformationMatrix(),
-				.albedoIndex = drawInfo.material->albedoIndex,
-				.roughnessIndex = drawInfo.material->roughnessIndex,
-				.normalIndex = drawInfo.material->normalIndex,
-				.occlusionIndex = drawInfo.material->occlusionIndex,
-				.emissiveIndex = drawInfo.material->emissiveIndex
+	meshVersion = ecs.advanceVersion();
+
+	//Ssbo slots only change when entities or components are added or removed, batches also when a mesh changes
+	if (meshesChanged || sceneStructuralVersion != ecs.getStructuralVersion()) {
+		sceneStructuralVersion = ecs.getStructuralVersion();
+		sceneLayoutVersion++;
+		isVisibilityReset = true;
+
+		objectCount = 0;
+		lightCount = 0;
+		objectSlots.clear();
+		lightSlots.clear();
+		objectBatches.clear();
+		drawBatches.clear();
+		batchEntities.clear();
+		meshBatches.assign(meshRegistry.getMeshCount(), UINT32_MAX);
+
+		auto setSlot = [](std::vector<uint32_t>& slots, Entity entity, uint32_t slot) {
+			if (entity.index >= slots.size()) {
+				slots.resize(entity.index + 1, UINT32_MAX);
+			}
+			slots[entity.index] = slot;
 			};
 
-		}
+		ecs.view<const Light>().each([&](Entity entity, const Light&) {
+			setSlot(lightSlots, entity, lightCount++);
+			});
 
-		/*for (size_t i = 0; i < std::min<size_t>(drawInfos.size(), 8); ++i) {
-			auto& d = drawInfos[i];
-			std::cout << "[SSBO] draw=" << d.ssboIndex
-				<< " albedo=" << d.material->albedoIndex
-				<< " normal=" << d.material->normalIndex
-				<< " roughness=" << d.material->roughnessIndex
-				<< " occlusion=" << d.material->occlusionIndex
-				<< " emissive=" << d.material->emissiveIndex
-				<< "\n";
-		}*/
-
-		objectStorageBuffers[currentFrame].copy(sizeof(objectSSBO) * ssbo.size(), ssbo.data());
-	}
+		//One batch per mesh, drawn with as many instances as it has visible objects. Materials are bindless and
+		//read per object, so they do not split batches. Meshes without geometry keep their slot but join no batch
+		ecs.view<const Transform, const Mesh, const Material>().each([&](Entity entity, const Transform&, const Mesh& m, const Material&) {
+			setSlot(objectSlots, entity, objectCount++);
+
+			uint32_t batch = UINT32_MAX;
+			if (m.meshId != Mesh::INVALID_MESH) {
+				batch = meshBatches[m.meshId];
+				if (batch == UINT32_MAX) {
+					batch = meshBatches[m.meshId] = static_cast<uint32_t>(drawBatches.size());
+					drawBatches.push_back({ .meshId = m.meshId, .firstInstance = 0, .instanceCount = 0 });
+					batchEntities.push_back(entity);
+				}
+				drawBatches[batch].instanceCount++;
+			}
+			setSlot(objectBatches, entity, batch);
+			});
 
-	{
-		std::vector<lightSSBO> ssbo(100);
-		for (int i = 0; i < lightInfos.size(); ++i) {
-			ssbo[i] = {
-				.lightType = glm::vec4(lightInfos[i].type, 0.0f, 0.0f, 0.0f),
-				.lightDir = lightInfos[i].direction,
-				.lightPos = lightInfos[i].position,
-				.lightColor = lightInfos[i].color
-			};
+		//Every batch owns a range of the instance buffer large enough for all its objects
+		uint32_t firstInstance = 0;
+		for (auto& batch : drawBatches) {
+			batch.firstInstance = firstInstance;
+			firstInstance += batch.instanceCount;
 		}
 
-		lightStorageBuffers[currentFrame].copy(sizeof(lightSSBO) * ssbo.size(), ssbo.data());
+		reserveFrameStorage(objectCount, lightCount);
 	}
 
-	{
-		globalUBO ubo{
-			.view = camera.getViewMatrix(),
-			.projection = camera.getProjectionMatrix(),
-			.camPos = glm::vec4(camera.position, 0.0f),
-			.dimensions = glm::vec4(static_cast<float>(swapchain.swapchain.extent.width), static_cast<float>(swapchain.swapchain.extent.height), 0.0f, 0.0f),
-			.inverseProjection = camera.getInverseProjectionMatrix(),
-			.inverseView = camera.getInverseViewMatrix(),
-			.numberOfEntities = glm::vec4(drawInfos.size(), lightInfos.size(), 0.0f, 0.0f)
+	//Every frame in flight has its own object and light ranges in the ring, each one remembers the version it was last written at.
+	//After a layout change the slots or batches moved, and a range that moved holds nothing, so those are rewritten completely
+	RingBuffer::Allocation objectAllocation = frameRing.allocate(sizeof(objectSSBO) * objectCapacity);
+	RingBuffer::Allocation lightAllocation = frameRing.allocate(sizeof(lightSSBO) * lightCapacity);
+	//Every object page reads the same allocation, their descriptors already start a page apart
+	std::fill_n(globalOffsets.begin() + DescriptorManager::GLOBAL_OFFSET::OBJECT_SSBO_OFFSET, DescriptorManager::OBJECT_PAGES, objectAllocation.offset);
+	globalOffsets[DescriptorManager::GLOBAL_OFFSET::LIGHTING_SSBO_OFFSET] = lightAllocation.offset;
+
+	bool isMoved = frameObjectOffsets[currentFrame] != objectAllocation.offset || frameLightOffsets[currentFrame] != lightAllocation.offset;
+	frameObjectOffsets[currentFrame] = objectAllocation.offset;
+	frameLightOffsets[currentFrame] = lightAllocation.offset;
+
+	uint32_t since = !isMoved && frameLayoutVersions[currentFrame] == sceneLayoutVersion ? frameVersions[currentFrame] : 0;
+	frameLayoutVersions[currentFrame] = sceneLayoutVersion;
+	frameVersions[currentFrame] = ecs.advanceVersion();
+
+	objectSSBO* objects = static_cast<objectSSBO*>(objectAllocation.data);
+	auto writeObject = [&](Entity entity, const Transform& t, const Mesh&, const Material& ma) {
+		objects[objectSlots[entity.index]] = {
+			.model = t.worldMatrix,
+			.normalMatrix = glm::mat3x4(t.worldNormalMatrix),
+			.albedoIndex = ma.albedoIndex,
+			.roughnessIndex = ma.roughnessIndex,
+			.normalIndex = ma.normalIndex,
+			.occlusionIndex = ma.occlusionIndex,
+			.emissiveIndex = ma.emissiveIndex,
+			.batchIndex = objectBatches[entity.index]
+		};
 		};
 
-		globalUniformBuffers[currentFrame].copy(sizeof(ubo), &ubo);
+	//Full rewrites touch every object, so they are split over the job system. Every entity owns its own slot
+	if (since == 0 && jobSystem) {
+		ecs.view<const Transform, const Mesh, const Material>().eachParallel(*jobSystem, writeObject);
+	}
+	else {
+		ecs.view<const Transform, const Mesh, const Material>().eachChanged(since, writeObject);
 	}
 
+	lightSSBO* lights = static_cast<lightSSBO*>(lightAllocation.data);
+	ecs.view<const Light>().eachChanged(since, [&](Entity entity, const Light& l) {
+		lights[lightSlots[entity.index]] = {
+			.lightType = glm::vec4(l.type, 0.0f, 0.0f, 0.0f),
+			.lightDir = l.direction,
+			.lightPos = l.position,
+			.lightColor = l.color
+		};
+		});
 
+	//Batches are few (one per mesh), so they are simply written every frame
+	batchAllocation = frameRing.allocate(sizeof(DrawBatch) * std::max<size_t>(drawBatches.size(), 1));
+	std::memcpy(batchAllocation.data, drawBatches.data(), sizeof(DrawBatch) * drawBatches.size());
 }
 
+void Renderer::sortDraws(ECS& ecs, const Camera& camera, DrawKey::ORDER order)
+{
+	uint32_t batchCount = static_cast<uint32_t>(drawBatches.size());
+
+	//A batch is one draw, so there is one key per batch. Keys only change with the batches or with the camera's distance
+	//to them, small camera moves inside a cell keep the last order
+	glm::ivec3 cameraCell = glm::ivec3(glm::floor(camera.position / SORT_CELL_SIZE));
+	if (sortedLayoutVersion != sceneLayoutVersion || sortedCameraCell != cameraCell || sortedOrder != order) {
+		sortedLayoutVersion = sceneLayoutVersion;
+		sortedCameraCell = cameraCell;
+		sortedOrder = order;
+
+		//The g-buffer is the only pipeline for now. Const access does not mark the components as changed
+		drawKeys.resize(batchCount);
+		for (uint32_t batch = 0; batch < batchCount; ++batch) {
+			const Transform* t = ecs.getComponent<const Transform>(batchEntities[batch]);
+			const Material* ma = ecs.getComponent<const Material>(batchEntities[batch]);
+			float distance = glm::length(glm::vec3(t->worldMatrix[3]) - camera.position);
+			drawKeys[batch] = { DrawKey::make(order, 0, ma->albedoIndex, drawBatches[batch].meshId, distance), batch };
+		}
+
+		RadixSort::sort(drawKeys, drawKeyScratch, jobSystem);
+
+		batchRanks.resize(batchCount);
+		for (uint32_t rank = 0; rank < batchCount; ++rank) {
+			batchRanks[drawKeys[rank].value] = rank;
+		}
+	}
+
+	//Like the batches, the ranks are written every frame, every frame in flight reads its own range of the ring
+	drawOrderAllocation = frameRing.allocate(sizeof(uint32_t) * std::max(batchCount, 1u));
+	std::memcpy(drawOrderAllocation.data, batchRanks.data(), sizeof(uint32_t) * batchCount);
+}
 
+void Renderer::removeMesh(uint32_t meshId)
+{
+	meshRegistry.remove(meshId);
+}
 
 void Renderer::endFrame()
 {
@@ -653,371 +700,271 @@ void Renderer::endFrame()
 
 bool Renderer::preprocess(ResourceManager& resourceManager)
 {
-	vkResetCommandBuffer(initializationCommandBuffer.commandBuffer, 0);
-	initializationCommandBuffer.begin();
+	handleResourcesUpload(resourceManager);
+	uint64_t uploadValue = uploadEngine.submit();
 
-	auto upload = handleResourcesUpload(resourceManager, initializationCommandBuffer.commandBuffer);
-
-	//if upload not done, end and come back
-	if (!upload) {
-		initializationCommandBuffer.end();
-		initializationCommandBuffer.submit(vulkanContext.device.graphicsQueue);
-		vkDeviceWaitIdle(vulkanContext.vulkanResources.device);
+	//Frames need the default texture and the ibl job the skybox, every other image keeps streaming during frames
+	if (!defaultTexture || streamingCubeMaps > 0) {
+		//One batch stays in flight while the next one is packed
+		uploadEngine.wait(uploadValue > 0 ? uploadValue - 1 : 0);
 		return false;
 	}
 
-	bool ibl = computeSkyBoxMaps(initializationCommandBuffer.commandBuffer);
-
-	initializationCommandBuffer.end();
-	initializationCommandBuffer.submit(vulkanContext.device.graphicsQueue);
-
-	vkDeviceWaitIdle(vulkanContext.vulkanResources.device);
-
-
-
-	//Destroy iamge views and frame buffers (both can stay but really not needed) FB -> IV
+	vkResetCommandBuffer(initializationCommandBuffer.commandBuffer, 0);
+	initializationCommandBuffer.begin();
 
-	for (auto& fb : irradianceFramebuffers) {
-		fb.destroyFrameBuffer();
-	}
-	for (auto& v : prefilterFramebuffers) {
-		for (auto& fb : v) {
-			fb.destroyFrameBuffer();
-		}
-	}
-	lutFramebuffer.destroyFrameBuffer();
+	//The skybox is acquired from the transfer queue and handed on to the compute queue, frames start right away
+	//and light with the ibl maps once they are done
+	CommandBuffer::SemaphoreWait uploadWait = uploadEngine.acquire(initializationCommandBuffer.commandBuffer);
+	computeSkyBoxMaps();
+	asyncCompute.release(initializationCommandBuffer.commandBuffer);
 
-	irradianceCubeMapImage.destroyTransientViews();
-	prefilterCubeMapImage.destroyTransientViews();
-	brdfLUTImage.destroyTransientViews();
+	initializationCommandBuffer.end();
+	uint64_t value = frameTimeline.next();
+	initializationCommandBuffer.submitTimeline(vulkanContext.device.graphicsQueue, frameTimeline.semaphore, value, { uploadWait });
+	asyncCompute.submit({ frameTimeline.semaphore, value, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT });
 
-	return upload && ibl ? true : false;
+	return true;
 }
 
-bool Renderer::handleResourcesUpload(ResourceManager& resourceManager, VkCommandBuffer& commandBuffer)
+void Renderer::handleResourcesUpload(ResourceManager& resourceManager)
 {
-	//TODO: Upload First then worry about rendering
 	images.reserve(images.size() + resourceManager.uploadQueue.size());
 
-	if (!resourceManager.uploadQueue.empty()) {
+	//Every image waiting is queued on the upload engine, which streams its layers over the next submits
+	while (!resourceManager.uploadQueue.empty()) {
 		auto imageResource = resourceManager.uploadQueue.front();
+		resourceManager.uploadQueue.pop();
+
 		const uint32_t layerCount = static_cast<uint32_t>(imageResource->layers.size());
+		const uint32_t width = static_cast<uint32_t>(imageResource->layers[0].width);
+		const uint32_t height = static_cast<uint32_t>(imageResource->layers[0].height);
+		const bool isTexture = imageResource->type == ResourceManager::TEXTURES;
 
-		if (imageResource->gpuState == ResourceManager::UNLOADED) {
-			imageResource->setGPUState(ResourceManager::LOADING);
-
-			images.emplace_back(new Image{ vulkanContext.vulkanResources });
-
-			//std::cout << imageResource->width + " " << imageResource->height << "\n";
-			images.back()->initImage(
-				VK_IMAGE_TYPE_2D,
-				VK_FORMAT_R8G8B8A8_SRGB,
-				VkExtent3D{ static_cast<uint32_t>(imageResource->layers[0].width), static_cast<uint32_t>(imageResource->layers[0].height), 1 },
-				VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-				VMA_MEMORY_USAGE_GPU_ONLY,
-				1U,
-				layerCount,
-				VK_SAMPLE_COUNT_1_BIT,
-				VK_IMAGE_TILING_OPTIMAL,
-				imageResource->type == ResourceManager::TEXTURES ? 0 : VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT
-			);
-
-			images.back()->transitionImageLayout(
-				commandBuffer,
-				VK_IMAGE_LAYOUT_UNDEFINED,
-				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-				{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, layerCount }
-			);
-		}
-		
-		static int i = 0;
-		if (i < layerCount) {
-			uint32_t imageSize = imageResource->layers[i].width * imageResource->layers[i].height * 4;
-			stagingBuffer.copy(imageSize, imageResource->layers[i].pixels);
-
-			images.back()->copyBufferToImage(
-				commandBuffer,
-				stagingBuffer.buffer,
-				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-				static_cast<uint32_t>(imageResource->layers[i].width),
-				static_cast<uint32_t>(imageResource->layers[i].height),
-				1U,
-				i
-			);
-			i++;
-			return false;
-		}		
-
-		images.back()->transitionImageLayout(
-			commandBuffer,
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-			{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, layerCount }
+		imageResource->setGPUState(ResourceManager::LOADING);
+
+		Image* image = images.emplace_back(new Image{ vulkanContext.vulkanResources });
+
+		//std::cout << imageResource->width + " " << imageResource->height << "\n";
+		image->initImage(
+			VK_IMAGE_TYPE_2D,
+			VK_FORMAT_R8G8B8A8_SRGB,
+			VkExtent3D{ width, height, 1 },
+			VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+			VMA_MEMORY_USAGE_GPU_ONLY,
+			1U,
+			layerCount,
+			VK_SAMPLE_COUNT_1_BIT,
+			VK_IMAGE_TILING_OPTIMAL,
+			isTexture ? 0 : VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT
 		);
 
-		images.back()->initImageView(
-			imageResource->type == ResourceManager::TEXTURES ? VK_IMAGE_VIEW_TYPE_2D : VK_IMAGE_VIEW_TYPE_CUBE,
+		image->initImageView(
+			isTexture ? VK_IMAGE_VIEW_TYPE_2D : VK_IMAGE_VIEW_TYPE_CUBE,
 			VK_FORMAT_R8G8B8A8_SRGB,
 			{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, layerCount }
 		);
-		//std::cout << '\n' << imageResource->getID() << std::endl;
-
 
-		uint32_t appendedIndex = static_cast<uint32_t>(images.size() - 1);
-		std::cout << "[TextureUpload] resID=" << imageResource->getID()
-			<< " appendedIndex=" << appendedIndex
-			<< " imageView=0x" << std::hex << images.back()->imageView << std::dec
-			<< " path=\"" << imageResource->path << "\"\n";
-
-		descriptorManager.bindlessResourceDescriptorSet.update(
-			static_cast<uint32_t>(imageResource->type),
-			imageResource->getID(),
-			VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-			{ imageResource->type == ResourceManager::TEXTURES ? textureSampler : cubemapSampler, images.back()->imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }
-		);
+		//Until its last layer went out the texture's slot shows the default texture
+		if (isTexture) {
+			streamingTextures.push_back(imageResource->getID());
+			if (defaultTexture) {
+				bindBindlessImage(ResourceManager::TEXTURES, imageResource->getID(), defaultTexture);
+			}
+		}
+		else {
+			streamingCubeMaps++;
+		}
 
-		imageResource->setGPUState(ResourceManager::ResourceState::LOADED);
-		//imageResource->free();
+		std::vector<const void*> layers;
+		layers.reserve(layerCount);
+		for (const auto& layer : imageResource->layers) {
+			layers.push_back(layer.pixels);
+		}
 
-		resourceManager.uploadQueue.pop();
-		i = 0;
-		return false;
+		//The resource is captured so its pixels live until they were staged
+		uploadEngine.uploadImage(*image, width, height, std::move(layers), [this, imageResource, image, isTexture]() {
+			uint32_t id = imageResource->getID();
+
+			//Frames submitted from now on acquire the copy, so the image can be bound right away
+			bindBindlessImage(imageResource->type, id, image);
+			imageResource->setGPUState(ResourceManager::ResourceState::LOADED);
+			//imageResource->free();
+
+			if (!isTexture) {
+				if (id == 0) {
+					skyboxImage = image;
+				}
+				streamingCubeMaps--;
+				return;
+			}
+
+			streamingTextures.erase(std::find(streamingTextures.begin(), streamingTextures.end(), id));
+			if (id == 0) {
+				defaultTexture = image;
+				for (uint32_t streamingId : streamingTextures) {
+					bindBindlessImage(ResourceManager::TEXTURES, streamingId, defaultTexture);
+				}
+			}
+		});
 	}
-	return true;
 }
 
-bool Renderer::computeSkyBoxMaps(VkCommandBuffer& commandBuffer)
+void Renderer::bindBindlessImage(ResourceManager::ResourceType type, uint32_t id, Image* image)
 {
-	//TODO: find why we truly need to do this and render pass cant
-	//TODO: Layouts start at undefined but this only works at start, if reusing this for dynamic upload then need to change old layout
-	//TODO: Batch barriers </3
-	VkImageMemoryBarrier barrier{};
-	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-	barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	barrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-	barrier.srcAccessMask = 0;
-	barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-	barrier.image = irradianceCubeMapImage.image;
-	barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 6 };
-
-	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0,
-		0, nullptr,
-		0, nullptr,
-		1, &barrier);
-
-	barrier.image = prefilterCubeMapImage.image;
-	barrier.subresourceRange.levelCount = 5;
-	barrier.subresourceRange.layerCount = 6;
-
-	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0,
-		0, nullptr,
-		0, nullptr,
-		1, &barrier);
-
-	barrier.image = brdfLUTImage.image;
-	barrier.subresourceRange.levelCount = 1;
-	barrier.subresourceRange.layerCount = 1;
-
-	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0,
-		0, nullptr,
-		0, nullptr,
-		1, &barrier);
-
-
-
-	VkClearValue clear = { 0.0f, 0.0f, 0.0f, 0.0f };
-
-
-	for (uint32_t face = 0; face < 6; ++face) {
-		VkViewport viewport{};
-		viewport.x = 0.0f;
-		viewport.y = 0.0f;
-		viewport.width = 32;
-		viewport.height = 32;
-		viewport.minDepth = 0.0f;
-		viewport.maxDepth = 1.0f;
-
-
-		VkRect2D scissor{};
-		scissor.offset = { 0,0 };
-		scissor.extent = { 32, 32 };
-
-		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+	descriptorManager.bindlessResourceDescriptorSet.update(
+		static_cast<uint32_t>(type),
+		id,
+		VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		{ type == ResourceManager::TEXTURES ? textureSampler : cubemapSampler, image->imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }
+	);
+}
 
-		std::vector<VkImageView> attachments = { irradianceCubeMapImage.createFaceView(face) };
-		irradianceFramebuffers[face].initFrameBuffer(attachments, 32, 32, 1, irradiancePrefilterRenderPass.renderPass);
-
-		VkRenderPassBeginInfo renderPassBeginInfo{};
-		renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		renderPassBeginInfo.renderPass = irradiancePrefilterRenderPass.renderPass;
-		renderPassBeginInfo.framebuffer = irradianceFramebuffers[face].framebuffer;
-		renderPassBeginInfo.renderArea = { {0, 0}, {32, 32} };
-		renderPassBeginInfo.clearValueCount = 1;
-		renderPassBeginInfo.pClearValues = &clear;
-
-		vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, irradiancePipeline.pipeline);
-		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, irradiancePipeline.pipelineLayout, 0, 1, &descriptorManager.bindlessResourceDescriptorSet.descriptorSet, 0, nullptr);
-		SkyboxPreprocessPushConstant push{
-			.faceIndex = face
-		};
-		vkCmdPushConstants(commandBuffer, irradiancePipeline.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(SkyboxPreprocessPushConstant), &push);
-		vkCmdDraw(commandBuffer, 6, 1, 0, 0);
-		vkCmdEndRenderPass(commandBuffer);
+void Renderer::computeSkyBoxMaps()
+{
+	if (!skyboxImage) {
+		return;
 	}
 
-	for (uint32_t mip = 0; mip < 5; ++mip) {
-		uint32_t mipSize = 128 >> mip;
-
-		VkViewport viewport{};
-		viewport.x = 0.0f;
-		viewport.y = 0.0f;
-		viewport.width = mipSize;
-		viewport.height = mipSize;
-		viewport.minDepth = 0.0f;
-		viewport.maxDepth = 1.0f;
-
-
-		VkRect2D scissor{};
-		scissor.offset = { 0,0 };
-		scissor.extent = { mipSize, mipSize };
-
-		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
-
-		for (uint32_t face = 0; face < 6; ++face) {
-
-			std::vector<VkImageView> attachments = { prefilterCubeMapImage.createFaceMipView(face, mip) };
-			prefilterFramebuffers[face][mip].initFrameBuffer(attachments, mipSize, mipSize, 1, irradiancePrefilterRenderPass.renderPass);
-
-			VkRenderPassBeginInfo renderPassBeginInfo{};
-			renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-			renderPassBeginInfo.renderPass = irradiancePrefilterRenderPass.renderPass;
-			renderPassBeginInfo.framebuffer = prefilterFramebuffers[face][mip].framebuffer;
-			renderPassBeginInfo.renderArea = { {0, 0}, {mipSize, mipSize} };
-			renderPassBeginInfo.clearValueCount = 1;
-			renderPassBeginInfo.pClearValues = &clear;
-
-			vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, prefilterPipeline.pipeline);
-			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, prefilterPipeline.pipelineLayout, 0, 1, &descriptorManager.bindlessResourceDescriptorSet.descriptorSet, 0, nullptr);
-			SkyboxPreprocessPushConstant push{
-				.faceIndex = face,
-				.mipLevel = mip
-			};
-			vkCmdPushConstants(commandBuffer, prefilterPipeline.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(SkyboxPreprocessPushConstant), &push);
-			vkCmdDraw(commandBuffer, 6, 1, 0, 0);
-			vkCmdEndRenderPass(commandBuffer);
-
-		}
+	//Every set reads the skybox and writes one map, the cube maps through all six faces of one mip
+	std::vector<VkImageView> views;
+	views.reserve(DescriptorManager::IBL_SETS);
+	views.push_back(irradianceCubeMapImage.createMipArrayView(0, 6));
+	for (uint32_t mip = 0; mip < DescriptorManager::PREFILTER_MIPS; ++mip) {
+		views.push_back(prefilterCubeMapImage.createMipArrayView(mip, 6));
 	}
+	views.push_back(brdfLUTImage.createFaceMipView(0, 0));
 
-	VkViewport viewport{};
-	viewport.x = 0.0f;
-	viewport.y = 0.0f;
-	viewport.width = 512;
-	viewport.height = 512;
-	viewport.minDepth = 0.0f;
-	viewport.maxDepth = 1.0f;
-
-
-	VkRect2D scissor{};
-	scissor.offset = { 0,0 };
-	scissor.extent = { 512, 512 };
-
-	vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+	for (uint32_t i = 0; i < DescriptorManager::IBL_SETS; ++i) {
+		DescriptorSet& iblSet = descriptorManager.iblDescriptorSets[i];
+		iblSet.update(DescriptorManager::IBL_BINDING::SKYBOX_IMAGE, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, { cubemapSampler, skyboxImage->imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
+		iblSet.update(DescriptorManager::IBL_BINDING::IBL_IMAGE, 0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, { VK_NULL_HANDLE, views[i], VK_IMAGE_LAYOUT_GENERAL });
+	}
 
-	std::vector<VkImageView> attachments = { brdfLUTImage.imageView };
-	lutFramebuffer.initFrameBuffer(attachments, 512, 512, 1, lutRenderPass.renderPass);
+	AsyncCompute::Job job;
+	job.record = [this](VkCommandBuffer commandBuffer) {
+		recordSkyBoxMaps(commandBuffer);
+	};
+	job.inputs = {
+		{ skyboxImage, { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 6 } }
+	};
+	job.outputs = {
+		{ &irradianceCubeMapImage, { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 6 } },
+		{ &prefilterCubeMapImage, { VK_IMAGE_ASPECT_COLOR_BIT, 0, DescriptorManager::PREFILTER_MIPS, 0, 6 } },
+		{ &brdfLUTImage, { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 } }
+	};
+	job.onAcquired = [this]() {
+		//The job is done with the storage views
+		irradianceCubeMapImage.destroyTransientViews();
+		prefilterCubeMapImage.destroyTransientViews();
+		brdfLUTImage.destroyTransientViews();
+
+		bindEnvironmentDescriptors();
+		isEnvironmentReady = true;
+	};
 
-	VkRenderPassBeginInfo renderPassBeginInfo{};
-	renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	renderPassBeginInfo.renderPass = lutRenderPass.renderPass;
-	renderPassBeginInfo.framebuffer = lutFramebuffer.framebuffer;
-	renderPassBeginInfo.renderArea = { {0, 0}, {512, 512} };
-	renderPassBeginInfo.clearValueCount = 1;
-	renderPassBeginInfo.pClearValues = &clear;
+	scheduleCompute(std::move(job));
+}
 
-	vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, lutPipeline.pipeline);
-	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, lutPipeline.pipelineLayout, 0, 1, &descriptorManager.bindlessResourceDescriptorSet.descriptorSet, 0, nullptr);
+void Renderer::recordSkyBoxMaps(VkCommandBuffer commandBuffer)
+{
+	//8x8 texels per group, z is the cube face
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, irradiancePipeline.pipeline);
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, irradiancePipeline.pipelineLayout, 0, 1, &descriptorManager.iblDescriptorSets[0].descriptorSet, 0, nullptr);
 	SkyboxPreprocessPushConstant push{
 		.faceIndex = 0,
 		.mipLevel = 0
 	};
-	vkCmdPushConstants(commandBuffer, lutPipeline.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(SkyboxPreprocessPushConstant), &push);
-	vkCmdDraw(commandBuffer, 6, 1, 0, 0);
-	vkCmdEndRenderPass(commandBuffer);
-
-	VkImageMemoryBarrier barrier2{};
-	barrier2.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-	barrier2.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-	barrier2.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-	barrier2.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-	barrier2.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-	barrier2.image = irradianceCubeMapImage.image;
-	barrier2.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 6 };
-
-	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
-		0, nullptr,
-		0, nullptr,
-		1, &barrier2);
-
-	barrier2.image = prefilterCubeMapImage.image;
-	barrier2.subresourceRange.levelCount = 5;
-	barrier2.subresourceRange.layerCount = 6;
-
-	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
-		0, nullptr,
-		0, nullptr,
-		1, &barrier2);
-
-	barrier2.image = brdfLUTImage.image;
-	barrier2.subresourceRange.levelCount = 1;
-	barrier2.subresourceRange.layerCount = 1;
+	vkCmdPushConstants(commandBuffer, irradiancePipeline.pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(SkyboxPreprocessPushConstant), &push);
+	vkCmdDispatch(commandBuffer, (32 + 7) / 8, (32 + 7) / 8, 6);
 
-	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
-		0, nullptr,
-		0, nullptr,
-		1, &barrier2);
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, prefilterPipeline.pipeline);
+	for (uint32_t mip = 0; mip < DescriptorManager::PREFILTER_MIPS; ++mip) {
+		uint32_t mipSize = 128 >> mip;
 
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, prefilterPipeline.pipelineLayout, 0, 1, &descriptorManager.iblDescriptorSets[1 + mip].descriptorSet, 0, nullptr);
+		push.mipLevel = mip;
+		vkCmdPushConstants(commandBuffer, prefilterPipeline.pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(SkyboxPreprocessPushConstant), &push);
+		vkCmdDispatch(commandBuffer, (mipSize + 7) / 8, (mipSize + 7) / 8, 6);
+	}
 
-	return true;
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, lutPipeline.pipeline);
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, lutPipeline.pipelineLayout, 0, 1, &descriptorManager.iblDescriptorSets[DescriptorManager::IBL_SETS - 1].descriptorSet, 0, nullptr);
+	push.mipLevel = 0;
+	vkCmdPushConstants(commandBuffer, lutPipeline.pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(SkyboxPreprocessPushConstant), &push);
+	vkCmdDispatch(commandBuffer, (512 + 7) / 8, (512 + 7) / 8, 1);
 }
 
 void Renderer::recreateSwapchain()
 {
-	//TODO : Handle minimization properly and remake resources
+	//TODO : Handle minimization properly
 	vkQueueWaitIdle(vulkanContext.device.graphicsQueue);
 	vkQueueWaitIdle(vulkanContext.device.presentQueue);
 	vkDeviceWaitIdle(vulkanContext.vulkanResources.device);
 
-	destroy();
-	framebuffers.clear();
+	//Only what depends on the extent is remade. Scene storage, meshes, textures, pipelines and frame sync stay
+	destroySwapchainResources();
 	swapchain.destroySwapchain();
 
-	currentFrame = 0;
 	imageIndex = UINT32_MAX;
 
 	swapchain.initSwapchain();
 	initSwapchainResources();
 	initGBufferResources();
+	initHiZResources();
 	initLightingResources();
 
-	//initFramebuffers();
-	initCommandBuffers();
-	initSyncObjects();
+	bindDescriptors();
+}
+
+void Renderer::destroySwapchainResources()
+{
+	gBufferFramebuffer.destroyFrameBuffer();
+	lightingFramebuffer.destroyFrameBuffer();
+	framebuffers.clear();
+
+	gBufferAlbedoImage.destroyImage();
+	gBufferNormalImage.destroyImage();
+	gBufferMaterialImage.destroyImage();
+	gBufferPositionImage.destroyImage();
+	gBufferDepthImage.destroyImage();
+	lightingImage.destroyImage();
+	hiZImage.destroyTransientViews();
+	hiZImage.destroyImage();
+
+	if (!swapchainImageViews.empty()) {
+		swapchain.swapchain.destroy_image_views(swapchainImageViews);
+		swapchainImageViews.clear();
+	}
 }
 
 void Renderer::initCommandBuffers()
 {
+	recordingJobCount = jobSystem ? jobSystem->getThreadCount() : 1;
+	uint32_t queueIndex = vulkanContext.device.getQueueIndex(vkb::QueueType::graphics);
+
+	//Command buffers keep a reference to their pool, nothing may move
+	frameCommandPools.reserve(maxFramesInFlight);
 	commandBuffers.reserve(maxFramesInFlight);
+	gBufferCommandBuffers.reserve(maxFramesInFlight);
+
+	for (uint32_t i = 0; i < maxFramesInFlight; ++i) {
+		auto& pools = frameCommandPools.emplace_back();
+		pools.reserve(recordingJobCount + 1);
+		for (uint32_t j = 0; j < recordingJobCount + 1; ++j) {
+			pools.emplace_back(vulkanContext.vulkanResources);
+			pools.back().initCommandPool(queueIndex, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+		}
 
-	for (int i = 0; i < maxFramesInFlight; ++i) {
-		commandBuffers.emplace_back(vulkanContext.vulkanResources, graphicsCommandPool.commandPool);
+		commandBuffers.emplace_back(vulkanContext.vulkanResources, pools[0].commandPool);
 		commandBuffers.back().allocate();
+
+		auto& secondaries = gBufferCommandBuffers.emplace_back();
+		secondaries.reserve(recordingJobCount * 2);
+		for (uint32_t j = 0; j < recordingJobCount * 2; ++j) {
+			secondaries.emplace_back(vulkanContext.vulkanResources, pools[j / 2 + 1].commandPool);
+			secondaries.back().allocate(VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+		}
 	}
 
 	initializationCommandBuffer.allocate();
@@ -1027,45 +974,388 @@ void Renderer::initSyncObjects()
 {
 	imageAvailableSemaphores.resize(maxFramesInFlight);
 	renderFinishedSemaphores.resize(maxFramesInFlight);
-	inFlightFences.resize(maxFramesInFlight);
 
 	VkSemaphoreCreateInfo semaphoreInfo{};
 	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-	VkFenceCreateInfo fenceInfo{};
-	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-	fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
 	for (size_t i = 0; i < maxFramesInFlight; ++i) {
 		if (vkCreateSemaphore(vulkanContext.vulkanResources.device, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
-			vkCreateSemaphore(vulkanContext.vulkanResources.device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
-			vkCreateFence(vulkanContext.vulkanResources.device, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS) {
+			vkCreateSemaphore(vulkanContext.vulkanResources.device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to create sync objects");
 		}
 	}
+
+	frameTimeline.initTimeline();
+	//Value 0 is reached from the start, no frame waits the first time around
+	frameValues.assign(maxFramesInFlight, 0);
 }
 
-void Renderer::initUniformBuffers()
+void Renderer::initFrameRing()
 {
-	globalUniformBuffers.reserve(maxFramesInFlight);
-	for (size_t i = 0; i < maxFramesInFlight; ++i) {
-		globalUniformBuffers.emplace_back(vulkanContext.vulkanResources);
-		globalUniformBuffers[i].initUniformBuffer(sizeof(globalUBO));
+	//Ubo, both ssbos, the draw batches (never more than objects) and their draw order of one frame, plus room for their offset alignment
+	VkDeviceSize frameSize = sizeof(globalUBO) + sizeof(objectSSBO) * objectCapacity + sizeof(lightSSBO) * lightCapacity + sizeof(DrawBatch) * objectCapacity + sizeof(uint32_t) * objectCapacity + 5 * 256;
+	frameRing.initRingBuffer(frameSize, maxFramesInFlight, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+
+	frameLayoutVersions.assign(maxFramesInFlight, 0);
+	frameVersions.assign(maxFramesInFlight, 0);
+	//No frame has written its ranges yet
+	frameObjectOffsets.assign(maxFramesInFlight, UINT32_MAX);
+	frameLightOffsets.assign(maxFramesInFlight, UINT32_MAX);
+}
+
+void Renderer::reserveFrameStorage(uint32_t requiredObjects, uint32_t requiredLights)
+{
+	if (requiredObjects <= objectCapacity && requiredLights <= lightCapacity) {
+		return;
+	}
+
+	//Objects are spread over the pages of the global set (2097152 of them), lights share a single dynamic storage range
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(vulkanContext.vulkanResources.physicalDevice, &properties);
+	uint32_t maxObjects = DescriptorManager::OBJECT_PAGES * DescriptorManager::OBJECTS_PER_PAGE;
+	uint32_t maxLights = static_cast<uint32_t>(properties.limits.maxStorageBufferRange / sizeof(lightSSBO));
+
+	if (requiredObjects > maxObjects) {
+		throw std::runtime_error("Scene has more objects than the object pages hold");
+	}
+	if (requiredLights > maxLights) {
+		throw std::runtime_error("Scene exceeds the maximum storage buffer range");
+	}
+
+	while (objectCapacity < requiredObjects) {
+		objectCapacity = std::min(objectCapacity * 2, maxObjects);
+	}
+	while (lightCapacity < requiredLights) {
+		lightCapacity = std::min(lightCapacity * 2, maxLights);
 	}
+
+	//The other frames in flight still read the old ring through the global set, which is not update after bind.
+	//The current frame has not been submitted yet, the last submit covers every other frame
+	frameTimeline.wait(frameTimeline.getSubmittedValue());
+
+	initFrameRing();
+	frameRing.beginFrame(currentFrame);
+	bindGlobalDescriptors();
+	initDrawBuffers();
 }
 
-void Renderer::initStorageBuffers()
+void Renderer::initDrawBuffers()
 {
-	objectStorageBuffers.reserve(maxFramesInFlight);
-	lightStorageBuffers.reserve(maxFramesInFlight);
-	for (size_t i = 0; i < maxFramesInFlight; ++i) {
-		objectStorageBuffers.emplace_back(vulkanContext.vulkanResources);
-		lightStorageBuffers.emplace_back(vulkanContext.vulkanResources);
+	drawCommandBuffers.resize(maxFramesInFlight);
+	drawCountBuffers.resize(maxFramesInFlight);
+	instanceBuffers.resize(maxFramesInFlight);
+	batchCountBuffers.resize(maxFramesInFlight);
+	visibleInstanceBuffers.resize(maxFramesInFlight);
+	meshletDispatchBuffers.resize(maxFramesInFlight);
+	//Draw indices and meshlet masks do not depend on the object capacity, they are kept
+	drawIndexBuffers.resize(maxFramesInFlight);
+	drawIndexCapacities.resize(maxFramesInFlight, 0);
+	meshletMaskBuffers.resize(maxFramesInFlight);
+	meshletMaskCapacities.resize(maxFramesInFlight, 0);
+
+	//Batches never outnumber objects, so everything is sized by the object capacity
+	for (uint32_t i = 0; i < maxFramesInFlight; ++i) {
+		drawCommandBuffers[i] = std::make_unique<Buffer>(vulkanContext.vulkanResources);
+		drawCommandBuffers[i]->initBuffer(sizeof(VkDrawIndexedIndirectCommand) * objectCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+
+		drawCountBuffers[i] = std::make_unique<Buffer>(vulkanContext.vulkanResources);
+		drawCountBuffers[i]->initBuffer(sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+
+		instanceBuffers[i] = std::make_unique<Buffer>(vulkanContext.vulkanResources);
+		instanceBuffers[i]->initBuffer(sizeof(uint32_t) * objectCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+
+		batchCountBuffers[i] = std::make_unique<Buffer>(vulkanContext.vulkanResources);
+		batchCountBuffers[i]->initBuffer(sizeof(uint32_t) * objectCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+
+		visibleInstanceBuffers[i] = std::make_unique<Buffer>(vulkanContext.vulkanResources);
+		visibleInstanceBuffers[i]->initBuffer(sizeof(uint32_t) * objectCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+
+		meshletDispatchBuffers[i] = std::make_unique<Buffer>(vulkanContext.vulkanResources);
+		meshletDispatchBuffers[i]->initBuffer(sizeof(MeshletDispatch), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+	}
+
+	visibilityBuffer = std::make_unique<Buffer>(vulkanContext.vulkanResources);
+	visibilityBuffer->initBuffer(sizeof(uint32_t) * objectCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+	isVisibilityReset = true;
+}
 
-		objectStorageBuffers[i].initStorageBuffer(sizeof(objectSSBO) * 1000);
-		lightStorageBuffers[i].initStorageBuffer(sizeof(lightSSBO) * 100);
+void Renderer::reserveDrawIndices(uint64_t requiredIndices)
+{
+	//A single storage range cannot be larger than the device allows, and nothing is drawn from outside of it
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(vulkanContext.vulkanResources.physicalDevice, &properties);
+	uint64_t maxIndices = properties.limits.maxStorageBufferRange / sizeof(uint32_t);
+
+	if (requiredIndices > maxIndices) {
+		throw std::runtime_error("Mesh indices exceed the maximum storage buffer range of the draw indices");
 	}
-	
+
+	uint64_t required = std::max<uint64_t>(requiredIndices, 1 << 16);
+	if (drawIndexBuffers[currentFrame] && required <= drawIndexCapacities[currentFrame]) {
+		return;
+	}
+
+	uint64_t capacity = std::max<uint64_t>(drawIndexCapacities[currentFrame], 1 << 16);
+	while (capacity < required) {
+		capacity = std::min(capacity * 2, maxIndices);
+	}
+	drawIndexCapacities[currentFrame] = static_cast<uint32_t>(capacity);
+
+	drawIndexBuffers[currentFrame] = std::make_unique<Buffer>(vulkanContext.vulkanResources);
+	drawIndexBuffers[currentFrame]->initBuffer(sizeof(uint32_t) * capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+}
+
+void Renderer::reserveMeshletMasks(uint32_t meshletCount)
+{
+	uint32_t required = std::max((meshletCount + 31) / 32, 1u);
+	if (meshletMaskBuffers[currentFrame] && required <= meshletMaskCapacities[currentFrame]) {
+		return;
+	}
+
+	meshletMaskCapacities[currentFrame] = std::max(required, meshletMaskCapacities[currentFrame] * 2);
+	meshletMaskBuffers[currentFrame] = std::make_unique<Buffer>(vulkanContext.vulkanResources);
+	meshletMaskBuffers[currentFrame]->initBuffer(sizeof(uint32_t) * meshletMaskCapacities[currentFrame], VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+}
+
+void Renderer::initHiZResources()
+{
+	VkExtent2D extent = swapchain.swapchain.extent;
+	hiZLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(extent.width, extent.height)))) + 1;
+	if (hiZLevels > DescriptorManager::MAX_HIZ_LEVELS) {
+		throw std::runtime_error("Depth buffer is too large for the hi-z pyramid");
+	}
+
+	hiZImage.initImage(VK_IMAGE_TYPE_2D, VK_FORMAT_R32_SFLOAT, { extent.width, extent.height, 1 },
+		VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VMA_MEMORY_USAGE_GPU_ONLY, hiZLevels);
+	hiZImage.initImageView(VK_IMAGE_VIEW_TYPE_2D, VK_FORMAT_R32_SFLOAT, { VK_IMAGE_ASPECT_COLOR_BIT, 0, hiZLevels, 0, 1 });
+
+	//Level 0 copies the depth buffer, every other level reduces the one above. Shaders only texelFetch, the sampler is unused
+	VkImageView sourceView = VK_NULL_HANDLE;
+	for (uint32_t level = 0; level < hiZLevels; ++level) {
+		DescriptorSet& hiZSet = descriptorManager.hiZDescriptorSets[level];
+		VkImageView levelView = hiZImage.createFaceMipView(0, level);
+
+		if (level == 0) {
+			hiZSet.update(DescriptorManager::HIZ_BINDING::SOURCE_IMAGE, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, { depthSampler, gBufferDepthImage.imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
+		}
+		else {
+			hiZSet.update(DescriptorManager::HIZ_BINDING::SOURCE_IMAGE, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, { depthSampler, sourceView, VK_IMAGE_LAYOUT_GENERAL });
+		}
+		hiZSet.update(DescriptorManager::HIZ_BINDING::DESTINATION_IMAGE, 0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, { VK_NULL_HANDLE, levelView, VK_IMAGE_LAYOUT_GENERAL });
+
+		sourceView = levelView;
+	}
+}
+
+void Renderer::recordHiZ(VkCommandBuffer commandBuffer)
+{
+	//The early depth is read by compute. The pyramid is rebuilt completely, its old contents can be dropped
+	//once the last frame's late culling is done reading them
+	VkImageMemoryBarrier barriers[2]{};
+	barriers[0].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barriers[0].oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	barriers[0].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barriers[0].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	barriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	barriers[0].image = gBufferDepthImage.image;
+	barriers[0].subresourceRange = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1 };
+
+	barriers[1].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barriers[1].newLayout = VK_IMAGE_LAYOUT_GENERAL;
+	barriers[1].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barriers[1].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barriers[1].srcAccessMask = 0;
+	barriers[1].dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barriers[1].image = hiZImage.image;
+	barriers[1].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, hiZLevels, 0, 1 };
+
+	vkCmdPipelineBarrier(
+		commandBuffer,
+		VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		0,
+		0, nullptr,
+		0, nullptr,
+		2, barriers
+	);
+
+	VkMemoryBarrier levelBarrier{};
+	levelBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	levelBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	levelBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+	//Every level waits for the one above, the last barrier is for the late culling
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, hiZPipeline.pipeline);
+	for (uint32_t level = 0; level < hiZLevels; ++level) {
+		uint32_t width = std::max(swapchain.swapchain.extent.width >> level, 1u);
+		uint32_t height = std::max(swapchain.swapchain.extent.height >> level, 1u);
+
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, hiZPipeline.pipelineLayout, 0, 1, &descriptorManager.hiZDescriptorSets[level].descriptorSet, 0, nullptr);
+		vkCmdDispatch(commandBuffer, (width + 7) / 8, (height + 7) / 8, 1);
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &levelBarrier, 0, nullptr, 0, nullptr);
+	}
+}
+
+void Renderer::updateCullingDescriptors()
+{
+	Buffer& drawCommands = *drawCommandBuffers[currentFrame];
+	Buffer& drawCount = *drawCountBuffers[currentFrame];
+	Buffer& instances = *instanceBuffers[currentFrame];
+	Buffer& batchCounts = *batchCountBuffers[currentFrame];
+	Buffer& visibleInstances = *visibleInstanceBuffers[currentFrame];
+	Buffer& meshletDispatch = *meshletDispatchBuffers[currentFrame];
+	Buffer* meshTable = meshRegistry.getMeshTable();
+	Buffer* meshlets = meshRegistry.getMeshletBuffer();
+	uint32_t batchCount = static_cast<uint32_t>(drawBatches.size());
+
+	bool isCulling = batchCount > 0 && meshTable && meshlets;
+
+	//Every batch has a mesh of its own, so a phase never keeps more indices than the bound index pool holds
+	reserveDrawIndices(meshRegistry.getIndexCount());
+	reserveMeshletMasks(meshRegistry.getMeshletCount());
+
+	//This frame's set is not in use, beginFrame waited for its last submit. The g-buffer reads the instances through it too.
+	//Written once, before anything bound it in this frame's command buffers
+	DescriptorSet& cullingSet = descriptorManager.cullingDescriptorSets[currentFrame];
+
+	//Nothing reads the mesh registry's buffers without batches, they only have to be valid
+	cullingSet.update(DescriptorManager::CULLING_BINDING::MESH_TABLE, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, { isCulling ? meshTable->buffer : instances.buffer, 0, VK_WHOLE_SIZE });
+	cullingSet.update(DescriptorManager::CULLING_BINDING::DRAW_COMMANDS, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, { drawCommands.buffer, 0, VK_WHOLE_SIZE });
+	cullingSet.update(DescriptorManager::CULLING_BINDING::DRAW_COUNT, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, { drawCount.buffer, 0, VK_WHOLE_SIZE });
+	cullingSet.update(DescriptorManager::CULLING_BINDING::DRAW_BATCHES, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, { frameRing.buffer, batchAllocation.offset, sizeof(DrawBatch) * std::max(batchCount, 1u) });
+	cullingSet.update(DescriptorManager::CULLING_BINDING::BATCH_COUNTS, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, { batchCounts.buffer, 0, VK_WHOLE_SIZE });
+	cullingSet.update(DescriptorManager::CULLING_BINDING::INSTANCES, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, { instances.buffer, 0, VK_WHOLE_SIZE });
+	cullingSet.update(DescriptorManager::CULLING_BINDING::VISIBILITY, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, { visibilityBuffer->buffer, 0, VK_WHOLE_SIZE });
+	cullingSet.update(DescriptorManager::CULLING_BINDING::HIZ_IMAGE, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, { depthSampler, hiZImage.imageView, VK_IMAGE_LAYOUT_GENERAL });
+	cullingSet.update(DescriptorManager::CULLING_BINDING::MESHLETS, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, { isCulling ? meshlets->buffer : instances.buffer, 0, VK_WHOLE_SIZE });
+	cullingSet.update(DescriptorManager::CULLING_BINDING::MESH_INDICES, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, { isCulling ? meshRegistry.getIndexBuffer().buffer : instances.buffer, 0, VK_WHOLE_SIZE });
+	cullingSet.update(DescriptorManager::CULLING_BINDING::VISIBLE_INSTANCES, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, { visibleInstances.buffer, 0, VK_WHOLE_SIZE });
+	cullingSet.update(DescriptorManager::CULLING_BINDING::MESHLET_DISPATCH, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, { meshletDispatch.buffer, 0, VK_WHOLE_SIZE });
+	cullingSet.update(DescriptorManager::CULLING_BINDING::DRAW_INDICES, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, { drawIndexBuffers[currentFrame]->buffer, 0, VK_WHOLE_SIZE });
+	cullingSet.update(DescriptorManager::CULLING_BINDING::MESHLET_MASKS, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, { meshletMaskBuffers[currentFrame]->buffer, 0, VK_WHOLE_SIZE });
+	cullingSet.update(DescriptorManager::CULLING_BINDING::DRAW_ORDER, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, { frameRing.buffer, drawOrderAllocation.offset, sizeof(uint32_t) * std::max(batchCount, 1u) });
+}
+
+void Renderer::recordCulling(VkCommandBuffer commandBuffer, const glm::mat4& viewProjection, CULLING_PHASE phase)
+{
+	Buffer& drawCommands = *drawCommandBuffers[currentFrame];
+	Buffer& drawCount = *drawCountBuffers[currentFrame];
+	Buffer& batchCounts = *batchCountBuffers[currentFrame];
+	Buffer& meshletDispatch = *meshletDispatchBuffers[currentFrame];
+	Buffer* meshTable = meshRegistry.getMeshTable();
+	Buffer* meshlets = meshRegistry.getMeshletBuffer();
+	uint32_t batchCount = static_cast<uint32_t>(drawBatches.size());
+
+	bool isCulling = batchCount > 0 && meshTable && meshlets;
+
+	if (phase == CULLING_PHASE::LATE) {
+		//The early draws have to be done with the draw buffers and indices before they are rebuilt
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+	}
+
+	vkCmdFillBuffer(commandBuffer, drawCount.buffer, 0, sizeof(uint32_t), 0);
+
+	if (isCulling) {
+		vkCmdFillBuffer(commandBuffer, batchCounts.buffer, 0, sizeof(uint32_t) * batchCount, 0);
+		vkCmdFillBuffer(commandBuffer, meshletMaskBuffers[currentFrame]->buffer, 0, VK_WHOLE_SIZE, 0);
+		//Draws sit at their batch's rank, the ones not written draw nothing
+		vkCmdFillBuffer(commandBuffer, drawCommands.buffer, 0, sizeof(VkDrawIndexedIndirectCommand) * batchCount, 0);
+
+		//No groups and no visible objects yet, the cull pass counts them up
+		MeshletDispatch dispatch{ { 0, 1, 1 }, 0, 0 };
+		vkCmdUpdateBuffer(commandBuffer, meshletDispatch.buffer, 0, sizeof(MeshletDispatch), &dispatch);
+
+		//The visibility buffer is shared by the frames in flight, the last frame's late culling wrote what this phase reads
+		if (phase == CULLING_PHASE::EARLY) {
+			VkBufferMemoryBarrier visibilityBarrier{};
+			visibilityBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			visibilityBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			visibilityBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			visibilityBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			visibilityBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			visibilityBarrier.buffer = visibilityBuffer->buffer;
+			visibilityBarrier.offset = 0;
+			visibilityBarrier.size = VK_WHOLE_SIZE;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &visibilityBarrier, 0, nullptr);
+		}
+
+		//Slots were reassigned, every object starts out visible and the late phase sorts them out.
+		//The last frame's late culling may still be using the buffer
+		if (phase == CULLING_PHASE::EARLY && isVisibilityReset) {
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+			vkCmdFillBuffer(commandBuffer, visibilityBuffer->buffer, 0, VK_WHOLE_SIZE, 1);
+			isVisibilityReset = false;
+		}
+
+		VkMemoryBarrier clearBarrier{};
+		clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+		//Planes from the rows of the view projection matrix. The near plane is the OpenGL one, which is never tighter
+		glm::mat4 m = glm::transpose(viewProjection);
+		CullingPushConstant push{};
+		push.planes[0] = m[3] + m[0];
+		push.planes[1] = m[3] - m[0];
+		push.planes[2] = m[3] + m[1];
+		push.planes[3] = m[3] - m[1];
+		push.planes[4] = m[3] + m[2];
+		push.planes[5] = m[3] - m[2];
+		//The projection has no far plane, its plane comes out empty and is made one that keeps everything
+		for (auto& plane : push.planes) {
+			float length = glm::length(glm::vec3(plane));
+			plane = length > 0.0f ? plane / length : glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		}
+		push.objectCount = objectCount;
+		push.meshCount = meshRegistry.getTableMeshCount();
+		push.batchCount = batchCount;
+		push.phase = phase;
+
+		std::array<VkDescriptorSet, 2> cullingSets{
+			descriptorManager.globalDescriptorSet.descriptorSet,
+			descriptorManager.cullingDescriptorSets[currentFrame].descriptorSet,
+		};
+
+		//Visible objects are appended to their batch's instances
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullingPipeline.pipeline);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullingPipeline.pipelineLayout, 0, cullingSets.size(), cullingSets.data(), static_cast<uint32_t>(globalOffsets.size()), globalOffsets.data());
+		vkCmdPushConstants(commandBuffer, cullingPipeline.pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullingPushConstant), &push);
+		vkCmdDispatch(commandBuffer, (objectCount + 63) / 64, 1, 1);
+
+		VkMemoryBarrier cullBarrier{};
+		cullBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		cullBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		cullBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &cullBarrier, 0, nullptr, 0, nullptr);
+
+		//One workgroup per visible object culls its meshlets and marks the survivors, the cull pass sized the dispatch
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, meshletPipeline.pipeline);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, meshletPipeline.pipelineLayout, 0, cullingSets.size(), cullingSets.data(), static_cast<uint32_t>(globalOffsets.size()), globalOffsets.data());
+		vkCmdPushConstants(commandBuffer, meshletPipeline.pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullingPushConstant), &push);
+		vkCmdDispatchIndirect(commandBuffer, meshletDispatch.buffer, 0);
+
+		VkMemoryBarrier meshletBarrier{};
+		meshletBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		meshletBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		meshletBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &meshletBarrier, 0, nullptr, 0, nullptr);
+
+		//One workgroup per batch compacts the marked meshlets of its mesh and draws them with every visible instance
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, drawBatchPipeline.pipeline);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, drawBatchPipeline.pipelineLayout, 0, cullingSets.size(), cullingSets.data(), static_cast<uint32_t>(globalOffsets.size()), globalOffsets.data());
+		vkCmdPushConstants(commandBuffer, drawBatchPipeline.pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullingPushConstant), &push);
+		vkCmdDispatch(commandBuffer, std::min(batchCount, MAX_DISPATCH_GROUPS), 1, 1);
+	}
+
+	VkMemoryBarrier drawBarrier{};
+	drawBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	drawBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	drawBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0, 1, &drawBarrier, 0, nullptr, 0, nullptr);
 }
 
 void Renderer::initSampler()
@@ -1254,6 +1544,111 @@ void Renderer::initGBufferPass()
 	std::vector<VkSubpassDependency> dependencies = { };
 
 	gBufferRenderPass.initRenderPass(attachments, subpasses, dependencies);
+
+	//Compatible with the framebuffer and pipeline, keeps what the early pass drew
+	for (auto& attachment : attachments) {
+		attachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+		attachment.initialLayout = attachment.finalLayout;
+	}
+	gBufferLateRenderPass.initRenderPass(attachments, subpasses, dependencies);
+}
+
+void Renderer::recordGBufferCommands(uint32_t job, uint32_t firstDraw, uint32_t drawCount)
+{
+	VkViewport viewport{};
+	viewport.x = 0.0f;
+	viewport.y = 0.0f;
+	viewport.width = static_cast<float>(swapchain.swapchain.extent.width);
+	viewport.height = static_cast<float>(swapchain.swapchain.extent.height);
+	viewport.minDepth = 0.0f;
+	viewport.maxDepth = 1.0f;
+
+	VkRect2D scissor{};
+	scissor.offset = { 0,0 };
+	scissor.extent = swapchain.swapchain.extent;
+
+	std::array<VkDescriptorSet, 3> gBufferSets{
+		descriptorManager.globalDescriptorSet.descriptorSet,
+		descriptorManager.bindlessResourceDescriptorSet.descriptorSet,
+		descriptorManager.cullingDescriptorSets[currentFrame].descriptorSet,
+	};
+
+	std::array<VkRenderPass, 2> renderPasses{ gBufferRenderPass.renderPass, gBufferLateRenderPass.renderPass };
+
+	//Secondaries inherit nothing but the render pass, everything is bound again
+	for (uint32_t phase = 0; phase < renderPasses.size(); ++phase) {
+		VkCommandBufferInheritanceInfo inheritanceInfo{};
+		inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		inheritanceInfo.renderPass = renderPasses[phase];
+		inheritanceInfo.subpass = 0;
+		inheritanceInfo.framebuffer = gBufferFramebuffer.framebuffer;
+
+		CommandBuffer& secondary = gBufferCommandBuffers[currentFrame][job * 2 + phase];
+		secondary.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT, &inheritanceInfo);
+		VkCommandBuffer commandBuffer = secondary.commandBuffer;
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, gBufferPipeline.pipeline);
+		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, gBufferPipeline.pipelineLayout, 0, gBufferSets.size(), gBufferSets.data(), static_cast<uint32_t>(globalOffsets.size()), globalOffsets.data());
+
+		//Vertices come from the mesh registry, indices from the visible meshlets
+		meshRegistry.bind(commandBuffer);
+		vkCmdBindIndexBuffer(commandBuffer, drawIndexBuffers[currentFrame]->buffer, 0, VK_INDEX_TYPE_UINT32);
+
+		//Draws sit at their batch's rank, in sort key order. The count is shared by all ranges: a range draws at most
+		//that many of its own, and the ones of batches without visible objects are empty
+		vkCmdDrawIndexedIndirectCount(commandBuffer, drawCommandBuffers[currentFrame]->buffer, sizeof(VkDrawIndexedIndirectCommand) * firstDraw, drawCountBuffers[currentFrame]->buffer, 0, drawCount, sizeof(VkDrawIndexedIndirectCommand));
+
+		secondary.end();
+	}
+}
+
+void Renderer::initCullingPipeline()
+{
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(CullingPushConstant);
+
+	std::array<VkDescriptorSetLayout, 2> descriptorSetLayouts = {
+		descriptorManager.globalDescriptorSetLayout,
+		descriptorManager.cullingDescriptorSetLayout,
+	};
+
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount = descriptorSetLayouts.size();
+	pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+	pipelineLayoutInfo.pushConstantRangeCount = 1;
+	pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+	auto cullShader = readFile("Shaders/cull.comp.spv");
+	VkShaderModule cullShaderModule = Pipeline::createShaderModule(vulkanContext.vulkanResources.device, cullShader);
+	cullingPipeline.initComputePipeline(cullShaderModule, pipelineLayoutInfo);
+	vkDestroyShaderModule(vulkanContext.vulkanResources.device, cullShaderModule, nullptr);
+
+	auto meshletShader = readFile("Shaders/meshletCull.comp.spv");
+	VkShaderModule meshletShaderModule = Pipeline::createShaderModule(vulkanContext.vulkanResources.device, meshletShader);
+	meshletPipeline.initComputePipeline(meshletShaderModule, pipelineLayoutInfo);
+	vkDestroyShaderModule(vulkanContext.vulkanResources.device, meshletShaderModule, nullptr);
+
+	auto drawBatchShader = readFile("Shaders/drawBatch.comp.spv");
+	VkShaderModule drawBatchShaderModule = Pipeline::createShaderModule(vulkanContext.vulkanResources.device, drawBatchShader);
+	drawBatchPipeline.initComputePipeline(drawBatchShaderModule, pipelineLayoutInfo);
+	vkDestroyShaderModule(vulkanContext.vulkanResources.device, drawBatchShaderModule, nullptr);
+
+	VkPipelineLayoutCreateInfo hiZPipelineLayoutInfo{};
+	hiZPipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	hiZPipelineLayoutInfo.setLayoutCount = 1;
+	hiZPipelineLayoutInfo.pSetLayouts = &descriptorManager.hiZDescriptorSetLayout;
+	hiZPipelineLayoutInfo.pushConstantRangeCount = 0;
+	hiZPipelineLayoutInfo.pPushConstantRanges = nullptr;
+
+	auto hiZShader = readFile("Shaders/hiZ.comp.spv");
+	VkShaderModule hiZShaderModule = Pipeline::createShaderModule(vulkanContext.vulkanResources.device, hiZShader);
+	hiZPipeline.initComputePipeline(hiZShaderModule, hiZPipelineLayoutInfo);
+	vkDestroyShaderModule(vulkanContext.vulkanResources.device, hiZShaderModule, nullptr);
 }
 
 void Renderer::initGBufferPipeline()
@@ -1286,8 +1681,8 @@ void Renderer::initGBufferPipeline()
 	};
 
 
-	auto bindingDescription = VertexBuffer::getBindingDescription();
-	auto attributeDescriptions = VertexBuffer::getAttributeDescription();
+	auto bindingDescription = Vertex::getBindingDescription();
+	auto attributeDescriptions = Vertex::getAttributeDescription();
 
 	VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
 	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -1348,22 +1743,17 @@ void Renderer::initGBufferPipeline()
 	colorBlendInfo.pAttachments = colorAttachments.data();
 
 
-	VkPushConstantRange pushConstantRange{};
-	pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-	pushConstantRange.offset = 0;
-	pushConstantRange.size = sizeof(PushConstant);
-
-	std::array<VkDescriptorSetLayout, 2> descriptorSetLayouts = {
+	//No push constants, the object index is looked up in the culling set's instances
+	std::array<VkDescriptorSetLayout, 3> descriptorSetLayouts = {
 		descriptorManager.globalDescriptorSetLayout,
 		descriptorManager.bindlessResourceDescriptorSetLayout,
+		descriptorManager.cullingDescriptorSetLayout,
 	};
 
 	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
 	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 	pipelineLayoutInfo.setLayoutCount = descriptorSetLayouts.size();
 	pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
-	pipelineLayoutInfo.pushConstantRangeCount = 1;
-	pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
 	gBufferPipeline.initPipeline(vertexShaderModule, fragmentShaderModule, pipelineLayoutInfo, rasterInfo, depthStencilInfo, colorBlendInfo, vertexInputInfo, inputAssemblyInfo, viewportState, multisamplingInfo, gBufferRenderPass.renderPass);
 
@@ -1627,418 +2017,47 @@ void Renderer::initLightingPipeline()
 
 void Renderer::initPreprocessIBLResources()
 {
-	irradianceCubeMapImage.initImage(VK_IMAGE_TYPE_2D, VK_FORMAT_R16G16B16A16_SFLOAT, { 32, 32, 1 }, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+	irradianceCubeMapImage.initImage(VK_IMAGE_TYPE_2D, VK_FORMAT_R16G16B16A16_SFLOAT, { 32, 32, 1 }, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
 		VMA_MEMORY_USAGE_GPU_ONLY, 1, 6, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT);
 	irradianceCubeMapImage.initImageView(VK_IMAGE_VIEW_TYPE_CUBE, VK_FORMAT_R16G16B16A16_SFLOAT, { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 6 });
 
-	prefilterCubeMapImage.initImage(VK_IMAGE_TYPE_2D, VK_FORMAT_R16G16B16A16_SFLOAT, { 128, 128, 1 }, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-		VMA_MEMORY_USAGE_GPU_ONLY, 5, 6, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT);
-	prefilterCubeMapImage.initImageView(VK_IMAGE_VIEW_TYPE_CUBE, VK_FORMAT_R16G16B16A16_SFLOAT, { VK_IMAGE_ASPECT_COLOR_BIT, 0, 5, 0, 6 });
+	prefilterCubeMapImage.initImage(VK_IMAGE_TYPE_2D, VK_FORMAT_R16G16B16A16_SFLOAT, { 128, 128, 1 }, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+		VMA_MEMORY_USAGE_GPU_ONLY, DescriptorManager::PREFILTER_MIPS, 6, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT);
+	prefilterCubeMapImage.initImageView(VK_IMAGE_VIEW_TYPE_CUBE, VK_FORMAT_R16G16B16A16_SFLOAT, { VK_IMAGE_ASPECT_COLOR_BIT, 0, DescriptorManager::PREFILTER_MIPS, 0, 6 });
 
-	brdfLUTImage.initImage(VK_IMAGE_TYPE_2D, VK_FORMAT_R16G16_SFLOAT, {512, 512, 1}, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+	brdfLUTImage.initImage(VK_IMAGE_TYPE_2D, VK_FORMAT_R16G16_SFLOAT, {512, 512, 1}, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
 		VMA_MEMORY_USAGE_GPU_ONLY, 1, 1, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_TILING_OPTIMAL);
 	brdfLUTImage.initImageView(VK_IMAGE_VIEW_TYPE_2D, VK_FORMAT_R16G16_SFLOAT, { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 });
-
-	irradianceFramebuffers.reserve(6);
-	for (size_t i = 0; i < 6; ++i) {
-		irradianceFramebuffers.emplace_back(vulkanContext.vulkanResources);
-	}
-
-	prefilterFramebuffers.resize(6);
-	for (size_t i = 0; i < 6; ++i) {
-		prefilterFramebuffers[i].reserve(5);
-		for (size_t j = 0; j < 5; ++j) {
-			prefilterFramebuffers[i].emplace_back(vulkanContext.vulkanResources);
-		}
-	}
-	
-}
-
-void Renderer::initPreprocessIBLPasses()
-{
-	{
-		VkAttachmentDescription colorAttachment{};
-		colorAttachment.format = VK_FORMAT_R16G16B16A16_SFLOAT;
-		colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-		colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-		VkAttachmentReference colorReference{};
-		colorReference.attachment = 0;
-		colorReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-		VkSubpassDescription subpass{};
-		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-		subpass.colorAttachmentCount = 1;
-		subpass.pColorAttachments = &colorReference;
-
-		std::vector<VkAttachmentDescription> attachments = { colorAttachment };
-		std::vector<VkSubpassDescription> subpasses = { subpass };
-		std::vector<VkSubpassDependency> dependencies = { };
-
-		irradiancePrefilterRenderPass.initRenderPass(attachments, subpasses, dependencies);
-	}
-
-	{
-		VkAttachmentDescription colorAttachment{};
-		colorAttachment.format = VK_FORMAT_R16G16_SFLOAT;
-		colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-		colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-		VkAttachmentReference colorReference{};
-		colorReference.attachment = 0;
-		colorReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-		VkSubpassDescription subpass{};
-		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-		subpass.colorAttachmentCount = 1;
-		subpass.pColorAttachments = &colorReference;
-
-		std::vector<VkAttachmentDescription> attachments = { colorAttachment };
-		std::vector<VkSubpassDescription> subpasses = { subpass };
-		std::vector<VkSubpassDependency> dependencies = { };
-
-		lutRenderPass.initRenderPass(attachments, subpasses, dependencies);
-	}
 }
 
 void Renderer::initPreprocessIBLPipelines()
 {
-	{
-		auto vertShader = readFile("Shaders/irradiance.vert.spv");
-		auto fragShader = readFile("Shaders/irradiance.frag.spv");
-
-		VkShaderModule vertexShaderModule = Pipeline::createShaderModule(vulkanContext.vulkanResources.device, vertShader);
-		VkShaderModule fragmentShaderModule = Pipeline::createShaderModule(vulkanContext.vulkanResources.device, fragShader);
-
-		VkPipelineShaderStageCreateInfo vertStateInfo{};
-		vertStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		vertStateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-		vertStateInfo.module = vertexShaderModule;
-		vertStateInfo.pName = "main";
-
-		VkPipelineShaderStageCreateInfo fragStateInfo{};
-		fragStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		fragStateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-		fragStateInfo.module = fragmentShaderModule;
-		fragStateInfo.pName = "main";
-
-		VkPipelineShaderStageCreateInfo shaderStages[] = { vertStateInfo, fragStateInfo };
-
-
-
-		std::vector<VkDynamicState> dynamicStates{
-			VK_DYNAMIC_STATE_VIEWPORT,
-			VK_DYNAMIC_STATE_SCISSOR
-		};
-
-
-		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		vertexInputInfo.vertexBindingDescriptionCount = 0;
-		vertexInputInfo.vertexAttributeDescriptionCount = 0;
-
-		VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo{};
-		inputAssemblyInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-		inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-		inputAssemblyInfo.primitiveRestartEnable = VK_FALSE;
-
-
-		VkPipelineDynamicStateCreateInfo dynamicStateInfo{};
-		dynamicStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-		dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-		dynamicStateInfo.pDynamicStates = dynamicStates.data();
-
-		VkPipelineViewportStateCreateInfo viewportState{};
-		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-		viewportState.viewportCount = 1;
-		viewportState.scissorCount = 1;
-
-		VkPipelineRasterizationStateCreateInfo rasterInfo{};
-		rasterInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-		rasterInfo.depthClampEnable = VK_FALSE;
-		rasterInfo.rasterizerDiscardEnable = VK_FALSE;
-		rasterInfo.polygonMode = VK_POLYGON_MODE_FILL;
-		rasterInfo.lineWidth = 1.0f;
-		rasterInfo.cullMode = VK_CULL_MODE_NONE;
-		rasterInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-		rasterInfo.depthBiasEnable = VK_FALSE;
-
-		VkPipelineDepthStencilStateCreateInfo depthStencilInfo{};
-		depthStencilInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-		depthStencilInfo.depthTestEnable = VK_FALSE;
-		depthStencilInfo.depthWriteEnable = VK_FALSE;
-		depthStencilInfo.depthCompareOp = VK_COMPARE_OP_ALWAYS;
-		depthStencilInfo.stencilTestEnable = VK_FALSE;
-		/*depthStencilInfo.depthTestEnable = VK_TRUE;
-		depthStencilInfo.depthWriteEnable = VK_TRUE;
-		depthStencilInfo.depthCompareOp = VK_COMPARE_OP_LESS;
-		depthStencilInfo.depthBoundsTestEnable = VK_FALSE;
-		depthStencilInfo.stencilTestEnable = VK_FALSE;*/
-
-		VkPipelineMultisampleStateCreateInfo multisamplingInfo{};
-		multisamplingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-		multisamplingInfo.sampleShadingEnable = VK_FALSE;
-		multisamplingInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-
-		VkPipelineColorBlendAttachmentState colorBlendAttachmentState{};
-		colorBlendAttachmentState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-		colorBlendAttachmentState.blendEnable = VK_FALSE;
-
-		VkPipelineColorBlendStateCreateInfo colorBlendInfo{};
-		colorBlendInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-		colorBlendInfo.logicOpEnable = VK_FALSE;
-		colorBlendInfo.attachmentCount = 1;
-		colorBlendInfo.pAttachments = &colorBlendAttachmentState;
-
-		VkPushConstantRange pushConstantRange{};
-		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-		pushConstantRange.offset = 0;
-		pushConstantRange.size = sizeof(SkyboxPreprocessPushConstant);
-
-		std::array<VkDescriptorSetLayout, 1> descriptorSetLayouts = {
-			descriptorManager.bindlessResourceDescriptorSetLayout
-		};
-
-		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipelineLayoutInfo.setLayoutCount = descriptorSetLayouts.size();
-		pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
-		pipelineLayoutInfo.pushConstantRangeCount = 1;
-		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
-
-		irradiancePipeline.initPipeline(vertexShaderModule, fragmentShaderModule, pipelineLayoutInfo, rasterInfo, depthStencilInfo, colorBlendInfo, vertexInputInfo, inputAssemblyInfo, viewportState, multisamplingInfo, irradiancePrefilterRenderPass.renderPass);
-
-		vkDestroyShaderModule(vulkanContext.vulkanResources.device, vertexShaderModule, nullptr);
-		vkDestroyShaderModule(vulkanContext.vulkanResources.device, fragmentShaderModule, nullptr);
-	}
-
-	{
-		auto vertShader = readFile("Shaders/prefilter.vert.spv");
-		auto fragShader = readFile("Shaders/prefilter.frag.spv");
-
-		VkShaderModule vertexShaderModule = Pipeline::createShaderModule(vulkanContext.vulkanResources.device, vertShader);
-		VkShaderModule fragmentShaderModule = Pipeline::createShaderModule(vulkanContext.vulkanResources.device, fragShader);
-
-		VkPipelineShaderStageCreateInfo vertStateInfo{};
-		vertStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		vertStateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-		vertStateInfo.module = vertexShaderModule;
-		vertStateInfo.pName = "main";
-
-		VkPipelineShaderStageCreateInfo fragStateInfo{};
-		fragStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		fragStateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-		fragStateInfo.module = fragmentShaderModule;
-		fragStateInfo.pName = "main";
-
-		VkPipelineShaderStageCreateInfo shaderStages[] = { vertStateInfo, fragStateInfo };
-
-
-
-		std::vector<VkDynamicState> dynamicStates{
-			VK_DYNAMIC_STATE_VIEWPORT,
-			VK_DYNAMIC_STATE_SCISSOR
-		};
-
-
-		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		vertexInputInfo.vertexBindingDescriptionCount = 0;
-		vertexInputInfo.vertexAttributeDescriptionCount = 0;
-
-		VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo{};
-		inputAssemblyInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-		inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-		inputAssemblyInfo.primitiveRestartEnable = VK_FALSE;
-
-
-		VkPipelineDynamicStateCreateInfo dynamicStateInfo{};
-		dynamicStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-		dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-		dynamicStateInfo.pDynamicStates = dynamicStates.data();
-
-		VkPipelineViewportStateCreateInfo viewportState{};
-		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-		viewportState.viewportCount = 1;
-		viewportState.scissorCount = 1;
-
-		VkPipelineRasterizationStateCreateInfo rasterInfo{};
-		rasterInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-		rasterInfo.depthClampEnable = VK_FALSE;
-		rasterInfo.rasterizerDiscardEnable = VK_FALSE;
-		rasterInfo.polygonMode = VK_POLYGON_MODE_FILL;
-		rasterInfo.lineWidth = 1.0f;
-		rasterInfo.cullMode = VK_CULL_MODE_NONE;
-		rasterInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-		rasterInfo.depthBiasEnable = VK_FALSE;
-
-		VkPipelineDepthStencilStateCreateInfo depthStencilInfo{};
-		depthStencilInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-		depthStencilInfo.depthTestEnable = VK_FALSE;
-		depthStencilInfo.depthWriteEnable = VK_FALSE;
-		depthStencilInfo.depthCompareOp = VK_COMPARE_OP_ALWAYS;
-		depthStencilInfo.stencilTestEnable = VK_FALSE;
-		/*depthStencilInfo.depthTestEnable = VK_TRUE;
-		depthStencilInfo.depthWriteEnable = VK_TRUE;
-		depthStencilInfo.depthCompareOp = VK_COMPARE_OP_LESS;
-		depthStencilInfo.depthBoundsTestEnable = VK_FALSE;
-		depthStencilInfo.stencilTestEnable = VK_FALSE;*/
-
-		VkPipelineMultisampleStateCreateInfo multisamplingInfo{};
-		multisamplingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-		multisamplingInfo.sampleShadingEnable = VK_FALSE;
-		multisamplingInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-
-		VkPipelineColorBlendAttachmentState colorBlendAttachmentState{};
-		colorBlendAttachmentState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-		colorBlendAttachmentState.blendEnable = VK_FALSE;
-
-		VkPipelineColorBlendStateCreateInfo colorBlendInfo{};
-		colorBlendInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-		colorBlendInfo.logicOpEnable = VK_FALSE;
-		colorBlendInfo.attachmentCount = 1;
-		colorBlendInfo.pAttachments = &colorBlendAttachmentState;
-
-		VkPushConstantRange pushConstantRange{};
-		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-		pushConstantRange.offset = 0;
-		pushConstantRange.size = sizeof(SkyboxPreprocessPushConstant);
-
-		std::array<VkDescriptorSetLayout, 1> descriptorSetLayouts = {
-			descriptorManager.bindlessResourceDescriptorSetLayout
-		};
-
-		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipelineLayoutInfo.setLayoutCount = descriptorSetLayouts.size();
-		pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
-		pipelineLayoutInfo.pushConstantRangeCount = 1;
-		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
-
-		prefilterPipeline.initPipeline(vertexShaderModule, fragmentShaderModule, pipelineLayoutInfo, rasterInfo, depthStencilInfo, colorBlendInfo, vertexInputInfo, inputAssemblyInfo, viewportState, multisamplingInfo, irradiancePrefilterRenderPass.renderPass);
-
-		vkDestroyShaderModule(vulkanContext.vulkanResources.device, vertexShaderModule, nullptr);
-		vkDestroyShaderModule(vulkanContext.vulkanResources.device, fragmentShaderModule, nullptr);
-	}
-
-	{
-		auto vertShader = readFile("Shaders/brdfLUT.vert.spv");
-		auto fragShader = readFile("Shaders/brdfLUT.frag.spv");
-
-		VkShaderModule vertexShaderModule = Pipeline::createShaderModule(vulkanContext.vulkanResources.device, vertShader);
-		VkShaderModule fragmentShaderModule = Pipeline::createShaderModule(vulkanContext.vulkanResources.device, fragShader);
-
-		VkPipelineShaderStageCreateInfo vertStateInfo{};
-		vertStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		vertStateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-		vertStateInfo.module = vertexShaderModule;
-		vertStateInfo.pName = "main";
-
-		VkPipelineShaderStageCreateInfo fragStateInfo{};
-		fragStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		fragStateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-		fragStateInfo.module = fragmentShaderModule;
-		fragStateInfo.pName = "main";
-
-		VkPipelineShaderStageCreateInfo shaderStages[] = { vertStateInfo, fragStateInfo };
-
-
-
-		std::vector<VkDynamicState> dynamicStates{
-			VK_DYNAMIC_STATE_VIEWPORT,
-			VK_DYNAMIC_STATE_SCISSOR
-		};
-
-
-		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		vertexInputInfo.vertexBindingDescriptionCount = 0;
-		vertexInputInfo.vertexAttributeDescriptionCount = 0;
-
-		VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo{};
-		inputAssemblyInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-		inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-		inputAssemblyInfo.primitiveRestartEnable = VK_FALSE;
-
-
-		VkPipelineDynamicStateCreateInfo dynamicStateInfo{};
-		dynamicStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-		dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-		dynamicStateInfo.pDynamicStates = dynamicStates.data();
-
-		VkPipelineViewportStateCreateInfo viewportState{};
-		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-		viewportState.viewportCount = 1;
-		viewportState.scissorCount = 1;
-
-		VkPipelineRasterizationStateCreateInfo rasterInfo{};
-		rasterInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-		rasterInfo.depthClampEnable = VK_FALSE;
-		rasterInfo.rasterizerDiscardEnable = VK_FALSE;
-		rasterInfo.polygonMode = VK_POLYGON_MODE_FILL;
-		rasterInfo.lineWidth = 1.0f;
-		rasterInfo.cullMode = VK_CULL_MODE_NONE;
-		rasterInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-		rasterInfo.depthBiasEnable = VK_FALSE;
-
-		VkPipelineDepthStencilStateCreateInfo depthStencilInfo{};
-		depthStencilInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-		depthStencilInfo.depthTestEnable = VK_FALSE;
-		depthStencilInfo.depthWriteEnable = VK_FALSE;
-		depthStencilInfo.depthCompareOp = VK_COMPARE_OP_ALWAYS;
-		depthStencilInfo.stencilTestEnable = VK_FALSE;
-		/*depthStencilInfo.depthTestEnable = VK_TRUE;
-		depthStencilInfo.depthWriteEnable = VK_TRUE;
-		depthStencilInfo.depthCompareOp = VK_COMPARE_OP_LESS;
-		depthStencilInfo.depthBoundsTestEnable = VK_FALSE;
-		depthStencilInfo.stencilTestEnable = VK_FALSE;*/
-
-		VkPipelineMultisampleStateCreateInfo multisamplingInfo{};
-		multisamplingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-		multisamplingInfo.sampleShadingEnable = VK_FALSE;
-		multisamplingInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-
-		VkPipelineColorBlendAttachmentState colorBlendAttachmentState{};
-		colorBlendAttachmentState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-		colorBlendAttachmentState.blendEnable = VK_FALSE;
-
-		VkPipelineColorBlendStateCreateInfo colorBlendInfo{};
-		colorBlendInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-		colorBlendInfo.logicOpEnable = VK_FALSE;
-		colorBlendInfo.attachmentCount = 1;
-		colorBlendInfo.pAttachments = &colorBlendAttachmentState;
-
-		VkPushConstantRange pushConstantRange{};
-		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-		pushConstantRange.offset = 0;
-		pushConstantRange.size = sizeof(SkyboxPreprocessPushConstant);
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(SkyboxPreprocessPushConstant);
 
-		std::array<VkDescriptorSetLayout, 1> descriptorSetLayouts = {
-			descriptorManager.bindlessResourceDescriptorSetLayout
-		};
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount = 1;
+	pipelineLayoutInfo.pSetLayouts = &descriptorManager.iblDescriptorSetLayout;
+	pipelineLayoutInfo.pushConstantRangeCount = 1;
+	pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
-		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipelineLayoutInfo.setLayoutCount = descriptorSetLayouts.size();
-		pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
-		pipelineLayoutInfo.pushConstantRangeCount = 1;
-		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+	auto irradianceShader = readFile("Shaders/irradiance.comp.spv");
+	VkShaderModule irradianceShaderModule = Pipeline::createShaderModule(vulkanContext.vulkanResources.device, irradianceShader);
+	irradiancePipeline.initComputePipeline(irradianceShaderModule, pipelineLayoutInfo);
+	vkDestroyShaderModule(vulkanContext.vulkanResources.device, irradianceShaderModule, nullptr);
 
-		lutPipeline.initPipeline(vertexShaderModule, fragmentShaderModule, pipelineLayoutInfo, rasterInfo, depthStencilInfo, colorBlendInfo, vertexInputInfo, inputAssemblyInfo, viewportState, multisamplingInfo, lutRenderPass.renderPass);
+	auto prefilterShader = readFile("Shaders/prefilter.comp.spv");
+	VkShaderModule prefilterShaderModule = Pipeline::createShaderModule(vulkanContext.vulkanResources.device, prefilterShader);
+	prefilterPipeline.initComputePipeline(prefilterShaderModule, pipelineLayoutInfo);
+	vkDestroyShaderModule(vulkanContext.vulkanResources.device, prefilterShaderModule, nullptr);
 
-		vkDestroyShaderModule(vulkanContext.vulkanResources.device, vertexShaderModule, nullptr);
-		vkDestroyShaderModule(vulkanContext.vulkanResources.device, fragmentShaderModule, nullptr);
-	}
+	auto lutShader = readFile("Shaders/brdfLUT.comp.spv");
+	VkShaderModule lutShaderModule = Pipeline::createShaderModule(vulkanContext.vulkanResources.device, lutShader);
+	lutPipeline.initComputePipeline(lutShaderModule, pipelineLayoutInfo);
+	vkDestroyShaderModule(vulkanContext.vulkanResources.device, lutShaderModule, nullptr);
 }
 
 void Renderer::initRayTracingPipeline(VkCommandBuffer commandBuffer)
@@ -2050,11 +2069,11 @@ void Renderer::initRayTracingPipeline(VkCommandBuffer commandBuffer)
 	VkAccelerationStructureGeometryTrianglesDataKHR	triangles{};
 	triangles.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
 	triangles.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT;
-	triangles.vertexData.deviceAddress = mainVertexBuffer.getDeviceAddress();
+	triangles.vertexData.deviceAddress = meshRegistry.getVertexBuffer().getDeviceAddress();
 	triangles.vertexStride = sizeof(Vertex);
 	triangles.indexType = VK_INDEX_TYPE_UINT32;
-	triangles.indexData.deviceAddress = mainIndexBuffer.getDeviceAddress();
-	triangles.maxVertex = mainVertexBuffer.vertexCount;
+	triangles.indexData.deviceAddress = meshRegistry.getIndexBuffer().getDeviceAddress();
+	triangles.maxVertex = meshRegistry.getVertexCount();
 
 	VkAccelerationStructureGeometryKHR geometry{};
 	geometry.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
@@ -2072,7 +2091,7 @@ void Renderer::initRayTracingPipeline(VkCommandBuffer commandBuffer)
 	VkAccelerationStructureBuildSizesInfoKHR sizeInfo{};
 	sizeInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
 
-	uint32_t primitiveCount = static_cast<uint32_t>(mainIndexBuffer.indexCount / 3);
+	uint32_t primitiveCount = meshRegistry.getIndexCount() / 3;
 
 	vkGetAccelerationStructureBuildSizesKHR(vulkanContext.vulkanResources.device, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &buildInfo, &primitiveCount, &sizeInfo);
 
@@ -2228,7 +2247,7 @@ void Renderer::initRayTracingPipeline(VkCommandBuffer commandBuffer)
 	descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
 	descriptorWrite.pNext = &accelerationStructureWrite;
 
-	descriptorManager.raytracingDescriptorSet.update(DescriptorManager::GLOBAL_BINDING::GLOBAL_UBO, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, { globalUniformBuffers[currentFrame].buffer, 0, VK_WHOLE_SIZE });
+	descriptorManager.raytracingDescriptorSet.update(DescriptorManager::GLOBAL_BINDING::GLOBAL_UBO, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, { frameRing.buffer, globalOffsets[DescriptorManager::GLOBAL_OFFSET::GLOBAL_UBO_OFFSET], sizeof(globalUBO) });
 
 
 
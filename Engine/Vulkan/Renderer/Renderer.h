@@ -9,11 +9,13 @@
 #include "../Abstractions/Framebuffer/Framebuffer.h"
 #include "../Abstractions/CommandPool/CommandPool.h"
 #include "../Abstractions/CommandBuffer/CommandBuffer.h"
+#include "../Abstractions/Timeline/Timeline.h"
 #include "../Abstractions/Buffer/Buffer.h"
 #include "../Abstractions/Buffer/VertexBuffer/VertexBuffer.h"
 #include "../Abstractions/Buffer/IndexBuffer/IndexBuffer.h"
 #include "../Abstractions/Buffer/UniformBuffer/UniformBuffer.h"
 #include "../Abstractions/Buffer/StorageBuffer/StorageBuffer.h"
+#include "../Abstractions/Buffer/RingBuffer/RingBuffer.h"
 #include "../Abstractions/DescriptorPool/DescriptorPool.h"
 #include "../Abstractions/DescriptorSet/DescriptorSet.h"
 #include "../Abstractions/Image/Image.h"
@@ -32,9 +34,12 @@
 
 #include "../../Engine/ECS/ECS.h"
 #include "../DescriptorManager/DescriptorManager.h"
+#include "../MeshRegistry/MeshRegistry.h"
+#include "../UploadEngine/UploadEngine.h"
+#include "../AsyncCompute/AsyncCompute.h"
 #include "../../Engine/Camera/Camera.h"
 #include "../../Engine/ResourceManager/ResourceManager.h"
-#include "../Abstractions/Buffer/StagingBuffer/StagingBuffer.h"
+#include "../../Engine/RadixSort/RadixSort.h"
 
 
 
@@ -55,7 +60,9 @@ struct MAX_RESOURCE_COUNT {
 struct PushConstant {
 	uint32_t ssboIndex;
 	uint32_t skyboxIndex;
-	uint32_t padding[2];
+	//0 until the ibl maps were computed and handed to graphics
+	uint32_t isEnvironmentReady;
+	uint32_t padding;
 };
 
 struct SkyboxPreprocessPushConstant {
@@ -77,12 +84,75 @@ struct globalUBO {
 
 struct objectSSBO {
 	glm::mat4 model;
+	glm::mat3x4 normalMatrix;
 	uint32_t albedoIndex;
 	uint32_t roughnessIndex;
 	uint32_t normalIndex;
 	uint32_t occlusionIndex;
 	uint32_t emissiveIndex;
-	uint32_t padding[3];
+	uint32_t batchIndex;
+	uint32_t padding[2];
+};
+
+//Objects sharing a mesh, drawn as one instanced draw. Their object indices live at firstInstance in the instance buffer
+struct DrawBatch {
+	uint32_t meshId;
+	uint32_t firstInstance;
+	uint32_t instanceCount;
+};
+
+//World space frustum planes (normals point inwards), matches the culling shaders
+struct CullingPushConstant {
+	glm::vec4 planes[6];
+	uint32_t objectCount;
+	uint32_t meshCount;
+	uint32_t batchCount;
+	uint32_t phase;
+};
+
+//Indirect dispatch of the meshlet pass and its counters, matches MeshletDispatch in the culling shaders
+struct MeshletDispatch {
+	VkDispatchIndirectCommand groupCount;
+	uint32_t visibleCount;
+	uint32_t indexCount;
+};
+
+//Early draws what was visible last frame, late draws what the hi-z pyramid of the early pass newly reveals
+enum CULLING_PHASE : uint32_t {
+	EARLY = 0,
+	LATE = 1
+};
+
+//A page of objects has to fit the smallest storage range and the largest offset alignment a device may have
+static_assert(sizeof(objectSSBO) * DescriptorManager::OBJECTS_PER_PAGE <= (1u << 27) && sizeof(objectSSBO) * DescriptorManager::OBJECTS_PER_PAGE % 256 == 0, "Object page does not fit a storage buffer range");
+
+//Sort key of a draw, smallest first. Pipeline, material and mesh make up the state, the depth bucket is the distance
+//to the camera with 256 buckets per doubling. Fields are masked to their bits
+struct DrawKey {
+	enum ORDER : uint32_t {
+		//State first, depth last. Fewest pipeline, texture and vertex changes, for passes that shade
+		STATE = 0,
+		//Depth first, nearest first. For passes that only write depth, where early rejection is what counts
+		FRONT_TO_BACK = 1
+	};
+
+	static constexpr uint32_t PIPELINE_BITS = 8;
+	static constexpr uint32_t MATERIAL_BITS = 24;
+	static constexpr uint32_t MESH_BITS = 20;
+	static constexpr uint32_t DEPTH_BITS = 12;
+
+	static uint64_t getDepthBucket(float distance) {
+		float bucket = std::log2(1.0f + (distance > 0.0f ? distance : 0.0f)) * 256.0f;
+		return static_cast<uint64_t>(std::min(bucket, static_cast<float>((1u << DEPTH_BITS) - 1)));
+	}
+
+	static uint64_t make(ORDER order, uint32_t pipeline, uint32_t material, uint32_t mesh, float distance) {
+		uint64_t state = static_cast<uint64_t>(pipeline & ((1u << PIPELINE_BITS) - 1)) << (MATERIAL_BITS + MESH_BITS)
+			| static_cast<uint64_t>(material & ((1u << MATERIAL_BITS) - 1)) << MESH_BITS
+			| (mesh & ((1u << MESH_BITS) - 1));
+		uint64_t depth = getDepthBucket(distance);
+		return order == STATE ? state << DEPTH_BITS | depth : depth << (64 - DEPTH_BITS) | state;
+	}
 };
 
 //0 - Directional
@@ -112,21 +182,52 @@ public:
 
 	bool beginFrame();
 	void submit(ECS& ecs, Camera& camera);
-	void submit2(ECS& ecs, Camera& camera);
+	void updateScene(ECS& ecs);
+	//Ranks every batch by its sort key, the g-buffer draws batches in rank order. Batches are only re-sorted when they
+	//were rebuilt or the camera moved to another cell. Call after updateScene
+	void sortDraws(ECS& ecs, const Camera& camera, DrawKey::ORDER order);
+	//Frees the mesh's gpu geometry (streaming). Meshes still using the id draw nothing
+	void removeMesh(uint32_t meshId);
 	void endFrame();
 
 	bool preprocess(ResourceManager& resourceManager);
-	bool handleResourcesUpload(ResourceManager& resourceManager, VkCommandBuffer& commandBuffer);
-	bool computeSkyBoxMaps(VkCommandBuffer& commandBuffer);
+	//Queues every loaded image on the upload engine, each frame's submit streams a budget of them. Call once per frame,
+	//images are bound as soon as their last layer went out
+	void handleResourcesUpload(ResourceManager& resourceManager);
+	//Schedules the ibl maps of the skybox on the async compute queue, frames light with them once they are done
+	void computeSkyBoxMaps();
+
+	//Runs job on the async compute queue next to the frames, see AsyncCompute. Its results are handed back at the
+	//start of a later frame, never before the frame that scheduled it was submitted
+	void scheduleCompute(AsyncCompute::Job job) {
+		asyncCompute.schedule(std::move(job));
+	}
 
 
 	void recreateSwapchain();
 	
+	//Updating Global Descriptors, the ranges are fixed and every frame selects its region with dynamic offsets.
+	//Rewritten whenever the frame ring is reallocated
+	void bindGlobalDescriptors() {
+		descriptorManager.globalDescriptorSet.update(DescriptorManager::GLOBAL_BINDING::GLOBAL_UBO, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, { frameRing.buffer, 0, sizeof(globalUBO) });
+
+		//Every page gets the frame's object offset on top of its own. Pages past the capacity are never read, they repeat the first one
+		VkDeviceSize pageSize = sizeof(objectSSBO) * DescriptorManager::OBJECTS_PER_PAGE;
+		VkDeviceSize objectSize = sizeof(objectSSBO) * objectCapacity;
+		for (uint32_t page = 0; page < DescriptorManager::OBJECT_PAGES; ++page) {
+			VkDeviceSize pageOffset = page * pageSize < objectSize ? page * pageSize : 0;
+			descriptorManager.globalDescriptorSet.update(DescriptorManager::GLOBAL_BINDING::OBJECT_SSBO, page, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, { frameRing.buffer, pageOffset, std::min(pageSize, objectSize - pageOffset) });
+		}
+
+		descriptorManager.globalDescriptorSet.update(DescriptorManager::GLOBAL_BINDING::LIGHTING_SSBO, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, { frameRing.buffer, 0, sizeof(lightSSBO) * lightCapacity });
+	}
+
 	void bindDescriptors() {
 		//TODO: Ray Tracing Resources
 
 
-		
+		bindGlobalDescriptors();
+
 
 		//Updating Target Descriptors
 		descriptorManager.targetDescriptorSet.update(DescriptorManager::TARGET_BINDING::ALBEDO_IMAGE, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, { textureSampler, gBufferAlbedoImage.imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
@@ -134,23 +235,58 @@ public:
 		descriptorManager.targetDescriptorSet.update(DescriptorManager::TARGET_BINDING::MATERIAL_IMAGE, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, { textureSampler, gBufferMaterialImage.imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
 		descriptorManager.targetDescriptorSet.update(DescriptorManager::TARGET_BINDING::LIGHTING_IMAGE, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, { textureSampler, lightingImage.imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
 		descriptorManager.targetDescriptorSet.update(DescriptorManager::TARGET_BINDING::DEPTH_IMAGE, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, { depthSampler, gBufferDepthImage.imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
-		descriptorManager.targetDescriptorSet.update(DescriptorManager::TARGET_BINDING::SKYBOX_IRRADIANCE_IMAGE, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, { cubemapSampler, irradianceCubeMapImage.imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
-		descriptorManager.targetDescriptorSet.update(DescriptorManager::TARGET_BINDING::SKYBOX_PREFILTER_IMAGE, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, { cubemapSampler, prefilterCubeMapImage.imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
-		descriptorManager.targetDescriptorSet.update(DescriptorManager::TARGET_BINDING::SKYBOX_LUT_IMAGE, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, { textureSampler, brdfLUTImage.imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
 		descriptorManager.targetDescriptorSet.update(DescriptorManager::TARGET_BINDING::POSITION_IMAGE, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, {textureSampler, gBufferPositionImage.imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
 		//descriptorManager.targetDescriptorSet.update(DescriptorManager::TARGET_BINDING::RAY_TRACING_IMAGE, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, { textureSampler, rayTracingImage.imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
 		
+		if (isEnvironmentReady) {
+			bindEnvironmentDescriptors();
+		}
+	}
+
+	//Only once the ibl maps were acquired, frames still in flight do not read these bindings
+	void bindEnvironmentDescriptors() {
+		descriptorManager.targetDescriptorSet.update(DescriptorManager::TARGET_BINDING::SKYBOX_IRRADIANCE_IMAGE, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, { cubemapSampler, irradianceCubeMapImage.imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
+		descriptorManager.targetDescriptorSet.update(DescriptorManager::TARGET_BINDING::SKYBOX_PREFILTER_IMAGE, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, { cubemapSampler, prefilterCubeMapImage.imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
+		descriptorManager.targetDescriptorSet.update(DescriptorManager::TARGET_BINDING::SKYBOX_LUT_IMAGE, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, { textureSampler, brdfLUTImage.imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
 	}
 
 public:
 
 	float getAspectRatio() const { return static_cast<float>(swapchain.swapchain.extent.width) / static_cast<float>(swapchain.swapchain.extent.height); }
 
+	//Optional, set by App before init
+	JobSystem* jobSystem = nullptr;
+
+	//Set before init, 1 to MAX_FRAMES_IN_FLIGHT. More frames hide cpu spikes at the cost of latency and memory
+	static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+	uint32_t maxFramesInFlight = 2;
+	//Set before init. Size of the upload staging ring, larger uploads stream through it over several frames
+	VkDeviceSize uploadStagingSize = 32 * 1024 * 1024;
+
+	//Timeline value the current frame signals once its gpu work is done. Only known after submit, before it
+	//the value of the frame's previous use is returned
+	uint64_t getFrameValue() const {
+		return frameValues.empty() ? 0 : frameValues[currentFrame];
+	}
+
+	//Waits for a value from getFrameValue instead of the whole device
+	void waitForFrame(uint64_t value) {
+		frameTimeline.wait(value);
+	}
+
+	//Runs release once the next submit (the frame being recorded) and everything before it is done on the gpu.
+	//For resources recorded work may still read, destroying them right away would need vkDeviceWaitIdle
+	void releaseAfterFrame(std::function<void()> release) {
+		frameTimeline.release(frameTimeline.getSubmittedValue() + 1, std::move(release));
+	}
+
 private:
 	void initCommandBuffers();
 	void initSyncObjects();
-	void initUniformBuffers();
-	void initStorageBuffers();
+	void initFrameRing();
+
+	//Grows object and light capacity geometrically and reallocates the frame ring when the scene outgrows it
+	void reserveFrameStorage(uint32_t requiredObjects, uint32_t requiredLights);
 
 
 	VulkanContext& vulkanContext;
@@ -169,10 +305,59 @@ private:
 	RenderPass swapchainRenderPass{ vulkanContext.vulkanResources };
 	Pipeline swapchainPipeline{ vulkanContext.vulkanResources };
 	void initSwapchainResources();
+	//Everything sized by the swapchain extent, recreateSwapchain remakes it with the init functions
+	void destroySwapchainResources();
 	void initSwapchainRenderPass();
 	void initSwapchainPipeline();
 	//Swapchain / Blit Pass
 
+	//Culling
+	Pipeline cullingPipeline{ vulkanContext.vulkanResources };
+	Pipeline meshletPipeline{ vulkanContext.vulkanResources };
+	Pipeline drawBatchPipeline{ vulkanContext.vulkanResources };
+	Pipeline hiZPipeline{ vulkanContext.vulkanResources };
+
+	//Smallest workgroup count every device dispatches, matches the culling shaders. Passes with more work loop
+	static constexpr uint32_t MAX_DISPATCH_GROUPS = 65535;
+
+	//Written by the culling passes and consumed by the g-buffer's indirect draw, one of each per frame in flight
+	std::vector<std::unique_ptr<Buffer>> drawCommandBuffers;
+	std::vector<std::unique_ptr<Buffer>> drawCountBuffers;
+	std::vector<std::unique_ptr<Buffer>> instanceBuffers;
+	std::vector<std::unique_ptr<Buffer>> batchCountBuffers;
+	std::vector<std::unique_ptr<Buffer>> visibleInstanceBuffers;
+	std::vector<std::unique_ptr<Buffer>> meshletDispatchBuffers;
+
+	//Indices of the meshlets that survived culling, the g-buffer draws from these. Grown with the mesh registry's index
+	//pool, capacities are in indices
+	std::vector<std::unique_ptr<Buffer>> drawIndexBuffers;
+	std::vector<uint32_t> drawIndexCapacities;
+
+	//Bit per meshlet of the registry's pool, set by the meshlet pass and compacted per batch. Capacities are in words
+	std::vector<std::unique_ptr<Buffer>> meshletMaskBuffers;
+	std::vector<uint32_t> meshletMaskCapacities;
+
+	//Visibility of every object slot at the end of the last frame. Shared by the frames in flight, they run in order.
+	//Reset to visible whenever slots are reassigned
+	std::unique_ptr<Buffer> visibilityBuffer;
+	bool isVisibilityReset = true;
+
+	//Farthest depth of the early g-buffer pass, every level halves the one above. Always in general layout
+	Image hiZImage{ vulkanContext.vulkanResources };
+	uint32_t hiZLevels = 0;
+
+	void initCullingPipeline();
+	void initDrawBuffers();
+	//Only touch the current frame's buffer, which the gpu is done with
+	void reserveDrawIndices(uint64_t requiredIndices);
+	void reserveMeshletMasks(uint32_t meshletCount);
+	void initHiZResources();
+	//Writes this frame's culling set, before anything binds it. Both phases only record
+	void updateCullingDescriptors();
+	void recordCulling(VkCommandBuffer commandBuffer, const glm::mat4& viewProjection, CULLING_PHASE phase);
+	void recordHiZ(VkCommandBuffer commandBuffer);
+	//Culling
+
 	//G-Buffer
 	Image gBufferAlbedoImage{ vulkanContext.vulkanResources };
 	Image gBufferNormalImage{ vulkanContext.vulkanResources };
@@ -182,11 +367,21 @@ private:
 
 	Framebuffer gBufferFramebuffer{ vulkanContext.vulkanResources };
 	RenderPass gBufferRenderPass{ vulkanContext.vulkanResources };
+	//Same attachments loaded instead of cleared, for the draws of the late culling phase
+	RenderPass gBufferLateRenderPass{ vulkanContext.vulkanResources };
 	Pipeline gBufferPipeline{ vulkanContext.vulkanResources };
 
+	//Recording jobs split the g-buffer draws into ranges and record both passes of their range into secondary
+	//command buffers. Ranges below this are not worth a job
+	static constexpr uint32_t MIN_DRAWS_PER_RECORDING_JOB = 4096;
+	uint32_t recordingJobCount = 1;
+	//Per frame in flight, the early pass of job i at 2 * i and its late pass after it
+	std::vector<std::vector<CommandBuffer>> gBufferCommandBuffers;
+
 	void initGBufferResources();
 	void initGBufferPass();
 	void initGBufferPipeline();
+	void recordGBufferCommands(uint32_t job, uint32_t firstDraw, uint32_t drawCount);
 	//G-Buffer
 
 	//Skybox
@@ -212,18 +407,20 @@ private:
 	Image prefilterCubeMapImage{ vulkanContext.vulkanResources };
 	Image brdfLUTImage{ vulkanContext.vulkanResources };
 
-	std::vector<Framebuffer> irradianceFramebuffers;
-	std::vector<std::vector<Framebuffer>> prefilterFramebuffers;
-	Framebuffer lutFramebuffer{ vulkanContext.vulkanResources };
-	RenderPass irradiancePrefilterRenderPass{ vulkanContext.vulkanResources };
-	RenderPass lutRenderPass{ vulkanContext.vulkanResources };
+	//Compute pipelines, each writes one of the maps above. They run on the async compute queue
 	Pipeline irradiancePipeline{ vulkanContext.vulkanResources };
 	Pipeline prefilterPipeline{ vulkanContext.vulkanResources };
 	Pipeline lutPipeline{ vulkanContext.vulkanResources };
 
+	//Cube map 0, the skybox. Null until its upload went out
+	Image* skyboxImage = nullptr;
+	//Set once the maps were acquired from the compute queue. Until then the skybox belongs to the ibl job as well,
+	//neither it nor the maps are drawn
+	bool isEnvironmentReady = false;
+
 	void initPreprocessIBLResources();
-	void initPreprocessIBLPasses();
 	void initPreprocessIBLPipelines();
+	void recordSkyBoxMaps(VkCommandBuffer commandBuffer);
 	//IBL
 
 	//Ray Tracing
@@ -246,55 +443,90 @@ private:
 
 
 	CommandPool graphicsCommandPool{ vulkanContext.vulkanResources };
+	//Per frame in flight, reset as a whole once the frame's last submit is done. Pool 0 records the primary and
+	//recording job i uses pool i + 1, so no pool is ever used by two threads at once
+	std::vector<std::vector<CommandPool>> frameCommandPools;
 	std::vector<CommandBuffer> commandBuffers;
 	CommandBuffer initializationCommandBuffer{ vulkanContext.vulkanResources, graphicsCommandPool.commandPool };
 
 	std::vector<VkSemaphore> imageAvailableSemaphores;
 	std::vector<VkSemaphore> renderFinishedSemaphores;
-	std::vector<VkFence> inFlightFences;
 
-	int maxFramesInFlight = 2;
+	//Every submit signals the next value. A frame slot is free again once the value of its last submit is reached,
+	//the binary semaphores above only order acquire and present
+	Timeline frameTimeline{ vulkanContext.vulkanResources };
+	std::vector<uint64_t> frameValues;
+	//Nanoseconds beginFrame waits for a frame before treating the device as hung
+	static constexpr uint64_t FRAME_TIMEOUT = 10'000'000'000ull;
+
 	uint32_t currentFrame = 0;
 	uint32_t imageIndex;
 
 
 
-	StagingBuffer stagingBuffer{ vulkanContext.vulkanResources };
-	
+	//Images and buffers are copied on the transfer queue, every graphics submit waits for what was submitted before it
+	UploadEngine uploadEngine{ vulkanContext.vulkanResources };
+	//Compute jobs running next to the frames, each frame hands over what was scheduled and takes back what finished
+	AsyncCompute asyncCompute{ vulkanContext.vulkanResources };
+	//Texture 0, shown by textures that are still streaming in. Null until its own upload went out
+	Image* defaultTexture = nullptr;
+	//Bindless ids of textures still streaming in
+	std::vector<uint32_t> streamingTextures;
+	//The ibl job waits for every cube map
+	uint32_t streamingCubeMaps = 0;
+	void bindBindlessImage(ResourceManager::ResourceType type, uint32_t id, Image* image);
 
+	MeshRegistry meshRegistry{ vulkanContext.vulkanResources };
 
-	VertexBuffer mainVertexBuffer{ vulkanContext.vulkanResources };
-	IndexBuffer mainIndexBuffer{ vulkanContext.vulkanResources };
+	//Global ubo, object and light ssbos of every frame in flight. Capacities are starting sizes, they double as the scene grows
+	RingBuffer frameRing{ vulkanContext.vulkanResources };
+	uint32_t objectCapacity = 1024;
+	uint32_t lightCapacity = 128;
 
-	std::vector<UniformBuffer> globalUniformBuffers;
-	std::vector<StorageBuffer> objectStorageBuffers;
-	std::vector<StorageBuffer> lightStorageBuffers;
+	//Dynamic offsets of the global set for the frame being recorded, see DescriptorManager::GLOBAL_OFFSET
+	std::array<uint32_t, DescriptorManager::GLOBAL_OFFSET_COUNT> globalOffsets{};
 	
 	
 
-	bool isMainVertexBufferInitialized = false;
-
-	std::vector<Vertex> batchedVertices;
-	std::vector<uint32_t> batchedIndices;
-
-	struct drawInfo {
-		uint32_t indexCount;
-		uint32_t firstIndex;
-		uint32_t vertexOffset;
-		uint32_t ssboIndex;
-		std::shared_ptr<Transform> transform;
-		std::shared_ptr<Material> material;
-	};
-
-	struct lightInfo {
-		Light::LIGHT_TYPE type;
-		glm::vec4 direction;
-		glm::vec4 position;
-		glm::vec4 color;
-	};
-
-	std::vector<drawInfo> drawInfos;
-	std::vector<lightInfo> lightInfos;
+	//Entities drawn by the g-buffer, each one's object ssbo slot is below objectCount. Culling decides what is drawn
+	uint32_t objectCount = 0;
+	uint32_t lightCount = 0;
+
+	//Batch of every mesh (indexed by mesh id) and of every entity (indexed by Entity::index)
+	std::vector<DrawBatch> drawBatches;
+	std::vector<uint32_t> meshBatches;
+	std::vector<uint32_t> objectBatches;
+	RingBuffer::Allocation batchAllocation;
+
+	//First object of every batch, its material and position stand in for all the batch's instances
+	std::vector<Entity> batchEntities;
+
+	//Sorted (key, batch) pairs and the rank of every batch, kept until the batches, the camera cell or the order change.
+	//The ranks are copied to the ring every frame
+	static constexpr float SORT_CELL_SIZE = 1.0f;
+	std::vector<RadixSort::Item> drawKeys;
+	std::vector<RadixSort::Item> drawKeyScratch;
+	std::vector<uint32_t> batchRanks;
+	uint32_t sortedLayoutVersion = UINT32_MAX;
+	glm::ivec3 sortedCameraCell{ 0 };
+	DrawKey::ORDER sortedOrder = DrawKey::ORDER::STATE;
+	RingBuffer::Allocation drawOrderAllocation;
+
+	//Object and light ssbo slot of every entity, indexed by Entity::index
+	std::vector<uint32_t> objectSlots;
+	std::vector<uint32_t> lightSlots;
+
+	//Meshes are checked for geometry to register when they changed after meshVersion
+	uint32_t meshVersion = 0;
+	std::vector<Entity> pendingMeshes;
+
+	//Bumped whenever slots or batches are rebuilt
+	uint32_t sceneStructuralVersion = 0;
+	uint32_t sceneLayoutVersion = 0;
+	std::vector<uint32_t> frameLayoutVersions;
+	std::vector<uint32_t> frameVersions;
+	std::vector<uint32_t> frameObjectOffsets;
+	std::vector<uint32_t> frameLightOffsets;
 
 };
 
@@ -0,0 +1,370 @@
+#include "UploadEngine.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+UploadEngine::UploadEngine(VulkanResources& vulkanResources) : commandPool{ vulkanResources }, timeline{ vulkanResources }, vulkanResources{ vulkanResources }
+{
+}
+
+UploadEngine::~UploadEngine()
+{
+	destroyUploadEngine();
+}
+
+void UploadEngine::initUploadEngine(VkQueue queue, uint32_t queueIndex, uint32_t graphicsQueueIndex, VkDeviceSize stagingSize, VkDeviceSize bytesPerSubmit)
+{
+	this->queue = queue;
+	this->queueIndex = queueIndex;
+	this->graphicsQueueIndex = graphicsQueueIndex;
+	this->stagingSize = stagingSize;
+	this->bytesPerSubmit = std::max<VkDeviceSize>(bytesPerSubmit, 1);
+
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(vulkanResources.physicalDevice, &properties);
+	copyAlignment = std::max<VkDeviceSize>(properties.limits.optimalBufferCopyOffsetAlignment, 4);
+
+	commandPool.initCommandPool(queueIndex, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+	timeline.initTimeline();
+
+	stagingRing = std::make_unique<Buffer>(vulkanResources);
+	stagingRing->initBuffer(stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
+	stagingData = static_cast<char*>(stagingRing->map());
+	stagingHead = 0;
+	stagingTail = 0;
+}
+
+UploadEngine::Batch& UploadEngine::getBatch()
+{
+	if (openBatch) {
+		return *openBatch;
+	}
+
+	openBatch = std::make_unique<Batch>();
+	if (!freeCommandBuffers.empty()) {
+		openBatch->commandBuffer = std::move(freeCommandBuffers.back());
+		freeCommandBuffers.pop_back();
+	}
+	else {
+		openBatch->commandBuffer = std::make_unique<CommandBuffer>(vulkanResources, commandPool.commandPool);
+		openBatch->commandBuffer->allocate();
+	}
+	openBatch->commandBuffer->begin();
+
+	return *openBatch;
+}
+
+VkDeviceSize UploadEngine::allocateStaging(VkDeviceSize rowSize, VkDeviceSize maxRows, VkDeviceSize alignment, VkDeviceSize& rows)
+{
+	const VkDeviceSize free = stagingSize - (stagingHead - stagingTail);
+	const VkDeviceSize start = stagingHead % stagingSize;
+	const VkDeviceSize offset = (start + alignment - 1) / alignment * alignment;
+
+	//Allocations never wrap. Rows fit either up to the end of the ring or, skipping the rest of it, at its start
+	VkDeviceSize endRows = 0;
+	if (offset < stagingSize && offset - start <= free) {
+		endRows = std::min(stagingSize - offset, free - (offset - start)) / rowSize;
+	}
+	VkDeviceSize startRows = 0;
+	if (start > 0 && stagingSize - start <= free) {
+		startRows = (free - (stagingSize - start)) / rowSize;
+	}
+
+	rows = std::min(maxRows, std::max(endRows, startRows));
+	if (rows == 0) {
+		return 0;
+	}
+
+	if (rows <= endRows) {
+		stagingHead += (offset - start) + rows * rowSize;
+		return offset;
+	}
+	stagingHead += (stagingSize - start) + rows * rowSize;
+	return 0;
+}
+
+void UploadEngine::uploadBuffer(Buffer& buffer, VkDeviceSize offset, const void* data, VkDeviceSize size, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess, std::function<void()> onSubmitted)
+{
+	if (size == 0) {
+		return;
+	}
+
+	Request request{};
+	request.buffer = &buffer;
+	request.bufferOffset = offset;
+	request.layers = { data };
+	request.rowSize = 1;
+	request.rowCount = size;
+	request.alignment = copyAlignment;
+	request.dstStage = dstStage;
+	request.dstAccess = dstAccess;
+	request.onSubmitted = std::move(onSubmitted);
+
+	//Queued uploads go first, a later upload to the same range has to land after them
+	VkDeviceSize rows = 0;
+	VkDeviceSize stagingOffset = requests.empty() ? allocateStaging(size, 1, copyAlignment, rows) : 0;
+	if (rows == 1) {
+		std::memcpy(stagingData + stagingOffset, data, size);
+		getBatch();
+		recordRows(request, stagingOffset, size);
+		release(request);
+		return;
+	}
+
+	//The caller's data may be gone by the time the ring has room
+	request.bufferData.assign(static_cast<const char*>(data), static_cast<const char*>(data) + size);
+	request.layers = { request.bufferData.data() };
+	requests.push_back(std::move(request));
+}
+
+void UploadEngine::uploadImage(Image& image, uint32_t width, uint32_t height, std::vector<const void*> layers, std::function<void()> onSubmitted, VkDeviceSize texelSize, VkPipelineStageFlags dstStage)
+{
+	if (layers.empty()) {
+		return;
+	}
+
+	Request request{};
+	request.image = &image;
+	request.width = width;
+	request.layers = std::move(layers);
+	request.rowSize = static_cast<VkDeviceSize>(width) * texelSize;
+	request.rowCount = height;
+	//Copy offsets have to be a multiple of the texel size as well
+	request.alignment = std::lcm(copyAlignment, texelSize);
+	request.dstStage = dstStage;
+	request.dstAccess = VK_ACCESS_SHADER_READ_BIT;
+	request.onSubmitted = std::move(onSubmitted);
+
+	if (request.rowSize + request.alignment > stagingSize) {
+		throw std::runtime_error("Image row does not fit the staging ring");
+	}
+
+	requests.push_back(std::move(request));
+}
+
+void UploadEngine::packRequests()
+{
+	VkDeviceSize packed = 0;
+	while (!requests.empty() && packed < bytesPerSubmit) {
+		Request& request = requests.front();
+
+		//Whole rows only, at least one per submit even when it is larger than the budget
+		VkDeviceSize budgetRows = std::max<VkDeviceSize>((bytesPerSubmit - packed) / request.rowSize, 1);
+		VkDeviceSize rows = 0;
+		VkDeviceSize stagingOffset = allocateStaging(request.rowSize, std::min(request.rowCount - request.nextRow, budgetRows), request.alignment, rows);
+		if (rows == 0) {
+			break;
+		}
+
+		const char* source = static_cast<const char*>(request.layers[request.nextLayer]) + request.nextRow * request.rowSize;
+		std::memcpy(stagingData + stagingOffset, source, rows * request.rowSize);
+		getBatch();
+		recordRows(request, stagingOffset, rows);
+		packed += rows * request.rowSize;
+
+		//The ring or the budget split the layer, the rest goes into the next piece
+		request.nextRow += rows;
+		if (request.nextRow < request.rowCount) {
+			continue;
+		}
+		request.nextRow = 0;
+		if (++request.nextLayer < request.layers.size()) {
+			continue;
+		}
+
+		release(request);
+		requests.pop_front();
+	}
+}
+
+void UploadEngine::recordRows(Request& request, VkDeviceSize stagingOffset, VkDeviceSize rows)
+{
+	VkCommandBuffer commandBuffer = openBatch->commandBuffer->commandBuffer;
+
+	if (request.buffer) {
+		VkBufferCopy region{};
+		region.srcOffset = stagingOffset;
+		region.dstOffset = request.bufferOffset + request.nextRow;
+		region.size = rows;
+		vkCmdCopyBuffer(commandBuffer, stagingRing->buffer, request.buffer->buffer, 1, &region);
+		return;
+	}
+
+	//The first piece of an image makes it a copy destination
+	const uint32_t layerCount = static_cast<uint32_t>(request.layers.size());
+	if (request.nextLayer == 0 && request.nextRow == 0) {
+		request.image->transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, layerCount });
+	}
+
+	VkBufferImageCopy region{};
+	region.bufferOffset = stagingOffset;
+	region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, request.nextLayer, 1 };
+	region.imageOffset = { 0, static_cast<int32_t>(request.nextRow), 0 };
+	region.imageExtent = { request.width, static_cast<uint32_t>(rows), 1 };
+	vkCmdCopyBufferToImage(commandBuffer, stagingRing->buffer, request.image->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+}
+
+void UploadEngine::release(Request& request)
+{
+	openStages |= request.dstStage;
+	if (request.onSubmitted) {
+		submittedCallbacks.push_back(std::move(request.onSubmitted));
+	}
+
+	if (request.buffer) {
+		//Without an ownership transfer the timeline wait alone makes the copy visible
+		if (hasOwnershipTransfer()) {
+			VkBufferMemoryBarrier release{};
+			release.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			release.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			release.dstAccessMask = request.dstAccess;
+			release.srcQueueFamilyIndex = queueIndex;
+			release.dstQueueFamilyIndex = graphicsQueueIndex;
+			release.buffer = request.buffer->buffer;
+			release.offset = request.bufferOffset;
+			release.size = request.rowCount;
+			bufferReleases.push_back(release);
+		}
+		return;
+	}
+
+	//The layout change happens at the end of the batch either way, the graphics side repeats it when it acquires
+	VkImageMemoryBarrier release{};
+	release.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	release.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	release.dstAccessMask = request.dstAccess;
+	release.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	release.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	release.srcQueueFamilyIndex = hasOwnershipTransfer() ? queueIndex : VK_QUEUE_FAMILY_IGNORED;
+	release.dstQueueFamilyIndex = hasOwnershipTransfer() ? graphicsQueueIndex : VK_QUEUE_FAMILY_IGNORED;
+	release.image = request.image->image;
+	release.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, static_cast<uint32_t>(request.layers.size()) };
+	imageReleases.push_back(release);
+}
+
+uint64_t UploadEngine::submit()
+{
+	//Finished batches give their part of the ring back first
+	collect();
+	packRequests();
+
+	if (!openBatch) {
+		return timeline.getSubmittedValue();
+	}
+
+	//Releases keep the graphics side's access mask for the acquires, nothing on this queue reads after them
+	if (!bufferReleases.empty() || !imageReleases.empty()) {
+		std::vector<VkBufferMemoryBarrier> buffers = bufferReleases;
+		std::vector<VkImageMemoryBarrier> images = imageReleases;
+		for (auto& barrier : buffers) {
+			barrier.dstAccessMask = 0;
+		}
+		for (auto& barrier : images) {
+			barrier.dstAccessMask = 0;
+		}
+		vkCmdPipelineBarrier(openBatch->commandBuffer->commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+			0, nullptr,
+			static_cast<uint32_t>(buffers.size()), buffers.data(),
+			static_cast<uint32_t>(images.size()), images.data());
+	}
+
+	openBatch->commandBuffer->end();
+	openBatch->stagingEnd = stagingHead;
+	openBatch->value = timeline.next();
+	openBatch->commandBuffer->submitTimeline(queue, timeline.semaphore, openBatch->value);
+
+	//The graphics side repeats the releases to take ownership
+	if (hasOwnershipTransfer()) {
+		bufferAcquires.insert(bufferAcquires.end(), bufferReleases.begin(), bufferReleases.end());
+		imageAcquires.insert(imageAcquires.end(), imageReleases.begin(), imageReleases.end());
+	}
+	bufferReleases.clear();
+	imageReleases.clear();
+	acquireStages |= openStages;
+	openStages = 0;
+
+	submittedBatches.push_back(std::move(openBatch));
+
+	for (auto& callback : submittedCallbacks) {
+		callback();
+	}
+	submittedCallbacks.clear();
+
+	return submittedBatches.back()->value;
+}
+
+CommandBuffer::SemaphoreWait UploadEngine::acquire(VkCommandBuffer commandBuffer)
+{
+	const uint64_t submittedValue = timeline.getSubmittedValue();
+	if (submittedValue == acquiredValue) {
+		return {};
+	}
+
+	//Acquires only have to wait for the stages the semaphore wait blocks
+	if (!bufferAcquires.empty() || !imageAcquires.empty()) {
+		for (auto& barrier : bufferAcquires) {
+			barrier.srcAccessMask = 0;
+		}
+		for (auto& barrier : imageAcquires) {
+			barrier.srcAccessMask = 0;
+		}
+		vkCmdPipelineBarrier(commandBuffer, acquireStages, acquireStages, 0,
+			0, nullptr,
+			static_cast<uint32_t>(bufferAcquires.size()), bufferAcquires.data(),
+			static_cast<uint32_t>(imageAcquires.size()), imageAcquires.data());
+		bufferAcquires.clear();
+		imageAcquires.clear();
+	}
+
+	CommandBuffer::SemaphoreWait wait{ timeline.semaphore, submittedValue, acquireStages };
+	acquiredValue = submittedValue;
+	acquireStages = 0;
+	return wait;
+}
+
+void UploadEngine::collect()
+{
+	if (submittedBatches.empty()) {
+		return;
+	}
+
+	const uint64_t completedValue = timeline.getCompletedValue();
+	while (!submittedBatches.empty() && submittedBatches.front()->value <= completedValue) {
+		stagingTail = submittedBatches.front()->stagingEnd;
+		freeCommandBuffers.push_back(std::move(submittedBatches.front()->commandBuffer));
+		submittedBatches.pop_front();
+	}
+}
+
+void UploadEngine::destroyUploadEngine()
+{
+	if (queue == VK_NULL_HANDLE) {
+		return;
+	}
+
+	timeline.wait(timeline.getSubmittedValue());
+
+	//Command buffers go back to the pool before it is destroyed
+	openBatch.reset();
+	submittedBatches.clear();
+	requests.clear();
+	submittedCallbacks.clear();
+	freeCommandBuffers.clear();
+	bufferReleases.clear();
+	imageReleases.clear();
+	bufferAcquires.clear();
+	imageAcquires.clear();
+	acquireStages = 0;
+	openStages = 0;
+	acquiredValue = 0;
+
+	stagingRing.reset();
+	stagingData = nullptr;
+	stagingHead = 0;
+	stagingTail = 0;
+
+	timeline.destroyTimeline();
+	commandPool.destroyCommandPool();
+	queue = VK_NULL_HANDLE;
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include "../Helper/Helper.h"
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include "../Abstractions/Buffer/Buffer.h"
+#include "../Abstractions/Image/Image.h"
+#include "../Abstractions/CommandPool/CommandPool.h"
+#include "../Abstractions/CommandBuffer/CommandBuffer.h"
+#include "../Abstractions/Timeline/Timeline.h"
+
+
+//Copies data into device local buffers and images on the transfer queue. Uploads are recorded into the open batch and
+//submit() sends the whole batch as one submission that signals the engine's timeline. When the transfer queue has its
+//own family, every destination is released to the graphics family at the end of its batch and acquire() records the
+//matching barriers on the graphics side. Nothing on the cpu waits for the copies, staging memory and command buffers
+//are reused once the timeline passed their batch.
+//Uploads that do not fit the staging ring right away are streamed: they wait in a queue and every submit() packs as
+//much of them as the ring and the per submit budget allow. Layers are split on row boundaries (buffers anywhere), so
+//data of any size goes through a small ring over several submits
+class UploadEngine
+{
+public:
+	UploadEngine(VulkanResources& vulkanResources);
+	UploadEngine(const UploadEngine&) = delete;
+	UploadEngine& operator=(const UploadEngine&) = delete;
+	~UploadEngine();
+
+	//graphicsQueueIndex: family that uses the uploaded data. bytesPerSubmit caps the queued data one submit() packs
+	void initUploadEngine(VkQueue queue, uint32_t queueIndex, uint32_t graphicsQueueIndex, VkDeviceSize stagingSize = 32 * 1024 * 1024, VkDeviceSize bytesPerSubmit = 8 * 1024 * 1024);
+	//Waits for the batches still in flight
+	void destroyUploadEngine();
+
+	//Staged right away when the ring has room, otherwise a copy of data is queued. dstStage and dstAccess describe the
+	//first use on the graphics queue, which has to come after the acquire that follows the submit() sending the last byte.
+	//onSubmitted runs inside that submit()
+	void uploadBuffer(Buffer& buffer, VkDeviceSize offset, const void* data, VkDeviceSize size, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess, std::function<void()> onSubmitted = nullptr);
+
+	//Queued, mip 0 of every layer, each holding width * height * texelSize bytes. The image has to be unused (its content
+	//is discarded) and ends in SHADER_READ_ONLY_OPTIMAL. onSubmitted runs inside the submit() that sent its last row,
+	//graphics submits that acquire after it can use the image. The layers are read until then, captures of onSubmitted
+	//can keep them alive
+	void uploadImage(Image& image, uint32_t width, uint32_t height, std::vector<const void*> layers, std::function<void()> onSubmitted = nullptr, VkDeviceSize texelSize = 4, VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+	//Packs queued uploads and submits the open batch. Returns the value it signals, the last submitted value when
+	//nothing was recorded
+	uint64_t submit();
+
+	//Records the acquires of every batch submitted since the last call into commandBuffer. Its submit has to wait for
+	//the returned semaphore, which is null when there is nothing new to wait for
+	CommandBuffer::SemaphoreWait acquire(VkCommandBuffer commandBuffer);
+
+	//Releases the staging memory and command buffers of finished batches
+	void collect();
+
+	bool isComplete(uint64_t value) {
+		return value <= timeline.getCompletedValue();
+	}
+
+	//For loading loops with nothing else to do
+	void wait(uint64_t value) {
+		timeline.wait(value);
+	}
+
+	bool hasQueuedUploads() const {
+		return !requests.empty();
+	}
+
+	uint64_t getSubmittedValue() const {
+		return timeline.getSubmittedValue();
+	}
+
+private:
+
+	struct Batch {
+		std::unique_ptr<CommandBuffer> commandBuffer;
+		//Ring position after the batch's last allocation, the ring is free up to here once it finished
+		uint64_t stagingEnd = 0;
+		uint64_t value = 0;
+	};
+
+	//Images read the caller's layers, a buffer owns a copy of its data and is one layer of single byte rows
+	struct Request {
+		Image* image = nullptr;
+		uint32_t width = 0;
+		Buffer* buffer = nullptr;
+		VkDeviceSize bufferOffset = 0;
+		std::vector<char> bufferData;
+
+		std::vector<const void*> layers;
+		VkDeviceSize rowSize = 0;
+		VkDeviceSize rowCount = 0;
+		VkDeviceSize alignment = 0;
+		VkPipelineStageFlags dstStage = 0;
+		VkAccessFlags dstAccess = 0;
+		std::function<void()> onSubmitted;
+
+		uint32_t nextLayer = 0;
+		VkDeviceSize nextRow = 0;
+	};
+
+	//Opens a batch when there is none
+	Batch& getBatch();
+	//Reserves up to maxRows rows of rowSize bytes in one piece, as many as there is room for. Returns their offset,
+	//rows is 0 when the ring is full
+	VkDeviceSize allocateStaging(VkDeviceSize rowSize, VkDeviceSize maxRows, VkDeviceSize alignment, VkDeviceSize& rows);
+	void packRequests();
+	//Records rows [nextRow, nextRow + rows) of the request's current layer, staged at stagingOffset
+	void recordRows(Request& request, VkDeviceSize stagingOffset, VkDeviceSize rows);
+	void release(Request& request);
+
+	bool hasOwnershipTransfer() const {
+		return queueIndex != graphicsQueueIndex;
+	}
+
+	VkQueue queue = VK_NULL_HANDLE;
+	uint32_t queueIndex = 0;
+	uint32_t graphicsQueueIndex = 0;
+
+	CommandPool commandPool;
+	Timeline timeline;
+
+	//Persistently mapped. Head and tail count bytes ever allocated and released, their difference is in use
+	std::unique_ptr<Buffer> stagingRing;
+	char* stagingData = nullptr;
+	VkDeviceSize stagingSize = 0;
+	uint64_t stagingHead = 0;
+	uint64_t stagingTail = 0;
+	VkDeviceSize bytesPerSubmit = 0;
+	//Smallest offset alignment of a copy, the device's optimal one
+	VkDeviceSize copyAlignment = 4;
+
+	std::deque<Request> requests;
+	//Callbacks of uploads whose last row is in the open batch
+	std::vector<std::function<void()>> submittedCallbacks;
+
+	std::unique_ptr<Batch> openBatch;
+	std::deque<std::unique_ptr<Batch>> submittedBatches;
+	std::vector<std::unique_ptr<CommandBuffer>> freeCommandBuffers;
+
+	//Recorded at the end of the open batch
+	std::vector<VkBufferMemoryBarrier> bufferReleases;
+	std::vector<VkImageMemoryBarrier> imageReleases;
+
+	//Acquires of submitted batches, recorded by the next acquire()
+	std::vector<VkBufferMemoryBarrier> bufferAcquires;
+	std::vector<VkImageMemoryBarrier> imageAcquires;
+	VkPipelineStageFlags acquireStages = 0;
+	VkPipelineStageFlags openStages = 0;
+	uint64_t acquiredValue = 0;
+
+	VulkanResources& vulkanResources;
+};